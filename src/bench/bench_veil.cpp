@@ -10,6 +10,7 @@
 #include <util/system.h>
 #include <util/strencodings.h>
 #include <validation.h>
+#include <veil/ringct/blind.h>
 
 #include <memory>
 
@@ -67,6 +68,7 @@ int main(int argc, char** argv)
     SHA256AutoDetect();
     RandomInit();
     ECC_Start();
+    ECC_Start_Blinding();
     SetupEnvironment();
 
     int64_t evaluations = gArgs.GetArg("-evals", DEFAULT_BENCH_EVALUATIONS);
@@ -93,6 +95,7 @@ int main(int argc, char** argv)
 
     fs::remove_all(bench_datadir);
 
+    ECC_Stop_Blinding();
     ECC_Stop();
 
     return EXIT_SUCCESS;
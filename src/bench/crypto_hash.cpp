@@ -60,6 +60,18 @@ static void SHA256D64_1024(benchmark::State& state)
     }
 }
 
+static void SHA256D80_1024(benchmark::State& state)
+{
+    std::vector<uint8_t> header(80, 0);
+    std::vector<uint8_t> in(16 * 1024, 0);
+    std::vector<uint8_t> out(32 * 1024);
+    uint32_t midstate[8];
+    SHA256D80Midstate(midstate, header.data());
+    while (state.KeepRunning()) {
+        SHA256D80(out.data(), midstate, in.data(), 1024);
+    }
+}
+
 static void SHA512(benchmark::State& state)
 {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
@@ -103,5 +115,6 @@ BENCHMARK(SHA512, 330);
 BENCHMARK(SHA256_32b, 4700 * 1000);
 BENCHMARK(SipHash_32b, 40 * 1000 * 1000);
 BENCHMARK(SHA256D64_1024, 7400);
+BENCHMARK(SHA256D80_1024, 7400);
 BENCHMARK(FastRandom_32bit, 110 * 1000 * 1000);
 BENCHMARK(FastRandom_1bit, 440 * 1000 * 1000);
@@ -0,0 +1,168 @@
+// Copyright (c) 2019-2022 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <chainparams.h>
+#include <hash.h>
+#include <primitives/block.h>
+#include <uint256.h>
+#include <util/system.h>
+
+#include <crypto/randomx/randomx.h>
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+// Header validation time is dominated by the PoW hash of each algorithm. RandomX is measured through the
+// randomx API directly, since GetRandomXBlockHash needs an active chain to pick the key block.
+
+static CBlockHeader MakeBenchHeader(int nPoWType)
+{
+    CBlockHeader header;
+    header.SetNull();
+    header.nVersion = nPoWType;
+    header.hashPrevBlock = uint256S("aabbcceeffaabbcceeffaabbcceeffaabbcceeffaabbcceeffaabbcceeffaabb");
+    header.hashMerkleRoot = uint256S("0011223344556677889900112233445566778899001122334455667788990011");
+    header.nTime = 1604163600;
+    header.nBits = 0x1e008eb5;
+    header.nHeight = 1000000;
+    return header;
+}
+
+static void PoWHashX16RT(benchmark::State& state)
+{
+    CBlockHeader header = MakeBenchHeader(0);
+    while (state.KeepRunning()) {
+        header.GetX16RTPoWHash();
+        header.nNonce++;
+    }
+}
+
+static void PoWHashSha256D(benchmark::State& state)
+{
+    CBlockHeader header = MakeBenchHeader(CBlockHeader::SHA256D_BLOCK);
+    while (state.KeepRunning()) {
+        header.GetSha256DPoWHash();
+        header.nNonce++;
+    }
+}
+
+// What the miner does per nonce once the midstate is known
+static void PoWHashSha256DMidstate(benchmark::State& state)
+{
+    CBlockHeader header = MakeBenchHeader(CBlockHeader::SHA256D_BLOCK);
+    uint256 midState = header.GetSha256dMidstate();
+    while (state.KeepRunning()) {
+        header.GetSha256D(midState);
+        header.nNonce++;
+    }
+}
+
+static void PoWHashProgPow(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::MAIN);
+    CBlockHeader header = MakeBenchHeader(CBlockHeader::PROGPOW_BLOCK);
+    uint256 mix_hash;
+    ProgPowHash(header, mix_hash); // Build the epoch context outside of the timed loop
+    while (state.KeepRunning()) {
+        ProgPowHash(header, mix_hash);
+        header.nNonce64++;
+    }
+}
+
+static void RandomXHash(benchmark::State& state, randomx_flags flags)
+{
+    CBlockHeader header = MakeBenchHeader(CBlockHeader::RANDOMX_BLOCK);
+    const uint256 key_block = header.hashPrevBlock;
+
+    randomx_cache* cache = randomx_alloc_cache(flags);
+    randomx_init_cache(cache, &key_block, sizeof uint256());
+
+    randomx_dataset* dataset = nullptr;
+    if (flags & RANDOMX_FLAG_FULL_MEM) {
+        dataset = randomx_alloc_dataset(flags);
+        uint32_t nItems = randomx_dataset_item_count();
+        uint32_t nThreads = std::max(GetNumCores(), 1);
+        std::vector<std::thread> vThreads;
+        for (uint32_t i = 0; i < nThreads; i++) {
+            uint32_t nStart = nItems / nThreads * i;
+            uint32_t nCount = i == nThreads - 1 ? nItems - nStart : nItems / nThreads;
+            vThreads.emplace_back(&randomx_init_dataset, dataset, cache, nStart, nCount);
+        }
+        for (auto& thread : vThreads)
+            thread.join();
+    }
+
+    randomx_vm* vm = randomx_create_vm(flags, dataset ? nullptr : cache, dataset);
+    assert(vm);
+
+    char hash[RANDOMX_HASH_SIZE];
+    while (state.KeepRunning()) {
+        uint256 hash_blob = header.GetRandomXHeaderHash();
+        randomx_calculate_hash(vm, &hash_blob, sizeof uint256(), hash);
+        header.nNonce64++;
+    }
+
+    randomx_destroy_vm(vm);
+    if (dataset)
+        randomx_release_dataset(dataset);
+    randomx_release_cache(cache);
+}
+
+static void RandomXHashLightJIT(benchmark::State& state)
+{
+    RandomXHash(state, randomx_get_flags() | RANDOMX_FLAG_JIT);
+}
+
+static void RandomXHashLightInterpreter(benchmark::State& state)
+{
+    RandomXHash(state, (randomx_flags)(randomx_get_flags() & ~RANDOMX_FLAG_JIT));
+}
+
+static void RandomXHashFullJIT(benchmark::State& state)
+{
+    RandomXHash(state, randomx_get_flags() | RANDOMX_FLAG_JIT | RANDOMX_FLAG_FULL_MEM);
+}
+
+/**
+ * A header whose key block differs from the validation cache: GetRandomXBlockHash spins up a
+ * temporary cache and vm for every such hash.
+ */
+static void RandomXHashKeyBlockCacheMiss(benchmark::State& state)
+{
+    CBlockHeader header = MakeBenchHeader(CBlockHeader::RANDOMX_BLOCK);
+    const uint256 key_block = header.hashPrevBlock;
+    randomx_flags flags = randomx_get_flags();
+
+    char hash[RANDOMX_HASH_SIZE];
+    while (state.KeepRunning()) {
+        uint256 hash_blob = header.GetRandomXHeaderHash();
+        randomx_cache* cache = randomx_alloc_cache(flags);
+        randomx_init_cache(cache, &key_block, sizeof uint256());
+        randomx_vm* vm = randomx_create_vm(flags, cache, nullptr);
+        randomx_calculate_hash(vm, &hash_blob, sizeof uint256(), hash);
+        randomx_destroy_vm(vm);
+        randomx_release_cache(cache);
+        header.nNonce64++;
+    }
+}
+
+// The cache hit case is the light mode hash with the default flags
+static void RandomXHashKeyBlockCacheHit(benchmark::State& state)
+{
+    RandomXHash(state, randomx_get_flags());
+}
+
+BENCHMARK(PoWHashX16RT, 5000);
+BENCHMARK(PoWHashSha256D, 1000 * 1000);
+BENCHMARK(PoWHashSha256DMidstate, 2000 * 1000);
+BENCHMARK(PoWHashProgPow, 150);
+BENCHMARK(RandomXHashLightJIT, 60);
+BENCHMARK(RandomXHashLightInterpreter, 10);
+BENCHMARK(RandomXHashFullJIT, 1500);
+BENCHMARK(RandomXHashKeyBlockCacheHit, 60);
+BENCHMARK(RandomXHashKeyBlockCacheMiss, 2);
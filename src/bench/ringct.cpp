@@ -0,0 +1,381 @@
+// Copyright (c) 2019-2022 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <consensus/validation.h>
+#include <key.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <streams.h>
+#include <txdb.h>
+#include <validation.h>
+#include <veil/ringct/anon.h>
+#include <veil/ringct/blind.h>
+#include <veil/ringct/rctindex.h>
+#include <veil/ringct/stealth.h>
+
+#include <secp256k1.h>
+#include <secp256k1_mlsag.h>
+#include <secp256k1_rangeproof.h>
+
+#include <cassert>
+#include <vector>
+
+// Synthetic RingCT transactions: every ring member is written to an in-memory block tree so that
+// VerifyMLSAG runs exactly as it does during ConnectBlock and mempool acceptance.
+
+static const CAmount RINGCT_INPUT_VALUE = 10 * COIN;
+static const CAmount RINGCT_FEE = COIN / 100;
+static const size_t STEALTH_ADDRESSES_OWNED = 100;
+
+static int64_t nNextAnonIndex = 1;
+
+static void InitBenchBlockTree()
+{
+    if (!pblocktree)
+        pblocktree.reset(new CBlockTreeDB(1 << 20, true));
+}
+
+static secp256k1_pedersen_commitment MakeCommitment(CAmount nValue, const uint8_t* blind)
+{
+    secp256k1_pedersen_commitment commitment;
+    bool fCommitted = secp256k1_pedersen_commit(secp256k1_ctx_blind, &commitment, blind, (uint64_t)nValue, secp256k1_generator_h);
+    assert(fCommitted);
+    return commitment;
+}
+
+static std::vector<uint8_t> MakeRangeproof(const secp256k1_pedersen_commitment& commitment, const uint8_t* blind, CAmount nValue)
+{
+    uint64_t min_value = 0;
+    int ct_exponent = 2;
+    int ct_bits = 32;
+    int rv = SelectRangeProofParameters(nValue, min_value, ct_exponent, ct_bits);
+    assert(rv == 0);
+
+    uint256 nonce = GetRandHash();
+    size_t nRangeProofLen = 5134;
+    std::vector<uint8_t> vRangeproof(nRangeProofLen);
+    rv = secp256k1_rangeproof_sign(secp256k1_ctx_blind, vRangeproof.data(), &nRangeProofLen, min_value, &commitment,
+            blind, nonce.begin(), ct_exponent, ct_bits, nValue, nullptr, 0, nullptr, 0, secp256k1_generator_h);
+    assert(rv == 1);
+    vRangeproof.resize(nRangeProofLen);
+    return vRangeproof;
+}
+
+/** A single anon input spending nInputs real outputs, each hidden in a ring of nRingSize members */
+class SyntheticRingCTTx
+{
+public:
+    size_t nInputs;
+    size_t nRingSize;
+    size_t nSecretColumn;
+
+    CMutableTransaction mtx;
+    std::vector<CKey> vRealKeys;
+    std::vector<uint8_t> vInputBlinds;
+    std::vector<uint8_t> vOutputBlinds;
+
+    // Ring matrix and commitments, laid out as VerifyMLSAG builds them
+    std::vector<uint8_t> vm;
+    std::vector<secp256k1_pedersen_commitment> vInCommitments;
+    std::vector<secp256k1_pedersen_commitment> vOutCommitments;
+    secp256k1_pedersen_commitment plainCommitment;
+
+    SyntheticRingCTTx(size_t nInputsIn, size_t nRingSizeIn, size_t nOutputs = 2) : nInputs(nInputsIn), nRingSize(nRingSizeIn)
+    {
+        InitBenchBlockTree();
+        nSecretColumn = GetRandInt(nRingSize);
+
+        size_t nCols = nRingSize;
+        size_t nRows = nInputs + 1;
+        vm.resize(nCols * nRows * 33);
+        vInCommitments.resize(nCols * nInputs);
+        vRealKeys.resize(nInputs);
+        vInputBlinds.resize(nInputs * 32);
+
+        CTxIn txin;
+        txin.prevout.n = COutPoint::ANON_MARKER;
+        txin.SetAnonInfo(nInputs, nRingSize);
+        txin.scriptData.stack.emplace_back(nInputs * 33);
+        txin.scriptWitness.stack.emplace_back();
+        txin.scriptWitness.stack.emplace_back((1 + nRows * nCols) * 32);
+        std::vector<uint8_t>& vMI = txin.scriptWitness.stack[0];
+
+        for (size_t k = 0; k < nInputs; ++k) {
+            for (size_t i = 0; i < nCols; ++i) {
+                CKey key;
+                key.MakeNewKey(true);
+                uint8_t blind[32];
+                GetStrongRandBytes(blind, 32);
+                if (i == nSecretColumn) {
+                    vRealKeys[k] = key;
+                    memcpy(&vInputBlinds[k * 32], blind, 32);
+                }
+
+                COutPoint outpoint(GetRandHash(), 1);
+                CAnonOutput ao(CCmpPubKey(key.GetPubKey()), MakeCommitment(RINGCT_INPUT_VALUE, blind), outpoint, 1, 0);
+                int64_t nIndex = nNextAnonIndex++;
+                bool fWritten = pblocktree->WriteRCTOutput(nIndex, ao);
+                assert(fWritten);
+                PutVarInt(vMI, nIndex);
+
+                memcpy(&vm[(i + k * nCols) * 33], ao.pubkey.begin(), 33);
+                vInCommitments[i + k * nCols] = ao.commitment;
+            }
+        }
+        mtx.vin.emplace_back(txin);
+
+        // Fee output followed by RingCT outputs splitting the rest of the input value
+        auto txfee = MAKE_OUTPUT<CTxOutData>();
+        CAmount nFee = RINGCT_FEE;
+        txfee->SetCTFee(nFee);
+        mtx.vpout.emplace_back(txfee);
+        plainCommitment = MakeCommitment(RINGCT_FEE, std::vector<uint8_t>(32, 0).data());
+
+        CAmount nValueOut = RINGCT_INPUT_VALUE * nInputs - RINGCT_FEE;
+        vOutputBlinds.resize(nOutputs * 32);
+        GetStrongRandBytes(vOutputBlinds.data(), vOutputBlinds.size());
+        for (size_t n = 0; n < nOutputs; ++n) {
+            CAmount nValue = n == nOutputs - 1 ? nValueOut - (nValueOut / nOutputs) * n : nValueOut / nOutputs;
+            CKey key;
+            key.MakeNewKey(true);
+            CKey keyEphem;
+            keyEphem.MakeNewKey(true);
+            CPubKey pkEphem = keyEphem.GetPubKey();
+
+            auto txout = MAKE_OUTPUT<CTxOutRingCT>();
+            txout->pk = CCmpPubKey(key.GetPubKey());
+            txout->vData.assign(pkEphem.begin(), pkEphem.end());
+            txout->commitment = MakeCommitment(nValue, &vOutputBlinds[n * 32]);
+            txout->vRangeproof = MakeRangeproof(txout->commitment, &vOutputBlinds[n * 32], nValue);
+            vOutCommitments.emplace_back(txout->commitment);
+            mtx.vpout.emplace_back(txout);
+        }
+    }
+
+    void Sign()
+    {
+        size_t nCols = nRingSize;
+        size_t nRows = nInputs + 1;
+        CTxIn& txin = mtx.vin[0];
+
+        std::vector<uint8_t> vmSign = vm;
+        std::vector<const uint8_t*> vpsk(nRows);
+        std::vector<const uint8_t*> vpBlinds;
+        for (size_t k = 0; k < nInputs; ++k) {
+            vpsk[k] = vRealKeys[k].begin();
+            vpBlinds.emplace_back(&vInputBlinds[k * 32]);
+        }
+
+        std::vector<const uint8_t*> vpInCommits;
+        for (const auto& commitment : vInCommitments)
+            vpInCommits.emplace_back(commitment.data);
+
+        const uint8_t zeroBlind[32] = {};
+        std::vector<const uint8_t*> vpOutCommits{plainCommitment.data};
+        vpBlinds.emplace_back(zeroBlind);
+        for (size_t n = 0; n < vOutCommitments.size(); ++n) {
+            vpOutCommits.emplace_back(vOutCommitments[n].data);
+            vpBlinds.emplace_back(&vOutputBlinds[n * 32]);
+        }
+
+        uint8_t blindSum[32];
+        memset(blindSum, 0, 32);
+        vpsk[nRows - 1] = blindSum;
+
+        int rv = secp256k1_prepare_mlsag(&vmSign[0], blindSum, vpOutCommits.size(), vpOutCommits.size(), nCols, nRows,
+                &vpInCommits[0], &vpOutCommits[0], &vpBlinds[0]);
+        assert(rv == 0);
+
+        std::vector<uint8_t>& vKeyImages = txin.scriptData.stack[0];
+        std::vector<uint8_t>& vDL = txin.scriptWitness.stack[1];
+        uint256 hashOutputs = mtx.GetOutputsHash();
+        uint8_t randSeed[32];
+        GetStrongRandBytes(randSeed, 32);
+        rv = secp256k1_generate_mlsag(secp256k1_ctx_blind, &vKeyImages[0], &vDL[0], &vDL[32], randSeed,
+                hashOutputs.begin(), nCols, nRows, nSecretColumn, &vpsk[0], &vmSign[0]);
+        assert(rv == 0);
+    }
+
+    /** The verifier side of secp256k1_prepare_mlsag: adds the commitment row without any blinds */
+    void PrepareForVerify(std::vector<uint8_t>& vmVerify) const
+    {
+        std::vector<const uint8_t*> vpInCommits;
+        for (const auto& commitment : vInCommitments)
+            vpInCommits.emplace_back(commitment.data);
+        std::vector<const uint8_t*> vpOutCommits{plainCommitment.data};
+        for (const auto& commitment : vOutCommitments)
+            vpOutCommits.emplace_back(commitment.data);
+
+        vmVerify = vm;
+        int rv = secp256k1_prepare_mlsag(&vmVerify[0], nullptr, vpOutCommits.size(), vpOutCommits.size(), nRingSize,
+                nInputs + 1, &vpInCommits[0], &vpOutCommits[0], nullptr);
+        assert(rv == 0);
+    }
+};
+
+static void RingCTSignMLSAG(benchmark::State& state, size_t nInputs, size_t nRingSize)
+{
+    SyntheticRingCTTx rctx(nInputs, nRingSize);
+
+    while (state.KeepRunning()) {
+        rctx.Sign();
+    }
+}
+
+static void RingCTVerifyMLSAG(benchmark::State& state, size_t nInputs, size_t nRingSize)
+{
+    SyntheticRingCTTx rctx(nInputs, nRingSize);
+    rctx.Sign();
+    const CTransaction tx(rctx.mtx);
+
+    while (state.KeepRunning()) {
+        CValidationState validationState;
+        bool fValid = VerifyMLSAG(tx, validationState);
+        assert(fValid);
+    }
+}
+
+static void RingCTPrepareMLSAG(benchmark::State& state)
+{
+    SyntheticRingCTTx rctx(1, 11);
+    std::vector<uint8_t> vmVerify;
+
+    while (state.KeepRunning()) {
+        rctx.PrepareForVerify(vmVerify);
+    }
+}
+
+static void RingCTSignMLSAG1InRing3(benchmark::State& state) { RingCTSignMLSAG(state, 1, MIN_RINGSIZE); }
+static void RingCTSignMLSAG1InRing11(benchmark::State& state) { RingCTSignMLSAG(state, 1, 11); }
+static void RingCTSignMLSAG1InRing32(benchmark::State& state) { RingCTSignMLSAG(state, 1, MAX_RINGSIZE); }
+static void RingCTSignMLSAG4InRing11(benchmark::State& state) { RingCTSignMLSAG(state, 4, 11); }
+static void RingCTSignMLSAG32InRing11(benchmark::State& state) { RingCTSignMLSAG(state, MAX_ANON_INPUTS, 11); }
+
+static void RingCTVerifyMLSAG1InRing3(benchmark::State& state) { RingCTVerifyMLSAG(state, 1, MIN_RINGSIZE); }
+static void RingCTVerifyMLSAG1InRing11(benchmark::State& state) { RingCTVerifyMLSAG(state, 1, 11); }
+static void RingCTVerifyMLSAG1InRing32(benchmark::State& state) { RingCTVerifyMLSAG(state, 1, MAX_RINGSIZE); }
+static void RingCTVerifyMLSAG4InRing11(benchmark::State& state) { RingCTVerifyMLSAG(state, 4, 11); }
+static void RingCTVerifyMLSAG32InRing11(benchmark::State& state) { RingCTVerifyMLSAG(state, MAX_ANON_INPUTS, 11); }
+
+static void CTRangeproofSign(benchmark::State& state)
+{
+    uint8_t blind[32];
+    GetStrongRandBytes(blind, 32);
+    const secp256k1_pedersen_commitment commitment = MakeCommitment(RINGCT_INPUT_VALUE, blind);
+
+    while (state.KeepRunning()) {
+        MakeRangeproof(commitment, blind, RINGCT_INPUT_VALUE);
+    }
+}
+
+static void CTRangeproofVerify(benchmark::State& state)
+{
+    uint8_t blind[32];
+    GetStrongRandBytes(blind, 32);
+    const secp256k1_pedersen_commitment commitment = MakeCommitment(RINGCT_INPUT_VALUE, blind);
+    const std::vector<uint8_t> vRangeproof = MakeRangeproof(commitment, blind, RINGCT_INPUT_VALUE);
+
+    while (state.KeepRunning()) {
+        uint64_t min_value, max_value;
+        int rv = secp256k1_rangeproof_verify(secp256k1_ctx_blind, &min_value, &max_value, &commitment, vRangeproof.data(),
+                vRangeproof.size(), nullptr, 0, secp256k1_generator_h);
+        assert(rv == 1);
+    }
+}
+
+static void StealthSecretDerive(benchmark::State& state)
+{
+    CKey scanSecret, spendSecret, ephemSecret;
+    scanSecret.MakeNewKey(true);
+    spendSecret.MakeNewKey(true);
+    ephemSecret.MakeNewKey(true);
+    ec_point pkSpend, pkEphem;
+    SetPublicKey(spendSecret.GetPubKey(), pkSpend);
+    SetPublicKey(ephemSecret.GetPubKey(), pkEphem);
+
+    CKey sShared;
+    ec_point pkExtracted;
+    while (state.KeepRunning()) {
+        int rv = StealthSecret(scanSecret, pkEphem, pkSpend, sShared, pkExtracted);
+        assert(rv == 0);
+    }
+}
+
+/** The ownership check AnonWallet::ProcessStealthOutput runs for an output that matches none of the owned addresses */
+static void StealthDetectOutput(benchmark::State& state)
+{
+    std::vector<std::pair<CKey, ec_point>> vAddresses(STEALTH_ADDRESSES_OWNED);
+    for (auto& addr : vAddresses) {
+        CKey spendSecret;
+        spendSecret.MakeNewKey(true);
+        addr.first.MakeNewKey(true);
+        SetPublicKey(spendSecret.GetPubKey(), addr.second);
+    }
+
+    CKey ephemSecret, destSecret;
+    ephemSecret.MakeNewKey(true);
+    destSecret.MakeNewKey(true);
+    ec_point pkEphem;
+    SetPublicKey(ephemSecret.GetPubKey(), pkEphem);
+    const CKeyID idStealthDestination = destSecret.GetPubKey().GetID();
+
+    CKey sShared;
+    ec_point pkExtracted;
+    while (state.KeepRunning()) {
+        for (const auto& addr : vAddresses) {
+            if (StealthSecret(addr.first, pkEphem, addr.second, sShared, pkExtracted) != 0)
+                continue;
+            CPubKey pubKeyStealthSecret(pkExtracted);
+            bool fMine = pubKeyStealthSecret.IsValid() && pubKeyStealthSecret.GetID() == idStealthDestination;
+            assert(!fMine);
+        }
+    }
+}
+
+/** Deserialize a transaction with 16 RingCT outputs and a fee output, the bulk of what a RingCT heavy block holds */
+static void RingCTDeserializeTransaction(benchmark::State& state)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(2);
+    for (int i = 0; i < 16; i++) {
+        auto out = MAKE_OUTPUT<CTxOutRingCT>();
+        out->vData.assign(33, 0x02);
+        out->vRangeproof.assign(2800, 0x01);
+        mtx.vpout.push_back(out);
+    }
+    CAmount nFee = RINGCT_FEE;
+    auto outFee = MAKE_OUTPUT<CTxOutData>();
+    outFee->SetCTFee(nFee);
+    mtx.vpout.push_back(outFee);
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << mtx;
+    while (state.KeepRunning()) {
+        CDataStream ssRead(ss.begin(), ss.end(), SER_NETWORK, PROTOCOL_VERSION);
+        CMutableTransaction mtxRead;
+        ssRead >> mtxRead;
+        assert(mtxRead.vpout.size() == 17);
+    }
+}
+
+BENCHMARK(RingCTSignMLSAG1InRing3, 500);
+BENCHMARK(RingCTSignMLSAG1InRing11, 150);
+BENCHMARK(RingCTSignMLSAG1InRing32, 50);
+BENCHMARK(RingCTSignMLSAG4InRing11, 60);
+BENCHMARK(RingCTSignMLSAG32InRing11, 8);
+
+BENCHMARK(RingCTVerifyMLSAG1InRing3, 500);
+BENCHMARK(RingCTVerifyMLSAG1InRing11, 150);
+BENCHMARK(RingCTVerifyMLSAG1InRing32, 50);
+BENCHMARK(RingCTVerifyMLSAG4InRing11, 60);
+BENCHMARK(RingCTVerifyMLSAG32InRing11, 8);
+
+BENCHMARK(RingCTPrepareMLSAG, 2000);
+BENCHMARK(CTRangeproofSign, 150);
+BENCHMARK(CTRangeproofVerify, 250);
+BENCHMARK(StealthSecretDerive, 5000);
+BENCHMARK(StealthDetectOutput, 50);
+BENCHMARK(RingCTDeserializeTransaction, 20000);
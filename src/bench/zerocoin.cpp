@@ -0,0 +1,180 @@
+// Copyright (c) 2019-2022 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <chainparams.h>
+#include <libzerocoin/Accumulator.h>
+#include <libzerocoin/Coin.h>
+#include <libzerocoin/Commitment.h>
+#include <libzerocoin/SerialNumberSoK_small.h>
+#include <libzerocoin/bignum.h>
+#include <random.h>
+#include <veil/zerocoin/zchain.h>
+
+#include <cassert>
+#include <vector>
+
+// Zerocoin spends are verified in batches of SerialNumberSoKProof (see ThreadedBatchVerify
+// in ConnectBlock and ProcessStagingBatchVerify), while spend creation is dominated by
+// accumulator witness generation. Both come down to CBigNum modular exponentiation.
+
+static const size_t MAX_PROOFS = 128;
+static const int SYNTHETIC_CHAIN_BLOCKS = 100;
+static const int SYNTHETIC_MINTS_PER_BLOCK = 2;
+
+static libzerocoin::ZerocoinParams* GetBenchZerocoinParams()
+{
+    SelectParams(CBaseChainParams::MAIN);
+    return Params().Zerocoin_Params();
+}
+
+/** Proofs are expensive to create, so build them once and share them between benchmarks */
+static const std::vector<libzerocoin::SerialNumberSoKProof>& GetBenchProofs(size_t nProofs)
+{
+    static std::vector<libzerocoin::SerialNumberSoKProof> vProofs;
+    assert(nProofs <= MAX_PROOFS);
+
+    libzerocoin::ZerocoinParams* ZCParams = GetBenchZerocoinParams();
+    while (vProofs.size() < nProofs) {
+        uint256 msghash = GetRandHash();
+        libzerocoin::PrivateCoin coin(ZCParams, libzerocoin::CoinDenomination::ZQ_TEN, true);
+        libzerocoin::Commitment commitment(&ZCParams->serialNumberSoKCommitmentGroup, coin.getPublicCoin().getValue());
+        libzerocoin::SerialNumberSoK_small sig(ZCParams, coin, commitment, msghash);
+        vProofs.emplace_back(sig, coin.getSerialNumber(), commitment.getCommitmentValue(), msghash);
+    }
+
+    return vProofs;
+}
+
+static void ZerocoinBatchVerify(benchmark::State& state, size_t nProofs)
+{
+    const std::vector<libzerocoin::SerialNumberSoKProof>& vProofs = GetBenchProofs(nProofs);
+    std::vector<const libzerocoin::SerialNumberSoKProof*> vBatch;
+    for (size_t i = 0; i < nProofs; i++)
+        vBatch.emplace_back(&vProofs[i]);
+
+    while (state.KeepRunning()) {
+        bool fValid = libzerocoin::SerialNumberSoKProof::BatchVerify(vBatch);
+        assert(fValid);
+    }
+}
+
+static void ZerocoinBatchVerify1(benchmark::State& state) { ZerocoinBatchVerify(state, 1); }
+static void ZerocoinBatchVerify2(benchmark::State& state) { ZerocoinBatchVerify(state, 2); }
+static void ZerocoinBatchVerify4(benchmark::State& state) { ZerocoinBatchVerify(state, 4); }
+static void ZerocoinBatchVerify8(benchmark::State& state) { ZerocoinBatchVerify(state, 8); }
+static void ZerocoinBatchVerify16(benchmark::State& state) { ZerocoinBatchVerify(state, 16); }
+static void ZerocoinBatchVerify32(benchmark::State& state) { ZerocoinBatchVerify(state, 32); }
+static void ZerocoinBatchVerify64(benchmark::State& state) { ZerocoinBatchVerify(state, 64); }
+static void ZerocoinBatchVerify128(benchmark::State& state) { ZerocoinBatchVerify(state, 128); }
+
+// Same 64 proofs every time, only the -threadbatchverify equivalent changes
+static void ZerocoinThreadedBatchVerify(benchmark::State& state, int nThreads)
+{
+    const std::vector<libzerocoin::SerialNumberSoKProof>& vAll = GetBenchProofs(64);
+    const std::vector<libzerocoin::SerialNumberSoKProof> vProofs(vAll.begin(), vAll.begin() + 64);
+
+    while (state.KeepRunning()) {
+        bool fValid = ThreadedBatchVerify(&vProofs, nThreads);
+        assert(fValid);
+    }
+}
+
+static void ZerocoinThreadedBatchVerify1Thread(benchmark::State& state) { ZerocoinThreadedBatchVerify(state, 1); }
+static void ZerocoinThreadedBatchVerify2Threads(benchmark::State& state) { ZerocoinThreadedBatchVerify(state, 2); }
+static void ZerocoinThreadedBatchVerify4Threads(benchmark::State& state) { ZerocoinThreadedBatchVerify(state, 4); }
+static void ZerocoinThreadedBatchVerify8Threads(benchmark::State& state) { ZerocoinThreadedBatchVerify(state, 8); }
+
+static void AccumulatorIncrement(benchmark::State& state)
+{
+    libzerocoin::ZerocoinParams* ZCParams = GetBenchZerocoinParams();
+    libzerocoin::Accumulator accumulator(ZCParams, libzerocoin::CoinDenomination::ZQ_TEN);
+    const CBigNum bnValue = CBigNum::randBignum(ZCParams->coinCommitmentGroup.modulus);
+
+    while (state.KeepRunning()) {
+        accumulator.increment(bnValue);
+    }
+}
+
+/**
+ * Mirrors the work GenerateAccumulatorWitness does once the mints have been read from disk: start from the
+ * checkpoint before the mint, add every other mint of the denomination found in the following blocks to the
+ * witness and check the result against the checkpoint accumulator. The chain is synthetic so that no block
+ * database is needed.
+ */
+static void AccumulatorWitnessSyntheticChain(benchmark::State& state)
+{
+    libzerocoin::ZerocoinParams* ZCParams = GetBenchZerocoinParams();
+    const libzerocoin::CoinDenomination denom = libzerocoin::CoinDenomination::ZQ_TEN;
+
+    libzerocoin::PrivateCoin coin(ZCParams, denom, true);
+    const libzerocoin::PublicCoin& pubcoin = coin.getPublicCoin();
+    const libzerocoin::Accumulator accumulatorCheckpoint(ZCParams, denom);
+
+    std::vector<std::vector<CBigNum>> vBlockMints(SYNTHETIC_CHAIN_BLOCKS);
+    for (auto& vMints : vBlockMints) {
+        for (int i = 0; i < SYNTHETIC_MINTS_PER_BLOCK; i++)
+            vMints.emplace_back(CBigNum::randBignum(ZCParams->coinCommitmentGroup.modulus));
+    }
+
+    // The accumulator value that would be stored in the checkpoint the witness is generated against
+    libzerocoin::Accumulator accumulatorFinal = accumulatorCheckpoint;
+    accumulatorFinal.increment(pubcoin.getValue());
+    for (const auto& vMints : vBlockMints) {
+        for (const CBigNum& bnValue : vMints)
+            accumulatorFinal.increment(bnValue);
+    }
+
+    while (state.KeepRunning()) {
+        libzerocoin::AccumulatorWitness witness(ZCParams, accumulatorCheckpoint, pubcoin);
+        libzerocoin::Accumulator witnessAccumulator = accumulatorCheckpoint;
+        for (const auto& vMints : vBlockMints) {
+            for (const CBigNum& bnValue : vMints)
+                witnessAccumulator.increment(bnValue);
+        }
+        witness.resetValue(witnessAccumulator, pubcoin);
+        bool fValid = witness.VerifyWitness(accumulatorFinal, pubcoin);
+        assert(fValid);
+    }
+}
+
+// Only one CBigNum backend is compiled in, so the benchmark is named after the one in use
+static void BigNumPowMod(benchmark::State& state)
+{
+    libzerocoin::ZerocoinParams* ZCParams = GetBenchZerocoinParams();
+    const CBigNum& bnModulus = ZCParams->accumulatorParams.accumulatorModulus;
+    const CBigNum bnBase = CBigNum::randBignum(bnModulus);
+    const CBigNum bnExp = CBigNum::randBignum(ZCParams->coinCommitmentGroup.modulus);
+
+    while (state.KeepRunning()) {
+        bnBase.pow_mod(bnExp, bnModulus);
+    }
+}
+
+#if defined(USE_NUM_GMP)
+static void BigNumPowModGMP(benchmark::State& state) { BigNumPowMod(state); }
+BENCHMARK(BigNumPowModGMP, 500);
+#endif
+#if defined(USE_NUM_OPENSSL)
+static void BigNumPowModOpenSSL(benchmark::State& state) { BigNumPowMod(state); }
+BENCHMARK(BigNumPowModOpenSSL, 500);
+#endif
+
+BENCHMARK(ZerocoinBatchVerify1, 10);
+BENCHMARK(ZerocoinBatchVerify2, 8);
+BENCHMARK(ZerocoinBatchVerify4, 6);
+BENCHMARK(ZerocoinBatchVerify8, 4);
+BENCHMARK(ZerocoinBatchVerify16, 2);
+BENCHMARK(ZerocoinBatchVerify32, 1);
+BENCHMARK(ZerocoinBatchVerify64, 1);
+BENCHMARK(ZerocoinBatchVerify128, 1);
+
+BENCHMARK(ZerocoinThreadedBatchVerify1Thread, 1);
+BENCHMARK(ZerocoinThreadedBatchVerify2Threads, 1);
+BENCHMARK(ZerocoinThreadedBatchVerify4Threads, 2);
+BENCHMARK(ZerocoinThreadedBatchVerify8Threads, 2);
+
+BENCHMARK(AccumulatorIncrement, 500);
+BENCHMARK(AccumulatorWitnessSyntheticChain, 2);
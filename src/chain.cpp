@@ -5,6 +5,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <chain.h>
+#include <chainparams.h>
 #include <validation.h>
 #include <hash.h>
 #include <libzerocoin/Denominations.h>
@@ -15,10 +16,30 @@
 /**
  * CChain implementation
  */
+void CChainAlgoStats::Add(const CBlockIndex* pindex)
+{
+    int nAlgo;
+    if (pindex->IsProofOfStake())
+        nAlgo = POS;
+    else if (pindex->IsProgProofOfWork())
+        nAlgo = PROGPOW;
+    else if (pindex->IsRandomXProofOfWork())
+        nAlgo = RANDOMX;
+    else if (pindex->IsSha256DProofOfWork())
+        nAlgo = SHA256D;
+    else if (pindex->IsX16RTProofOfWork())
+        nAlgo = X16RT;
+    else
+        return;
+    nBlocks[nAlgo]++;
+    nWork[nAlgo] += GetBlockProof(*pindex);
+}
+
 void CChain::SetTip(CBlockIndex *pindex) {
     LOCK(cs_vchain);
     if (pindex == nullptr) {
         vChain.clear();
+        vAlgoStats.clear();
         return;
     }
     vChain.resize(pindex->nHeight + 1);
@@ -26,6 +47,36 @@ void CChain::SetTip(CBlockIndex *pindex) {
         vChain[pindex->nHeight] = pindex;
         pindex = pindex->pprev;
     }
+
+    // Drop the sums that include a replaced block, then sum the new blocks
+    int nForkHeight = pindex ? pindex->nHeight + 1 : 0;
+    vAlgoStats.resize(std::min(vAlgoStats.size(), (size_t)nForkHeight / ALGO_STATS_INTERVAL + 1));
+    if (vAlgoStats.empty())
+        vAlgoStats.emplace_back();
+    while (vAlgoStats.size() <= vChain.size() / ALGO_STATS_INTERVAL) {
+        CChainAlgoStats stats = vAlgoStats.back();
+        int nHeight = (vAlgoStats.size() - 1) * ALGO_STATS_INTERVAL;
+        for (int i = 0; i < ALGO_STATS_INTERVAL; i++)
+            stats.Add(vChain[nHeight + i]);
+        vAlgoStats.push_back(stats);
+    }
+}
+
+bool CChain::GetAlgoStats(int nStartHeight, int nEndHeight, CChainAlgoStats& stats) const {
+    LOCK(cs_vchain);
+    if (nStartHeight < 0 || nStartHeight > nEndHeight || nEndHeight >= (int)vChain.size())
+        return false;
+
+    // Sum of the blocks below a height, from the nearest stored sum below it
+    auto SumBelow = [this](int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_vchain) {
+        CChainAlgoStats sum = vAlgoStats[nHeight / ALGO_STATS_INTERVAL];
+        for (int i = nHeight - nHeight % ALGO_STATS_INTERVAL; i < nHeight; i++)
+            sum.Add(vChain[i]);
+        return sum;
+    };
+    stats = SumBelow(nEndHeight + 1);
+    stats -= SumBelow(nStartHeight);
+    return true;
 }
 
 CBlockLocator CChain::GetLocator(const CBlockIndex *pindex) const {
@@ -149,6 +200,37 @@ void CBlockIndex::BuildSkip()
         pskip = pprev->GetAncestor(GetSkipHeight(nHeight));
 }
 
+bool CBlockIndex::IsAlgoLinkTarget(int nAlgoLink) const
+{
+    if (nAlgoLink == ALGO_LINK_POS)
+        return IsProofOfStake();
+
+    // Walks for the newer algorithms stop at the first block before the switchover
+    if (GetBlockTime() < Params().PowUpdateTimestamp())
+        return true;
+    switch (nAlgoLink) {
+        case ALGO_LINK_PROGPOW:
+            return IsProgProofOfWork();
+        case ALGO_LINK_RANDOMX:
+            return IsRandomXProofOfWork();
+        case ALGO_LINK_SHA256D:
+            return IsSha256DProofOfWork();
+    }
+    return false;
+}
+
+void CBlockIndex::BuildAlgoLinks()
+{
+    if (!pprev) {
+        fHaveAlgoLinks = true;
+        return;
+    }
+    // Links are only useful when they are unbroken all the way back
+    fHaveAlgoLinks = pprev->fHaveAlgoLinks;
+    for (int i = 0; i < ALGO_LINK_COUNT; i++)
+        pprevAlgo[i] = pprev->IsAlgoLinkTarget(i) ? pprev : pprev->pprevAlgo[i];
+}
+
 int64_t CBlockIndex::GetBlockWork() const
 {
     int64_t nTimeSpan = 0;
@@ -266,15 +348,63 @@ void CBlockIndex::AddAccumulator(AccumulatorMap mapAccumulator)
     hashAccumulators = SerializeHash(mapAccumulatorHashes);
 }
 
+static CCriticalSection cs_powHashCache;
+
+// Header fields of a block index never change once it is in mapBlockIndex, so neither does its PoW hash. The hash
+// is computed outside of the lock, RandomX and ProgPow hashes take a while and are not worth serializing on.
+template <typename F>
+static uint256 GetCachedPoWHash(const CBlockIndex* pindex, CPoWHashCache::Algo algo, uint256& hashMix, bool fCacheable, F computeHash)
+{
+    {
+        LOCK(cs_powHashCache);
+        const CPoWHashCache::Entry* entry = pindex->powHashCache.Find(algo);
+        if (entry) {
+            hashMix = entry->hashMix;
+            return entry->hash;
+        }
+    }
+
+    uint256 hash = computeHash(hashMix);
+    if (fCacheable && pindex->phashBlock) {
+        LOCK(cs_powHashCache);
+        CPoWHashCache& cache = pindex->powHashCache;
+        if (!cache.Find(algo))
+            cache.entry.reset(new CPoWHashCache::Entry{algo, hash, hashMix, std::move(cache.entry)});
+    }
+    return hash;
+}
+
+uint256 CBlockIndex::GetX16RTPoWHash(bool fSetVeilDataHashNull) const
+{
+    uint256 hashMix;
+    return GetCachedPoWHash(this, fSetVeilDataHashNull ? CPoWHashCache::X16RT_NULL_VEILDATA : CPoWHashCache::X16RT,
+            hashMix, true, [&](uint256&) { return GetBlockHeader().GetX16RTPoWHash(fSetVeilDataHashNull); });
+}
+
+uint256 CBlockIndex::GetSha256DPowHash() const
+{
+    uint256 hashMix;
+    return GetCachedPoWHash(this, CPoWHashCache::SHA256D, hashMix, true,
+            [&](uint256&) { return GetBlockHeader().GetSha256DPoWHash(); });
+}
+
 uint256 CBlockIndex::GetRandomXPoWHash() const
 {
-    return GetRandomXBlockHash(GetBlockHeader().nHeight, GetBlockHeader().GetRandomXHeaderHash());
+    // The RandomX key block comes from the active chain. Only keep the hash if that is the key block of this
+    // block's own chain, a header on a fork or ahead of the synced chain would be hashed with the wrong one.
+    const uint256 keyblock = GetKeyBlock(nHeight);
+    const CBlockIndex* pindexKey = GetAncestor(GetKeyBlockHeight(nHeight));
+    bool fCacheable = pindexKey && pindexKey->phashBlock && pindexKey->GetBlockHash() == keyblock;
+
+    uint256 hashMix;
+    return GetCachedPoWHash(this, CPoWHashCache::RANDOMX, hashMix, fCacheable,
+            [&](uint256&) { return GetRandomXBlockHash(nHeight, GetBlockHeader().GetRandomXHeaderHash(), keyblock); });
 }
 
 uint256 CBlockIndex::GetProgPowHash(uint256& mix_hash) const
 {
-    CBlockHeader header = GetBlockHeader();
-    return ProgPowHash(header, mix_hash);
+    return GetCachedPoWHash(this, CPoWHashCache::PROGPOW, mix_hash, true,
+            [&](uint256& hashMix) { return ProgPowHash(GetBlockHeader(), hashMix); });
 }
 
 void CBlockIndex::CopyBlockHashIntoIndex()
@@ -288,11 +418,13 @@ void CBlockIndex::CopyBlockHashIntoIndex()
 // We are going to be performing a block hash for RandomX. To see if we need to spin up a new
 // cache, we can first check to see if we can use the current validation cache
 uint256 GetRandomXBlockHash(const int32_t& height, const uint256& hash_blob ) {
+    // Get the keyblock for the height
+    return GetRandomXBlockHash(height, hash_blob, GetKeyBlock(height));
+}
 
-    char hash[RANDOMX_HASH_SIZE];
+uint256 GetRandomXBlockHash(const int32_t& height, const uint256& hash_blob, const uint256& temp_keyblock) {
 
-    // Get the keyblock for the height
-    auto temp_keyblock = GetKeyBlock(height);
+    char hash[RANDOMX_HASH_SIZE];
 
     {
     LOCK(cs_randomx_validator);
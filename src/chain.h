@@ -15,6 +15,8 @@
 #include <uint256.h>
 #include <libzerocoin/bignum.h>
 
+#include <algorithm>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <vector>
@@ -172,6 +174,73 @@ enum BlockMemFlags: uint32_t {
     POS_BADWEIGHT = (1 << 0),
 };
 
+/** (memory only) Values GetStakeModifier derives from a block index, computed on
+ * first use. Guarded by cs_stakeModifierCache in stakeinput.cpp. Copies of a block
+ * index start out with an empty cache, they are only ever made to be written to disk.
+ */
+struct CStakeModifierCache
+{
+    //! modifier of blocks staked on top of this block
+    bool fModifier{false};
+    uint64_t nModifier{0};
+    //! rehashed PoW or PoS hash of this block, as sampled into the modifiers of later blocks
+    bool fSampleHash{false};
+    uint256 hashSample{};
+
+    CStakeModifierCache() {}
+    CStakeModifierCache(const CStakeModifierCache&) {}
+    CStakeModifierCache& operator=(const CStakeModifierCache&)
+    {
+        fModifier = false;
+        fSampleHash = false;
+        return *this;
+    }
+};
+
+/** (memory only) The PoW hashes of a block index, computed on first use. A block is checked against its own
+ * algorithm, but stake modifier sampling takes the X16RT hash of any block, so each algorithm asked for gets its
+ * own entry. Guarded by cs_powHashCache in chain.cpp and, like CStakeModifierCache, not carried over to copies of
+ * the block index.
+ */
+struct CPoWHashCache
+{
+    enum Algo : uint8_t {
+        X16RT,
+        X16RT_NULL_VEILDATA,
+        PROGPOW,
+        RANDOMX,
+        SHA256D,
+    };
+    struct Entry
+    {
+        Algo algo;
+        uint256 hash;
+        //! mix hash computed alongside a ProgPow hash
+        uint256 hashMix;
+        //! the entry of another algorithm, at most a few are ever chained
+        std::unique_ptr<const Entry> next;
+    };
+    //! allocated once a hash is known, so block indexes that are never hashed only pay for the pointer
+    std::unique_ptr<const Entry> entry;
+
+    const Entry* Find(Algo algo) const
+    {
+        for (const Entry* p = entry.get(); p; p = p->next.get()) {
+            if (p->algo == algo)
+                return p;
+        }
+        return nullptr;
+    }
+
+    CPoWHashCache() {}
+    CPoWHashCache(const CPoWHashCache&) {}
+    CPoWHashCache& operator=(const CPoWHashCache&)
+    {
+        entry.reset();
+        return *this;
+    }
+};
+
 /** The block chain is a tree shaped structure starting with the
  * genesis block at the root, with each block potentially having multiple
  * candidates to be the next block. A blockindex may have multiple pprev pointing
@@ -192,6 +261,21 @@ public:
     //! pointer to the index of some further predecessor of this block
     CBlockIndex* pskip{nullptr};
 
+    //! Block classes DarkGravityWave averages over, see BuildAlgoLinks()
+    enum AlgoLink {
+        ALGO_LINK_POS,
+        ALGO_LINK_PROGPOW,
+        ALGO_LINK_RANDOMX,
+        ALGO_LINK_SHA256D,
+        ALGO_LINK_COUNT
+    };
+
+    //! pointers to the nearest predecessor of each class, memory only
+    const CBlockIndex* pprevAlgo[ALGO_LINK_COUNT]{};
+
+    //! whether pprevAlgo is filled in for this entry and all of its predecessors
+    bool fHaveAlgoLinks{false};
+
     //! height of the entry in the chain. The genesis block has height 0
     int nHeight{0};
 
@@ -270,6 +354,9 @@ public:
     //! overhead than an empty uint256
     std::vector<unsigned char> vHashProof;
 
+    mutable CStakeModifierCache stakeModifierCache;
+    mutable CPoWHashCache powHashCache;
+
     void ResetMaps()
     {
         for (auto& denom : libzerocoin::zerocoinDenomList) {
@@ -287,6 +374,8 @@ public:
         phashBlock = nullptr;
         pprev = nullptr;
         pskip = nullptr;
+        std::fill(std::begin(pprevAlgo), std::end(pprevAlgo), nullptr);
+        fHaveAlgoLinks = false;
         nHeight = 0;
         nMoneySupply = 0;
         nMint = 0;
@@ -332,6 +421,9 @@ public:
         //ProgPow
         nNonce64       = 0;
         mixHash        = uint256();
+
+        stakeModifierCache = CStakeModifierCache();
+        powHashCache = CPoWHashCache();
     }
 
     CBlockIndex()
@@ -401,19 +493,14 @@ public:
         return *phashBlock;
     }
 
-    uint256 GetX16RTPoWHash(bool fSetVeilDataHashNull = false) const
-    {
-        return GetBlockHeader().GetX16RTPoWHash(fSetVeilDataHashNull);
-    }
+    // The PoW hashes are cached on the block index, see CPoWHashCache
+    uint256 GetX16RTPoWHash(bool fSetVeilDataHashNull = false) const;
 
     uint256 GetProgPowHash(uint256& mix_hash) const;
 
     uint256 GetRandomXPoWHash() const;
 
-    uint256 GetSha256DPowHash() const
-    {
-        return GetBlockHeader().GetSha256DPoWHash();
-    }
+    uint256 GetSha256DPowHash() const;
 
     uint256 GetBlockPoSHash() const
     {
@@ -565,6 +652,12 @@ public:
     //! Build the skiplist pointer for this entry.
     void BuildSkip();
 
+    //! Build the per-algorithm predecessor pointers for this entry, the predecessor's must already be built.
+    void BuildAlgoLinks();
+
+    //! Whether this entry is averaged by, or ends, a DarkGravityWave walk over the given class.
+    bool IsAlgoLinkTarget(int nAlgoLink) const;
+
     //! Efficiently find an ancestor of this block.
     CBlockIndex* GetAncestor(int height);
     const CBlockIndex* GetAncestor(int height) const;
@@ -729,12 +822,46 @@ public:
     }
 };
 
+/** Block counts and work per block class, summed over a range of a chain. */
+struct CChainAlgoStats
+{
+    enum Algo {
+        POS,
+        PROGPOW,
+        RANDOMX,
+        SHA256D,
+        X16RT,
+        COUNT
+    };
+
+    int nBlocks[COUNT]{};
+    arith_uint256 nWork[COUNT]{};
+
+    //! Add a block to the class it was found by, blocks of no known class are not counted
+    void Add(const CBlockIndex* pindex);
+
+    CChainAlgoStats& operator-=(const CChainAlgoStats& other)
+    {
+        for (int i = 0; i < COUNT; i++) {
+            nBlocks[i] -= other.nBlocks[i];
+            nWork[i] -= other.nWork[i];
+        }
+        return *this;
+    }
+};
+
 /** An in-memory indexed chain of blocks. */
 class CChain {
 private:
     mutable CCriticalSection cs_vchain;
     std::vector<CBlockIndex*> vChain GUARDED_BY(cs_vchain);
 
+    //! Number of blocks between the entries of vAlgoStats
+    static constexpr int ALGO_STATS_INTERVAL = 128;
+
+    //! vAlgoStats[i] sums the blocks below height i * ALGO_STATS_INTERVAL, kept up to date by SetTip()
+    std::vector<CChainAlgoStats> vAlgoStats GUARDED_BY(cs_vchain);
+
 public:
     /** Returns the index entry for the genesis block of this chain, or nullptr if none. */
     CBlockIndex *Genesis() const {
@@ -797,8 +924,12 @@ public:
 
     /** Find the earliest block with timestamp equal or greater than the given. */
     CBlockIndex* FindEarliestAtLeast(int64_t nTime) const;
+
+    /** Sum the blocks of this chain from nStartHeight up to and including nEndHeight, visits less than 256 blocks. */
+    bool GetAlgoStats(int nStartHeight, int nEndHeight, CChainAlgoStats& stats) const;
 };
 
 uint256 GetRandomXBlockHash(const int32_t& height, const uint256& hash_blob);
+uint256 GetRandomXBlockHash(const int32_t& height, const uint256& hash_blob, const uint256& keyblock);
 
 #endif // BITCOIN_CHAIN_H
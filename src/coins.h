@@ -127,6 +127,20 @@ public:
     }
 };
 
+class SaltedKeyImageHasher
+{
+private:
+    /** Salt */
+    const uint64_t k0, k1;
+
+public:
+    SaltedKeyImageHasher();
+
+    size_t operator()(const CCmpPubKey& ki) const {
+        return CSipHasher(k0, k1).Write(ki.begin(), ki.size()).Finalize();
+    }
+};
+
 struct CCoinsCacheEntry
 {
     Coin coin; // The actual cached data.
@@ -26,6 +26,7 @@
 #include <libzerocoin/CoinSpend.h>
 #include <veil/zerocoin/zchain.h>
 #include <primitives/zerocoin.h>
+#include <veil/validationstats.h>
 
 bool IsFinalTx(const CTransaction &tx, int nBlockHeight, int64_t nBlockTime)
 {
@@ -276,7 +277,7 @@ bool CheckStandardOutput(CValidationState &state, const Consensus::Params& conse
     return CheckValue(state, p->nValue, nValueOut);
 }
 
-bool CheckBlindOutput(CValidationState &state, const CTxOutCT *p)
+bool CheckBlindOutput(CValidationState &state, const CTxOutCT *p, bool fSkipRangeproofVerify)
 {
     if (p->vData.size() < 33 || p->vData.size() > 33 + 5)
         return state.DoS(100, false, REJECT_INVALID, "bad-ctout-ephem-size");
@@ -286,9 +287,10 @@ bool CheckBlindOutput(CValidationState &state, const CTxOutCT *p)
         return state.DoS(100, false, REJECT_INVALID, "bad-ctout-rangeproof-size");
 
 
-    if (/*todo: fBusyImporting && */ fSkipRangeproof)
+    if (/*todo: fBusyImporting && */ fSkipRangeproof || fSkipRangeproofVerify)
         return true;
 
+    ValidationStageTimer timer(ValidationStage::RANGEPROOF);
     uint64_t min_value, max_value;
     int rv = secp256k1_rangeproof_verify(secp256k1_ctx_blind, &min_value, &max_value, &p->commitment, p->vRangeproof.data(),
             p->vRangeproof.size(), nullptr, 0, secp256k1_generator_h);
@@ -299,7 +301,7 @@ bool CheckBlindOutput(CValidationState &state, const CTxOutCT *p)
     return true;
 }
 
-bool CheckAnonOutput(CValidationState &state, const CTxOutRingCT *p)
+bool CheckAnonOutput(CValidationState &state, const CTxOutRingCT *p, bool fSkipRangeproofVerify)
 {
     if (p->vData.size() < 33 || p->vData.size() > 33 + 5)
         return state.DoS(100, false, REJECT_INVALID, "bad-rctout-ephem-size");
@@ -308,9 +310,10 @@ bool CheckAnonOutput(CValidationState &state, const CTxOutRingCT *p)
     if (p->vRangeproof.size() > nRangeProofLen)
         return state.DoS(100, false, REJECT_INVALID, "bad-rctout-rangeproof-size");
 
-    if (/* todo: fBusyImporting && */ fSkipRangeproof)
+    if (/* todo: fBusyImporting && */ fSkipRangeproof || fSkipRangeproofVerify)
         return true;
 
+    ValidationStageTimer timer(ValidationStage::RANGEPROOF);
     uint64_t min_value, max_value;
     int rv = secp256k1_rangeproof_verify(secp256k1_ctx_blind, &min_value, &max_value, &p->commitment, p->vRangeproof.data(),
             p->vRangeproof.size(), nullptr, 0, secp256k1_generator_h);
@@ -333,7 +336,7 @@ bool CheckDataOutput(CValidationState &state, const CTxOutData *p)
     return true;
 }
 
-bool CheckTransaction(const CTransaction& tx, CValidationState &state, bool fSkipZerocoinMintIsPrime)
+bool CheckTransaction(const CTransaction& tx, CValidationState &state, bool fSkipZerocoinMintIsPrime, bool fSkipRangeproofVerify)
 {
     // Basic checks that don't depend on any context
     if (tx.vin.empty())
@@ -374,12 +377,12 @@ bool CheckTransaction(const CTransaction& tx, CValidationState &state, bool fSki
                 break;
             }
             case OUTPUT_CT:
-                if (!CheckBlindOutput(state, (CTxOutCT*) txout.get()))
+                if (!CheckBlindOutput(state, (CTxOutCT*) txout.get(), fSkipRangeproofVerify))
                     return false;
                 nCTOut++;
                 break;
             case OUTPUT_RINGCT:
-                if (!CheckAnonOutput(state, (CTxOutRingCT*) txout.get()))
+                if (!CheckAnonOutput(state, (CTxOutRingCT*) txout.get(), fSkipRangeproofVerify))
                     return false;
                 nRingCTOut++;
                 break;
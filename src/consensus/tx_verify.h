@@ -19,8 +19,8 @@ class CValidationState;
 
 /** Transaction validation functions */
 
-/** Context-independent validity checks */
-bool CheckTransaction(const CTransaction& tx, CValidationState& state, bool fSkipZerocoinMintIsPrime=false);
+/** Context-independent validity checks. fSkipRangeproofVerify is for transactions whose range proofs were already verified. */
+bool CheckTransaction(const CTransaction& tx, CValidationState& state, bool fSkipZerocoinMintIsPrime=false, bool fSkipRangeproofVerify=false);
 bool CheckZerocoinMint(const CTxOut& txout, CBigNum& bnValue, CValidationState& state, bool fSkipZerocoinMintIsPrime);
 bool CheckZerocoinSpend(const CTransaction& tx, CValidationState& state);
 
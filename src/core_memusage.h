@@ -38,19 +38,19 @@ static inline size_t RecursiveDynamicUsage(const CTxOutBaseRef& pOut) {
             break;
         case OutputTypes::OUTPUT_RINGCT:
         {
-            auto* outRingCT = dynamic_cast<CTxOutRingCT*>(pOut.get());
+            auto* outRingCT = static_cast<const CTxOutRingCT*>(pOut.get());
             mem += memusage::DynamicUsage(outRingCT->vData) + memusage::DynamicUsage(outRingCT->vRangeproof);
             break;
         }
         case OutputTypes::OUTPUT_CT :
         {
-            auto outCT = dynamic_cast<CTxOutCT*>(pOut.get());
+            auto outCT = static_cast<const CTxOutCT*>(pOut.get());
             mem += RecursiveDynamicUsage(outCT->scriptPubKey) + memusage::DynamicUsage(outCT->vRangeproof) + memusage::DynamicUsage(outCT->vData);
             break;
         }
         case OutputTypes::OUTPUT_DATA :
         {
-            auto outData = dynamic_cast<CTxOutData*>(pOut.get());
+            auto outData = static_cast<const CTxOutData*>(pOut.get());
             mem += memusage::DynamicUsage(outData->vData);
             break;
         }
@@ -22,11 +22,13 @@ void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 namespace sha256d64_sse41
 {
 void Transform_4way(unsigned char* out, const unsigned char* in);
+void Transform_4way_D80(unsigned char* out, const uint32_t* midstate, const unsigned char* in);
 }
 
 namespace sha256d64_avx2
 {
 void Transform_8way(unsigned char* out, const unsigned char* in);
+void Transform_8way_D80(unsigned char* out, const uint32_t* midstate, const unsigned char* in);
 }
 
 namespace sha256d64_shani
@@ -456,11 +458,55 @@ void TransformD64Wrapper(unsigned char* out, const unsigned char* in)
     WriteBE32(out + 28, s[7]);
 }
 
+typedef void (*TransformD80Type)(unsigned char*, const uint32_t*, const unsigned char*);
+
+template<TransformType tr>
+void TransformD80Wrapper(unsigned char* out, const uint32_t* midstate, const unsigned char* in)
+{
+    uint32_t s[8];
+    unsigned char buffer1[64] = {
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0x80
+    };
+    unsigned char buffer2[64] = {
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0
+    };
+    std::copy(midstate, midstate + 8, s);
+    memcpy(buffer1, in, 16);
+    tr(s, buffer1, 1);
+    WriteBE32(buffer2 + 0, s[0]);
+    WriteBE32(buffer2 + 4, s[1]);
+    WriteBE32(buffer2 + 8, s[2]);
+    WriteBE32(buffer2 + 12, s[3]);
+    WriteBE32(buffer2 + 16, s[4]);
+    WriteBE32(buffer2 + 20, s[5]);
+    WriteBE32(buffer2 + 24, s[6]);
+    WriteBE32(buffer2 + 28, s[7]);
+    sha256::Initialize(s);
+    tr(s, buffer2, 1);
+    WriteBE32(out + 0, s[0]);
+    WriteBE32(out + 4, s[1]);
+    WriteBE32(out + 8, s[2]);
+    WriteBE32(out + 12, s[3]);
+    WriteBE32(out + 16, s[4]);
+    WriteBE32(out + 20, s[5]);
+    WriteBE32(out + 24, s[6]);
+    WriteBE32(out + 28, s[7]);
+}
+
 TransformType Transform = sha256::Transform;
 TransformD64Type TransformD64 = sha256::TransformD64;
 TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
+TransformD80Type TransformD80 = TransformD80Wrapper<sha256::Transform>;
+TransformD80Type TransformD80_4way = nullptr;
+TransformD80Type TransformD80_8way = nullptr;
 
 bool SelfTest() {
     // Input state (equal to the initial SHA256 state)
@@ -544,6 +590,28 @@ bool SelfTest() {
         if (!std::equal(out, out + 256, result_d64)) return false;
     }
 
+    // Test the TransformD80 variants against the reference implementation, for 8 80-byte messages that share
+    // the first 64 input bytes and take their last 16 bytes from the input bytes after that.
+    unsigned char result_d80[256];
+    for (size_t i = 0; i < 8; ++i) {
+        TransformD80Wrapper<sha256::Transform>(result_d80 + 32 * i, result[1], data + 65 + 16 * i);
+    }
+    for (size_t i = 0; i < 8; ++i) {
+        TransformD80(out, result[1], data + 65 + 16 * i);
+        if (!std::equal(out, out + 32, result_d80 + 32 * i)) return false;
+    }
+    if (TransformD80_4way) {
+        unsigned char out[256];
+        TransformD80_4way(out, result[1], data + 65);
+        TransformD80_4way(out + 128, result[1], data + 129);
+        if (!std::equal(out, out + 256, result_d80)) return false;
+    }
+    if (TransformD80_8way) {
+        unsigned char out[256];
+        TransformD80_8way(out, result[1], data + 65);
+        if (!std::equal(out, out + 256, result_d80)) return false;
+    }
+
     return true;
 }
 
@@ -608,6 +676,7 @@ std::string SHA256AutoDetect()
         Transform = sha256_shani::Transform;
         TransformD64 = TransformD64Wrapper<sha256_shani::Transform>;
         TransformD64_2way = sha256d64_shani::Transform_2way;
+        TransformD80 = TransformD80Wrapper<sha256_shani::Transform>;
         ret = "shani(1way,2way)";
         have_sse4 = false; // Disable SSE4/AVX2;
         have_avx2 = false;
@@ -618,10 +687,12 @@ std::string SHA256AutoDetect()
 #if defined(__x86_64__) || defined(__amd64__)
         Transform = sha256_sse4::Transform;
         TransformD64 = TransformD64Wrapper<sha256_sse4::Transform>;
+        TransformD80 = TransformD80Wrapper<sha256_sse4::Transform>;
         ret = "sse4(1way)";
 #endif
 #if defined(ENABLE_SSE41) && !defined(BUILD_BITCOIN_INTERNAL)
         TransformD64_4way = sha256d64_sse41::Transform_4way;
+        TransformD80_4way = sha256d64_sse41::Transform_4way_D80;
         ret += ",sse41(4way)";
 #endif
     }
@@ -629,6 +700,7 @@ std::string SHA256AutoDetect()
 #if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
     if (have_avx2 && have_avx && enabled_avx) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformD80_8way = sha256d64_avx2::Transform_8way_D80;
         ret += ",avx2(8way)";
     }
 #endif
@@ -728,3 +800,35 @@ void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
         --blocks;
     }
 }
+
+void SHA256D80Midstate(uint32_t* midstate, const unsigned char* input)
+{
+    sha256::Initialize(midstate);
+    Transform(midstate, input, 1);
+}
+
+void SHA256D80(unsigned char* out, const uint32_t* midstate, const unsigned char* in, size_t count)
+{
+    if (TransformD80_8way) {
+        while (count >= 8) {
+            TransformD80_8way(out, midstate, in);
+            out += 256;
+            in += 128;
+            count -= 8;
+        }
+    }
+    if (TransformD80_4way) {
+        while (count >= 4) {
+            TransformD80_4way(out, midstate, in);
+            out += 128;
+            in += 64;
+            count -= 4;
+        }
+    }
+    while (count) {
+        TransformD80(out, midstate, in);
+        out += 32;
+        in += 16;
+        --count;
+    }
+}
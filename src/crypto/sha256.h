@@ -38,4 +38,19 @@ std::string SHA256AutoDetect();
  */
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
+/** Compute the SHA-256 state after the first 64 bytes of a message, for SHA256D80.
+ *  midstate: pointer to an 8 word output buffer
+ *  input:    pointer to the 64 byte start of the message
+ */
+void SHA256D80Midstate(uint32_t* midstate, const unsigned char* input);
+
+/** Compute multiple double-SHA256's of 80-byte messages that share their first
+ *  64 bytes, such as headers that only differ in their nonce.
+ *  output:   pointer to a count*32 byte output buffer
+ *  midstate: the SHA256D80Midstate of the shared first 64 bytes
+ *  input:    pointer to a count*16 byte buffer with the last 16 bytes of each message
+ *  count:    the number of hashes to compute.
+ */
+void SHA256D80(unsigned char* output, const uint32_t* midstate, const unsigned char* input, size_t count);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
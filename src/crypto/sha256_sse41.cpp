@@ -59,6 +59,51 @@ void inline Write4(unsigned char* out, int offset, __m128i v) {
     WriteLE32(out + 96 + offset, _mm_extract_epi32(v, 0));
 }
 
+__m128i inline Read4D80(const unsigned char* in, int offset) {
+    __m128i ret = _mm_set_epi32(
+        ReadLE32(in + 0 + offset),
+        ReadLE32(in + 16 + offset),
+        ReadLE32(in + 32 + offset),
+        ReadLE32(in + 48 + offset)
+    );
+    return _mm_shuffle_epi8(ret, _mm_set_epi32(0x0C0D0E0FUL, 0x08090A0BUL, 0x04050607UL, 0x00010203UL));
+}
+
+/** Message schedule entry i, computed in place from the 16 entries before it. */
+__m128i inline __attribute__((always_inline)) W(__m128i* w, int i)
+{
+    if (i >= 16) Inc(w[i & 15], sigma1(w[(i + 14) & 15]), w[(i + 9) & 15], sigma0(w[(i + 1) & 15]));
+    return w[i & 15];
+}
+
+/** One SHA-256 compression of the message schedule w into the state s. */
+void inline Compress(__m128i* s, __m128i* w)
+{
+    static const uint32_t k[64] = {
+        0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+        0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+        0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul, 0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+        0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+        0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+        0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+        0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+        0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul, 0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul
+    };
+    __m128i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int i = 0; i < 64; i += 8) {
+        Round(a, b, c, d, e, f, g, h, Add(K(k[i + 0]), W(w, i + 0)));
+        Round(h, a, b, c, d, e, f, g, Add(K(k[i + 1]), W(w, i + 1)));
+        Round(g, h, a, b, c, d, e, f, Add(K(k[i + 2]), W(w, i + 2)));
+        Round(f, g, h, a, b, c, d, e, Add(K(k[i + 3]), W(w, i + 3)));
+        Round(e, f, g, h, a, b, c, d, Add(K(k[i + 4]), W(w, i + 4)));
+        Round(d, e, f, g, h, a, b, c, Add(K(k[i + 5]), W(w, i + 5)));
+        Round(c, d, e, f, g, h, a, b, Add(K(k[i + 6]), W(w, i + 6)));
+        Round(b, c, d, e, f, g, h, a, Add(K(k[i + 7]), W(w, i + 7)));
+    }
+    Inc(s[0], a); Inc(s[1], b); Inc(s[2], c); Inc(s[3], d);
+    Inc(s[4], e); Inc(s[5], f); Inc(s[6], g); Inc(s[7], h);
+}
+
 }
 
 void Transform_4way(unsigned char* out, const unsigned char* in)
@@ -312,6 +357,31 @@ void Transform_4way(unsigned char* out, const unsigned char* in)
     Write4(out, 28, Add(h, K(0x5be0cd19ul)));
 }
 
+void Transform_4way_D80(unsigned char* out, const uint32_t* midstate, const unsigned char* in)
+{
+    __m128i s[8], w[16];
+
+    // Transform 1: the last 16 bytes of each message and the padding, from the midstate
+    for (int i = 0; i < 8; ++i) s[i] = K(midstate[i]);
+    for (int i = 0; i < 4; ++i) w[i] = Read4D80(in, 4 * i);
+    w[4] = K(0x80000000ul);
+    for (int i = 5; i < 15; ++i) w[i] = K(0);
+    w[15] = K(640);
+    Compress(s, w);
+
+    // Transform 2: the 32 byte hash and the padding, from the initial state
+    for (int i = 0; i < 8; ++i) w[i] = s[i];
+    w[8] = K(0x80000000ul);
+    for (int i = 9; i < 15; ++i) w[i] = K(0);
+    w[15] = K(256);
+    s[0] = K(0x6a09e667ul); s[1] = K(0xbb67ae85ul); s[2] = K(0x3c6ef372ul); s[3] = K(0xa54ff53aul);
+    s[4] = K(0x510e527ful); s[5] = K(0x9b05688cul); s[6] = K(0x1f83d9abul); s[7] = K(0x5be0cd19ul);
+    Compress(s, w);
+
+    // Output
+    for (int i = 0; i < 8; ++i) Write4(out, 4 * i, s[i]);
+}
+
 }
 
 #endif
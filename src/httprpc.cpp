@@ -7,6 +7,7 @@
 #include <chainparams.h>
 #include <httpserver.h>
 #include <key_io.h>
+#include <rpc/jsonstream.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <random.h>
@@ -27,6 +28,19 @@
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/** How much of a request body is looked at to pick its work queue lane */
+static const size_t MAX_LANE_PEEK_SIZE = 64 * 1024;
+
+/** Methods that scan the chain or the wallet, queued on the heavy lane unless -rpclane says otherwise */
+static const char* const DEFAULT_HEAVY_METHODS[] = {
+    "rescanblockchain", "rescanringctwallet", "rescanzerocoinwallet", "getwatchonlytxes",
+    "importwallet", "dumpwallet", "importprivkey", "importaddress", "importpubkey", "importmulti",
+    "importzerocoins", "scantxoutset", "gettxoutsetinfo", "verifychain",
+};
+
+/** Work queue lane of the methods that don't go to the lane of their category */
+static std::map<std::string, HTTPWorkLane> mapMethodLanes;
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -82,6 +96,8 @@ static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const Uni
 
     std::string strReply = JSONRPCReply(NullUniValue, objError, id);
 
+    // Drop the part of a streamed reply that was written before the error
+    req->DiscardReplyParts();
     req->WriteHeader("Content-Type", "application/json");
     req->WriteReply(nStatus, strReply);
 }
@@ -191,10 +207,27 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         if (valRequest.isObject()) {
             jreq.parse(valRequest);
 
+            // Write the reply straight into the reply buffer, methods with
+            // large results stream their result into it as well
+            JSONStreamWriter writer([req](const std::string& strPart) { req->WriteReplyPart(strPart); });
+            jreq.stream = &writer;
+            writer.BeginObject();
+            writer.Key("result");
+
             UniValue result = tableRPC.execute(jreq);
+            if (writer.ExpectsValue())
+                writer.Value(result);
+
+            writer.Key("error");
+            writer.Value(NullUniValue);
+            writer.Key("id");
+            writer.Value(jreq.id);
+            writer.EndObject();
+            writer.Flush();
+            jreq.stream = nullptr;
 
             // Send reply
-            strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            strReply = "\n";
 
         // array of requests
         } else if (valRequest.isArray())
@@ -236,17 +269,79 @@ static bool InitRPCAuthentication()
     return true;
 }
 
+static HTTPWorkLane GetMethodLane(const std::string& strMethod)
+{
+    auto it = mapMethodLanes.find(strMethod);
+    if (it != mapMethodLanes.end())
+        return it->second;
+    const CRPCCommand* pcmd = tableRPC[strMethod];
+    if (pcmd && (pcmd->category == "wallet" || pcmd->category == "zerocoin"))
+        return HTTPWorkLane::WALLET;
+    return HTTPWorkLane::CHEAP;
+}
+
+HTTPWorkLane GetJSONRPCRequestLane(const std::string& strBody)
+{
+    static const std::string strKey = "\"method\"";
+    static const char* strSpace = " \t\r\n";
+    HTTPWorkLane lane = HTTPWorkLane::CHEAP;
+    size_t nPos = 0;
+    while ((nPos = strBody.find(strKey, nPos)) != std::string::npos) {
+        nPos = strBody.find_first_not_of(strSpace, nPos + strKey.size());
+        if (nPos == std::string::npos || strBody[nPos] != ':')
+            continue;
+        nPos = strBody.find_first_not_of(strSpace, nPos + 1);
+        if (nPos == std::string::npos || strBody[nPos] != '"')
+            continue;
+        size_t nEnd = strBody.find('"', nPos + 1);
+        if (nEnd == std::string::npos)
+            break;
+        lane = std::max(lane, GetMethodLane(strBody.substr(nPos + 1, nEnd - nPos - 1)));
+        nPos = nEnd + 1;
+    }
+    return lane;
+}
+
+/** Queue a request or batch on the heaviest lane of the methods it calls */
+static HTTPWorkLane HTTPReq_JSONRPCLane(HTTPRequest* req, const std::string&)
+{
+    if (req->GetRequestMethod() != HTTPRequest::POST)
+        return HTTPWorkLane::CHEAP;
+    return GetJSONRPCRequestLane(req->PeekBody(MAX_LANE_PEEK_SIZE));
+}
+
+bool InitRPCMethodLanes(std::string& strError)
+{
+    mapMethodLanes.clear();
+    for (const char* strMethod : DEFAULT_HEAVY_METHODS)
+        mapMethodLanes[strMethod] = HTTPWorkLane::HEAVY;
+
+    for (const std::string& strValue : gArgs.GetArgs("-rpclane")) {
+        size_t nSep = strValue.find(':');
+        HTTPWorkLane lane;
+        if (nSep == std::string::npos || !ParseHTTPWorkLane(strValue.substr(nSep + 1), lane)) {
+            strError = strprintf("Invalid -rpclane value %s, expected <method>:<lane> with lane one of cheap, wallet or heavy", strValue);
+            return false;
+        }
+        mapMethodLanes[strValue.substr(0, nSep)] = lane;
+    }
+    return true;
+}
+
 bool StartHTTPRPC()
 {
     LogPrint(BCLog::RPC, "Starting HTTP RPC server\n");
     if (!InitRPCAuthentication())
         return false;
+    std::string strError;
+    if (!InitRPCMethodLanes(strError))
+        return InitError(strError);
 
-    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC);
+    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC, HTTPReq_JSONRPCLane);
 #ifdef ENABLE_WALLET
     // ifdef can be removed once we switch to better endpoint support and API versioning
     if (!gArgs.GetBoolArg("-disablewallet", DEFAULT_DISABLE_WALLET))
-        RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC);
+        RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC, HTTPReq_JSONRPCLane);
 #endif
     assert(EventBase());
     httpRPCTimerInterface = MakeUnique<HTTPRPCTimerInterface>(EventBase());
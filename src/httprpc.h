@@ -5,6 +5,8 @@
 #ifndef BITCOIN_HTTPRPC_H
 #define BITCOIN_HTTPRPC_H
 
+#include <httpserver.h>
+
 #include <string>
 #include <map>
 
@@ -20,6 +22,18 @@ void InterruptHTTPRPC();
  */
 void StopHTTPRPC();
 
+/** Set up the lanes of the methods that don't go to the lane of their RPC
+ * category, from the default heavy methods and -rpclane.
+ */
+bool InitRPCMethodLanes(std::string& strError);
+/** The work queue lane of a JSON-RPC request or batch: the heaviest lane of
+ * the methods it calls. This runs on the event loop thread, so rather than
+ * parsing the body the start of it is scanned for "method" keys. A body that
+ * fools the scan only ends up waiting in another lane, it is parsed properly
+ * by the worker.
+ */
+HTTPWorkLane GetJSONRPCRequestLane(const std::string& strBody);
+
 /** Start HTTP REST subsystem.
  * Precondition; HTTP and RPC has been started.
  */
@@ -13,6 +13,7 @@
 #include <sync.h>
 #include <ui_interface.h>
 
+#include <array>
 #include <memory>
 #include <deque>
 #include <stdio.h>
@@ -62,77 +63,17 @@ private:
     HTTPRequestHandler func;
 };
 
-/** Simple work queue for distributing work over multiple threads.
- * Work items are simply callable objects.
- */
-template <typename WorkItem>
-class WorkQueue
-{
-private:
-    /** Mutex protects entire object */
-    std::mutex cs;
-    std::condition_variable cond;
-    std::deque<std::unique_ptr<WorkItem>> queue;
-    bool running;
-    size_t maxDepth;
-
-public:
-    explicit WorkQueue(size_t _maxDepth) : running(true),
-                                 maxDepth(_maxDepth)
-    {
-    }
-    /** Precondition: worker threads have all stopped (they have been joined).
-     */
-    ~WorkQueue()
-    {
-    }
-    /** Enqueue a work item */
-    bool Enqueue(WorkItem* item)
-    {
-        std::unique_lock<std::mutex> lock(cs);
-        if (queue.size() >= maxDepth) {
-            return false;
-        }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
-        cond.notify_one();
-        return true;
-    }
-    /** Thread function */
-    void Run()
-    {
-        while (true) {
-            std::unique_ptr<WorkItem> i;
-            {
-                std::unique_lock<std::mutex> lock(cs);
-                while (running && queue.empty())
-                    cond.wait(lock);
-                if (!running)
-                    break;
-                i = std::move(queue.front());
-                queue.pop_front();
-            }
-            (*i)();
-        }
-    }
-    /** Interrupt and exit loops */
-    void Interrupt()
-    {
-        std::unique_lock<std::mutex> lock(cs);
-        running = false;
-        cond.notify_all();
-    }
-};
-
 struct HTTPPathHandler
 {
     HTTPPathHandler() {}
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPLaneClassifier _classifier):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), classifier(_classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPLaneClassifier classifier;
 };
 
 /** HTTP module state */
@@ -145,6 +86,8 @@ struct evhttp* eventHTTP = nullptr;
 static std::vector<CSubNet> rpc_allow_subnets;
 //! Work queue for handling longer requests off the event loop thread
 static WorkQueue<HTTPClosure>* workQueue = nullptr;
+//! Number of worker threads of each work queue lane
+static std::array<int, HTTP_WORK_LANES> laneThreads;
 //! Handlers for (sub)paths
 std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
@@ -259,12 +202,13 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
+        HTTPWorkLane lane = i->classifier ? i->classifier(hreq.get(), path) : HTTPWorkLane::CHEAP;
         std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
         assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        if (workQueue->Enqueue(item.get(), lane))
             item.release(); /* if true, queue took ownership */
         else {
-            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
+            LogPrintf("WARNING: request rejected because http work queue depth of the %s lane exceeded, it can be increased with the -rpcworkqueue= or -rpclanedepth= settings\n", GetHTTPWorkLaneName(lane));
             item->req->WriteReply(HTTP_INTERNAL, "Work queue depth exceeded");
         }
     } else {
@@ -329,10 +273,54 @@ static bool HTTPBindAddresses(struct evhttp* http)
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue)
+static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, HTTPWorkLane lane)
 {
     RenameThread("veil-httpworker");
-    queue->Run();
+    queue->Run(lane);
+}
+
+/** Apply the <lane>:<n> values of a multi-valued argument to the lanes they name */
+template <typename T>
+static bool ParseHTTPLaneArgs(const std::string& strArg, std::array<T, HTTP_WORK_LANES>& values, std::string& strError)
+{
+    for (const std::string& strValue : gArgs.GetArgs(strArg)) {
+        size_t nSep = strValue.find(':');
+        HTTPWorkLane lane;
+        int32_t n;
+        if (nSep == std::string::npos || !ParseHTTPWorkLane(strValue.substr(0, nSep), lane) ||
+                !ParseInt32(strValue.substr(nSep + 1), &n) || n < 1) {
+            strError = strprintf("Invalid %s value %s, expected <lane>:<n> with lane one of cheap, wallet or heavy and n at least 1", strArg, strValue);
+            return false;
+        }
+        values[(size_t)lane] = n;
+    }
+    return true;
+}
+
+bool GetHTTPWorkLaneDepths(std::array<size_t, HTTP_WORK_LANES>& depths, std::string& strError)
+{
+    int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
+    depths.fill(workQueueDepth);
+    return ParseHTTPLaneArgs("-rpclanedepth", depths, strError);
+}
+
+bool GetHTTPWorkLaneThreads(std::array<int, HTTP_WORK_LANES>& threads, std::string& strError)
+{
+    threads.fill(0);
+    if (!ParseHTTPLaneArgs("-rpclanethreads", threads, strError))
+        return false;
+
+    int& nCheap = threads[(size_t)HTTPWorkLane::CHEAP];
+    int& nWallet = threads[(size_t)HTTPWorkLane::WALLET];
+    int& nHeavy = threads[(size_t)HTTPWorkLane::HEAVY];
+    int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
+    if (nHeavy == 0)
+        nHeavy = DEFAULT_HTTP_LANE_THREADS;
+    if (nWallet == 0)
+        nWallet = std::max(rpcThreads - nHeavy - (nCheap ? nCheap : DEFAULT_HTTP_LANE_THREADS), 1);
+    if (nCheap == 0)
+        nCheap = std::max(rpcThreads - nWallet - nHeavy, 1);
+    return true;
 }
 
 /** libevent event log callback */
@@ -396,10 +384,15 @@ bool InitHTTPServer()
     }
 
     LogPrint(BCLog::HTTP, "Initialized HTTP server\n");
-    int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
-    LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
+    std::array<size_t, HTTP_WORK_LANES> laneDepths;
+    std::string strError;
+    if (!GetHTTPWorkLaneDepths(laneDepths, strError) || !GetHTTPWorkLaneThreads(laneThreads, strError))
+        return InitError(strError);
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    for (size_t n = 0; n < HTTP_WORK_LANES; n++)
+        LogPrintf("HTTP: creating %s work queue lane of depth %d\n", GetHTTPWorkLaneName((HTTPWorkLane)n), laneDepths[n]);
+
+    workQueue = new WorkQueue<HTTPClosure>(laneDepths);
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -427,14 +420,15 @@ static std::vector<std::thread> g_thread_http_workers;
 void StartHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Starting HTTP server\n");
-    int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogPrintf("HTTP: starting %d worker threads\n", rpcThreads);
     std::packaged_task<bool(event_base*)> task(ThreadHTTP);
     threadResult = task.get_future();
     threadHTTP = std::thread(std::move(task), eventBase);
 
-    for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue);
+    for (size_t n = 0; n < HTTP_WORK_LANES; n++) {
+        LogPrintf("HTTP: starting %d worker threads for the %s lane\n", laneThreads[n], GetHTTPWorkLaneName((HTTPWorkLane)n));
+        for (int i = 0; i < laneThreads[n]; i++) {
+            g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue, (HTTPWorkLane)n);
+        }
     }
 }
 
@@ -568,6 +562,18 @@ std::string HTTPRequest::ReadBody()
     return rv;
 }
 
+std::string HTTPRequest::PeekBody(size_t nMaxSize)
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    size_t size = std::min(evbuffer_get_length(buf), nMaxSize);
+    std::string rv(size, '\0');
+    if (size > 0 && evbuffer_copyout(buf, &rv[0], size) != (ev_ssize_t)size)
+        return "";
+    return rv;
+}
+
 void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 {
     struct evkeyvalq* headers = evhttp_request_get_output_headers(req);
@@ -580,6 +586,22 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
  * Replies must be sent in the main loop in the main http thread,
  * this cannot be done from worker threads.
  */
+void HTTPRequest::WriteReplyPart(const std::string& strPart)
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_add(evb, strPart.data(), strPart.size());
+}
+
+void HTTPRequest::DiscardReplyParts()
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_drain(evb, evbuffer_get_length(evb));
+}
+
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
 {
     assert(!replySent && req);
@@ -647,10 +669,33 @@ HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod()
     }
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler,
+                         const HTTPLaneClassifier &classifier)
 {
     LogPrint(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
-    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler));
+    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler, classifier));
+}
+
+const char* GetHTTPWorkLaneName(HTTPWorkLane lane)
+{
+    switch (lane) {
+    case HTTPWorkLane::CHEAP: return "cheap";
+    case HTTPWorkLane::WALLET: return "wallet";
+    case HTTPWorkLane::HEAVY: return "heavy";
+    case HTTPWorkLane::COUNT: break;
+    }
+    return "unknown";
+}
+
+bool ParseHTTPWorkLane(const std::string& name, HTTPWorkLane& lane)
+{
+    for (size_t n = 0; n < (size_t)HTTPWorkLane::COUNT; n++) {
+        if (name == GetHTTPWorkLaneName((HTTPWorkLane)n)) {
+            lane = (HTTPWorkLane)n;
+            return true;
+        }
+    }
+    return false;
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
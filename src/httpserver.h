@@ -5,13 +5,19 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
-#include <string>
-#include <stdint.h>
+#include <array>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
+static const int DEFAULT_HTTP_LANE_THREADS=1;
 
 struct evhttp_request;
 struct event_base;
@@ -36,13 +42,130 @@ void StopHTTPServer();
  * libevent doesn't support debug logging.*/
 bool UpdateHTTPServerLogging(bool enable);
 
+/** Work queue lanes, from lightest to heaviest.
+ * Every lane has its own queue, depth limit and worker threads, so requests
+ * only ever wait behind requests of the same lane. Idle workers of a lane
+ * help out with the lighter lanes, never with the heavier ones.
+ */
+enum class HTTPWorkLane {
+    CHEAP,
+    WALLET,
+    HEAVY,
+    COUNT
+};
+static const size_t HTTP_WORK_LANES = (size_t)HTTPWorkLane::COUNT;
+const char* GetHTTPWorkLaneName(HTTPWorkLane lane);
+bool ParseHTTPWorkLane(const std::string& name, HTTPWorkLane& lane);
+
+/** The depth of every work queue lane, from -rpcworkqueue and -rpclanedepth */
+bool GetHTTPWorkLaneDepths(std::array<size_t, HTTP_WORK_LANES>& depths, std::string& strError);
+/** The worker threads of every work queue lane, from -rpcthreads and -rpclanethreads.
+ * Lanes that aren't set explicitly share out -rpcthreads: the heavy and cheap
+ * lanes get DEFAULT_HTTP_LANE_THREADS and the wallet lane the rest, so wallet
+ * calls can still run on all workers but those kept for cheap calls.
+ */
+bool GetHTTPWorkLaneThreads(std::array<int, HTTP_WORK_LANES>& threads, std::string& strError);
+
+/** Work queue for distributing work over multiple threads, split in lanes.
+ * Work items are simply callable objects. Every lane has its own depth limit
+ * and its own workers. A worker runs the items of its own lane first and the
+ * items of the lighter lanes when its own lane is empty, so slow requests can
+ * only ever hold up the workers of their own lane.
+ */
+template <typename WorkItem>
+class WorkQueue
+{
+public:
+    static const size_t LANES = HTTP_WORK_LANES;
+
+private:
+    /** Mutex protects entire object */
+    std::mutex cs;
+    std::condition_variable cond;
+    std::array<std::deque<std::unique_ptr<WorkItem>>, LANES> queues;
+    bool running;
+    std::array<size_t, LANES> maxDepth;
+
+    /** Take the next item a worker of lane nLane may run, or nullptr if there is none */
+    std::unique_ptr<WorkItem> Take(size_t nLane)
+    {
+        for (size_t n = nLane + 1; n-- > 0; ) {
+            if (!queues[n].empty()) {
+                std::unique_ptr<WorkItem> i = std::move(queues[n].front());
+                queues[n].pop_front();
+                return i;
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    explicit WorkQueue(const std::array<size_t, LANES>& _maxDepth) : running(true),
+                                 maxDepth(_maxDepth)
+    {
+    }
+    /** Precondition: worker threads have all stopped (they have been joined).
+     */
+    ~WorkQueue()
+    {
+    }
+    /** Take the next item a worker of lane may run without waiting, or nullptr if there is none */
+    std::unique_ptr<WorkItem> TryTake(HTTPWorkLane lane)
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        return Take((size_t)lane);
+    }
+    /** Enqueue a work item */
+    bool Enqueue(WorkItem* item, HTTPWorkLane lane)
+    {
+        const size_t nLane = (size_t)lane;
+        std::unique_lock<std::mutex> lock(cs);
+        if (queues[nLane].size() >= maxDepth[nLane]) {
+            return false;
+        }
+        queues[nLane].emplace_back(std::unique_ptr<WorkItem>(item));
+        // Not every worker may run this lane, wake them all and let the first one that can take it
+        cond.notify_all();
+        return true;
+    }
+    /** Thread function */
+    void Run(HTTPWorkLane lane)
+    {
+        const size_t nLane = (size_t)lane;
+        while (true) {
+            std::unique_ptr<WorkItem> i;
+            {
+                std::unique_lock<std::mutex> lock(cs);
+                while (running && !(i = Take(nLane)))
+                    cond.wait(lock);
+                if (!running)
+                    break;
+            }
+            (*i)();
+        }
+    }
+    /** Interrupt and exit loops */
+    void Interrupt()
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        running = false;
+        cond.notify_all();
+    }
+};
+
+
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Picks the work queue lane of a request. This runs on the event loop
+ * thread, so it must be quick and must not consume the request body.
+ */
+typedef std::function<HTTPWorkLane(HTTPRequest* req, const std::string &)> HTTPLaneClassifier;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
- * be invoked.
+ * be invoked. Requests go to the cheap lane unless a classifier is given.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler,
+                         const HTTPLaneClassifier &classifier = nullptr);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
@@ -98,6 +221,12 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * Return up to the first nMaxSize bytes of the request body without
+     * consuming it.
+     */
+    std::string PeekBody(size_t nMaxSize);
+
     /**
      * Write output header.
      *
@@ -105,6 +234,17 @@ public:
      */
     void WriteHeader(const std::string& hdr, const std::string& value);
 
+    /**
+     * Append to the reply body without sending it yet, for replies that are
+     * written in parts. WriteReply appends its strReply and sends it all.
+     */
+    void WriteReplyPart(const std::string& strPart);
+
+    /**
+     * Drop everything WriteReplyPart appended so far, to send another reply.
+     */
+    void DiscardReplyParts();
+
     /**
      * Write HTTP reply.
      * nStatus is the HTTP status code to send.
@@ -538,13 +538,22 @@ void SetupServerArgs()
     gArgs.AddArg("-zmqpubhashtx=<address>", "Enable publish hash transaction in <address>", false, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubrawblock=<address>", "Enable publish raw block in <address>", false, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubrawtx=<address>", "Enable publish raw transaction in <address>", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubanonoutput=<address>", "Enable publish RingCT outputs of connected and disconnected blocks in <address>", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubkeyimage=<address>", "Enable publish key images of connected and disconnected blocks in <address>", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubzerocoinmint=<address>", "Enable publish zerocoin mints of connected and disconnected blocks in <address>", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubzerocoinspend=<address>", "Enable publish zerocoin spends of connected and disconnected blocks in <address>", false, OptionsCategory::ZMQ);
 #else
     hidden_args.emplace_back("-zmqpubhashblock=<address>");
     hidden_args.emplace_back("-zmqpubhashtx=<address>");
     hidden_args.emplace_back("-zmqpubrawblock=<address>");
     hidden_args.emplace_back("-zmqpubrawtx=<address>");
+    hidden_args.emplace_back("-zmqpubanonoutput=<address>");
+    hidden_args.emplace_back("-zmqpubkeyimage=<address>");
+    hidden_args.emplace_back("-zmqpubzerocoinmint=<address>");
+    hidden_args.emplace_back("-zmqpubzerocoinspend=<address>");
 #endif
 
+    gArgs.AddArg("-benchpow", "Measure and log the hashrate of each proof-of-work algorithm on one and on all cores at startup (default: 0)", true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-checkblocks=<n>", strprintf("How many blocks to check at startup (default: %u, 0 = all)", DEFAULT_CHECKBLOCKS), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-checklevel=<n>", strprintf("How thorough the block verification of -checkblocks is (0-4, default: %u)", DEFAULT_CHECKLEVEL), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-checkblockindex", strprintf("Do a full consistency check for mapBlockIndex, setBlockIndexCandidates, chainActive and mapBlocksUnlinked occasionally. (default: %u)", defaultChainParams->DefaultConsistencyChecks()), true, OptionsCategory::DEBUG_TEST);
@@ -568,6 +577,7 @@ void SetupServerArgs()
     gArgs.AddArg("-logtimestamps", strprintf("Prepend debug output with timestamp (default: %u)", DEFAULT_LOGTIMESTAMPS), false, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)", DEFAULT_LOGTIMEMICROS), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-mocktime=<n>", "Replace actual time with <n> seconds since epoch (default: 0)", true, OptionsCategory::DEBUG_TEST);
+    gArgs.AddArg("-profilelocks", "Record the wait and hold times of every lock site, reported by getperfstats. Waits of 10ms or more are logged with -debug=bench (default: 0)", true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-maxsigcachesize=<n>", strprintf("Limit sum of signature cache and script execution cache sizes to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-maxtxfee=<amt>", strprintf("Maximum total fees (in %s) to use in a single wallet transaction or raw transaction; setting this too low may abort large transactions (default: %s)",
@@ -600,13 +610,16 @@ void SetupServerArgs()
     gArgs.AddArg("-rpcauth=<userpw>", "Username and hashed password for JSON-RPC connections. The field <userpw> comes in the format: <USERNAME>:<SALT>$<HASH>. A canonical python script is included in share/rpcauth. The client then connects normally using the rpcuser=<USERNAME>/rpcpassword=<PASSWORD> pair of arguments. This option can be specified multiple times", false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcbind=<addr>[:port]", "Bind to given address to listen for JSON-RPC connections. This option is ignored unless -rpcallowip is also passed. Port is optional and overrides -rpcport. Use [host]:port notation for IPv6. This option can be specified multiple times (default: 127.0.0.1 and ::1 i.e., localhost, or if -rpcallowip has been specified, 0.0.0.0 and :: i.e., all addresses)", false, OptionsCategory::RPC);
     gArgs.AddArg("-rpccookiefile=<loc>", "Location of the auth cookie. Relative paths will be prefixed by a net-specific datadir location. (default: data dir)", false, OptionsCategory::RPC);
+    gArgs.AddArg("-rpclane=<method>:<lane>", "Queue calls to an RPC method on the cheap, wallet or heavy lane of the work queue. Wallet and zerocoin methods default to the wallet lane, rescans, imports and UTXO set scans to the heavy lane and everything else to the cheap lane. Can be specified multiple times", true, OptionsCategory::RPC);
+    gArgs.AddArg("-rpclanedepth=<lane>:<n>", "Set the depth of a single lane of the work queue to service RPC calls (default: -rpcworkqueue). Can be specified multiple times", true, OptionsCategory::RPC);
+    gArgs.AddArg("-rpclanethreads=<lane>:<n>", strprintf("Set the number of threads to service RPC calls of a single lane of the work queue (default: %d for the cheap and heavy lanes, the rest of -rpcthreads for the wallet lane). Idle threads also service the lanes lighter than their own. Can be specified multiple times", DEFAULT_HTTP_LANE_THREADS), true, OptionsCategory::RPC);
     gArgs.AddArg("-rpcpassword=<pw>", "Password for JSON-RPC connections", false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcport=<port>", strprintf("Listen for JSON-RPC connections on <port> (default: %u, testnet: %u or devnet: %u)", defaultBaseParams->RPCPort(), testnetBaseParams->RPCPort(), devnetBaseParams->RPCPort()), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcserialversion", strprintf("Sets the serialization of raw transaction or block hex returned in non-verbose mode, non-segwit(0) or segwit(1) (default: %d)", DEFAULT_RPC_SERIALIZE_VERSION), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcservertimeout=<n>", strprintf("Timeout during HTTP requests (default: %d)", DEFAULT_HTTP_SERVER_TIMEOUT), true, OptionsCategory::RPC);
-    gArgs.AddArg("-rpcthreads=<n>", strprintf("Set the number of threads to service RPC calls (default: %d)", DEFAULT_HTTP_THREADS), false, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcthreads=<n>", strprintf("Set the number of threads to service RPC calls, shared out over the lanes of the work queue (default: %d)", DEFAULT_HTTP_THREADS), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcuser=<user>", "Username for JSON-RPC connections", false, OptionsCategory::RPC);
-    gArgs.AddArg("-rpcworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE), true, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcworkqueue=<n>", strprintf("Set the depth of each lane of the work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE), true, OptionsCategory::RPC);
     gArgs.AddArg("-server", "Accept command line and JSON-RPC commands", false, OptionsCategory::RPC);
     gArgs.AddArg("-watchonly", "Only run this if you are running a watchonly server", false, OptionsCategory::RPC);
     gArgs.AddArg("-lightwallet", "Normal blockchain syncing doesn't occur", false, OptionsCategory::RPC);
@@ -1120,6 +1133,7 @@ bool AppInitParameterInteraction()
     }
     fCheckBlockIndex = gArgs.GetBoolArg("-checkblockindex", chainparams.DefaultConsistencyChecks());
     fCheckpointsEnabled = gArgs.GetBoolArg("-checkpoints", DEFAULT_CHECKPOINTS_ENABLED);
+    g_lock_profiling = gArgs.GetBoolArg("-profilelocks", false);
 
     hashAssumeValid = uint256S(gArgs.GetArg("-assumevalid", chainparams.GetConsensus().defaultAssumeValid.GetHex()));
     if (!hashAssumeValid.IsNull())
@@ -1382,6 +1396,11 @@ bool AppInitMain()
     InitSignatureCache();
     InitScriptExecutionCache();
 
+    if (gArgs.GetBoolArg("-benchpow", false)) {
+        uiInterface.InitMessage(_("Measuring proof-of-work hashrate..."));
+        BenchmarkPoWHashrate();
+    }
+
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
         for (int i=0; i<nScriptCheckThreads-1; i++)
@@ -1662,6 +1681,11 @@ bool AppInitMain()
                     break;
                 }
 
+                if (!pblocktree->LoadRCTKeyImageFilter()) {
+                    strLoadError = _("Error loading key image filter");
+                    break;
+                }
+
                 {
                     LOCK(cs_mapblockindex);
                     // If the loaded chain has a wrong genesis, bail out immediately
@@ -1710,6 +1734,22 @@ bool AppInitMain()
                 pcoinsTip.reset(new CCoinsViewCache(pcoinscatcher.get()));
 
                 bool is_coinsview_empty = fReset || fReindexChainState || pcoinsTip->GetBestBlock().IsNull();
+
+                // The RingCT index is flushed before the chainstate, so it may be ahead of it after a crash, which
+                // ConnectBlock repairs, but never behind or on another branch. Older versions wrote it block by
+                // block and left no best block.
+                uint256 hashRCTBestBlock = pblocktree->ReadRCTBestBlock();
+                if (!is_coinsview_empty && !hashRCTBestBlock.IsNull() && hashRCTBestBlock != pcoinsTip->GetBestBlock()) {
+                    LogPrintf("RingCT index was last flushed at block %s, chainstate at %s\n", hashRCTBestBlock.GetHex(),
+                              pcoinsTip->GetBestBlock().GetHex());
+                    const CBlockIndex* pindexRCT = LookupBlockIndex(hashRCTBestBlock);
+                    const CBlockIndex* pindexCoins = LookupBlockIndex(pcoinsTip->GetBestBlock());
+                    if (!pindexRCT || !pindexCoins || pindexRCT->GetAncestor(pindexCoins->nHeight) != pindexCoins) {
+                        strLoadError = _("The RingCT index is behind the chainstate or on another branch. You will need to rebuild the database using -reindex-chainstate.");
+                        break;
+                    }
+                }
+
                 if (!is_coinsview_empty) {
                     // LoadChainTip sets chainActive based on pcoinsTip's best block
                     if (!LoadChainTip(chainparams)) {
@@ -14,6 +14,8 @@
 #include <consensus/tx_verify.h>
 #include <consensus/merkle.h>
 #include <consensus/validation.h>
+#include <crypto/common.h>
+#include <crypto/sha256.h>
 #include <hash.h>
 #include <net.h>
 #include <policy/feerate.h>
@@ -21,6 +23,7 @@
 #include <pow.h>
 #include <primitives/transaction.h>
 #include <script/standard.h>
+#include <streams.h>
 #include <timedata.h>
 #include <util/system.h>
 #include <util/moneystr.h>
@@ -826,6 +829,49 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
     }
 }
 
+BlockTemplateTracker::BlockTemplateTracker(CTxMemPool& pool)
+{
+    m_connNotifyEntryAdded = pool.NotifyEntryAdded.connect(std::bind(&BlockTemplateTracker::NotifyEntryAdded, this, std::placeholders::_1));
+    m_connNotifyEntryRemoved = pool.NotifyEntryRemoved.connect(std::bind(&BlockTemplateTracker::NotifyEntryRemoved, this, std::placeholders::_1, std::placeholders::_2));
+}
+
+void BlockTemplateTracker::NotifyEntryAdded(CTransactionRef tx)
+{
+    LOCK(cs);
+    nAdded++;
+}
+
+void BlockTemplateTracker::NotifyEntryRemoved(CTransactionRef tx, MemPoolRemovalReason reason)
+{
+    LOCK(cs);
+    if (!fInvalid && setTemplateTxes.count(tx->GetHash()))
+        fInvalid = true;
+}
+
+void BlockTemplateTracker::Reset(const CBlock& block)
+{
+    LOCK(cs);
+    setTemplateTxes.clear();
+    for (const auto& tx : block.vtx) {
+        if (tx)
+            setTemplateTxes.emplace(tx->GetHash());
+    }
+    fInvalid = false;
+    nAdded = 0;
+}
+
+bool BlockTemplateTracker::IsInvalid() const
+{
+    LOCK(cs);
+    return fInvalid;
+}
+
+unsigned int BlockTemplateTracker::GetAdded() const
+{
+    LOCK(cs);
+    return nAdded;
+}
+
 void IncrementExtraNonce(CBlock* pblock, unsigned int nHeight, unsigned int& nExtraNonce)
 {
     // Update nExtraNonce
@@ -901,6 +947,60 @@ double GetRecentHashSpeed() {
     return nTotalHashSpeed;
 }
 
+/** Number of headers hashed per SHA256D80 call when searching SHA256D nonces, a multiple of the widest kernel */
+static const int SHA256D_SEARCH_BATCH = 32;
+
+/**
+ * Try nCount nonces of a SHA256D block starting at its nNonce64. Only the nonce changes between attempts, so the
+ * SHA-256 state after the first 64 bytes of the header is computed once and the headers are hashed a batch at a
+ * time by the widest SHA256D80 kernel the CPU has. Hashes whose most significant word is above the target's are
+ * rejected without building a uint256. On success nNonce64 holds the winning nonce and nTries the number of nonces
+ * that failed before it, otherwise nNonce64 is moved past the nonces tried.
+ */
+static bool SearchSha256DNonces(CBlock* pblock, const uint256& hashDataInput, int nCount, int& nTries)
+{
+    CDataStream ss(SER_GETHASH, PROTOCOL_VERSION);
+    ss << CSha256dInput(*pblock, hashDataInput);
+    assert(ss.size() == 80);
+    const unsigned char* pheader = (const unsigned char*)ss.data();
+
+    uint32_t midstate[8];
+    SHA256D80Midstate(midstate, pheader);
+
+    // The hash compares as a little endian number, its top word is the last 4 bytes
+    arith_uint256 bnTarget;
+    bnTarget.SetCompact(pblock->nBits);
+    const uint32_t nTargetTop = (bnTarget >> 224).GetLow64();
+
+    unsigned char tails[16 * SHA256D_SEARCH_BATCH];
+    unsigned char hashes[32 * SHA256D_SEARCH_BATCH];
+    for (int i = 0; i < SHA256D_SEARCH_BATCH; i++)
+        memcpy(tails + 16 * i, pheader + 64, 8); // end of the merkle root and nTime
+
+    nTries = 0;
+    while (nTries < nCount) {
+        const int nBatch = std::min(SHA256D_SEARCH_BATCH, nCount - nTries);
+        for (int i = 0; i < nBatch; i++)
+            WriteLE64(tails + 16 * i + 8, pblock->nNonce64 + i);
+        SHA256D80(hashes, midstate, tails, nBatch);
+
+        for (int i = 0; i < nBatch; i++) {
+            if (ReadLE32(hashes + 32 * i + 28) > nTargetTop)
+                continue;
+            uint256 hash;
+            memcpy(hash.begin(), hashes + 32 * i, 32);
+            if (CheckProofOfWork(hash, pblock->nBits, Params().GetConsensus(), CBlockHeader::SHA256D_BLOCK)) {
+                pblock->nNonce64 += i;
+                nTries += i;
+                return true;
+            }
+        }
+        pblock->nNonce64 += nBatch;
+        nTries += nBatch;
+    }
+    return false;
+}
+
 void BitcoinMiner(std::shared_ptr<CReserveScript> coinbaseScript, bool fProofOfStake = false, bool fProofOfFullNode = false, ThreadHashSpeed* pThreadHashSpeed = nullptr) {
     LogPrintf("Veil Miner started\n");
 
@@ -1049,14 +1149,8 @@ void BitcoinMiner(std::shared_ptr<CReserveScript> coinbaseScript, bool fProofOfS
                 // Exit loop when nMidLoopCount loops are done, or when a new block is found.
                 // Either way, success will be false.
                 while (nMidTries < nMidLoopCount && chainActive.Height() < pblock->nHeight) {
-                    while (nTries < nInnerLoopCount &&
-                           !CheckProofOfWork(pblock->GetSha256D(midStateHash), pblock->nBits,
-                                             Params().GetConsensus(), CBlockHeader::SHA256D_BLOCK)) {
-                        boost::this_thread::interruption_point();
-                        ++nTries;
-                        ++pblock->nNonce64;
-                    }
-                    if (nTries != nInnerLoopCount) {
+                    boost::this_thread::interruption_point();
+                    if (SearchSha256DNonces(pblock, midStateHash, nInnerLoopCount, nTries)) {
                         success = true;
                         break;
                     }
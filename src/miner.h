@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <memory>
+#include <unordered_set>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 
@@ -244,6 +245,37 @@ private:
     int UpdatePackagesForAdded(const CTxMemPool::setEntries& alreadyAdded, indexed_modified_transaction_set &mapModifiedTx) EXCLUSIVE_LOCKS_REQUIRED(mempool.cs);
 };
 
+/**
+ * Watches the mempool on behalf of a cached block template. A transaction in the template leaving the
+ * mempool (conflicted, replaced, expired or evicted) makes the template invalid, while new transactions
+ * only make it stale, so getblocktemplate can keep serving its template until it has to or wants to
+ * rebuild it, and mempool churn that does not touch the template costs nothing.
+ */
+class BlockTemplateTracker
+{
+private:
+    mutable CCriticalSection cs;
+    std::unordered_set<uint256, SaltedTxidHasher> setTemplateTxes GUARDED_BY(cs);
+    bool fInvalid GUARDED_BY(cs) = true;
+    unsigned int nAdded GUARDED_BY(cs) = 0;
+
+    boost::signals2::scoped_connection m_connNotifyEntryAdded;
+    boost::signals2::scoped_connection m_connNotifyEntryRemoved;
+
+    void NotifyEntryAdded(CTransactionRef tx);
+    void NotifyEntryRemoved(CTransactionRef tx, MemPoolRemovalReason reason);
+
+public:
+    explicit BlockTemplateTracker(CTxMemPool& pool);
+
+    /** Start tracking a newly built template */
+    void Reset(const CBlock& block);
+    /** Nothing has been tracked yet, or a transaction in the template left the mempool */
+    bool IsInvalid() const;
+    /** Number of transactions that entered the mempool since the template was built */
+    unsigned int GetAdded() const;
+};
+
 bool GenerateActive();
 void setGenerate(bool fGenerate);
 
@@ -2045,8 +2045,15 @@ void CConnman::ThreadMessageHandler()
                     continue;
                 vDandelionNodes.push_back(pnode);
             }
-            LOCK(veil::dandelion.cs);
-            veil::dandelion.Process(vDandelionNodes);
+            std::vector<uint256> vFluff;
+            veil::dandelion.Process(vDandelionNodes, vFluff);
+
+            //Stem phase is over, broadcast to everyone
+            for (const uint256& hash : vFluff) {
+                CInv inv(MSG_TX, hash);
+                for (CNode* pnode : vNodesCopy)
+                    pnode->PushInventory(inv);
+            }
         }
 
         bool fMoreWork = false;
@@ -2057,7 +2064,6 @@ void CConnman::ThreadMessageHandler()
                 continue;
 
             // Receive messages
-            //LOCK(veil::dandelion.cs);
             bool fMoreNodeWork = m_msgproc->ProcessMessages(pnode, flagInterruptMsgProc);
             fMoreWork |= (fMoreNodeWork && !pnode->fPauseSend);
             if (flagInterruptMsgProc)
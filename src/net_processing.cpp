@@ -1331,7 +1331,6 @@ void static ProcessGetData(CNode* pfrom, const CChainParams& chainparams, CConnm
                     LogPrintf("%s: Sending dandelion inventory in stem phase to peer %d\n", __func__, pfrom->GetId());
                     int64_t nTimeStemEnd = veil::dandelion.GetTimeStemPhaseEnd(inv.hash);
                     connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::TX_DAND, *mi->second, nTimeStemEnd));
-                    veil::dandelion.MarkSent(inv.hash);
                 } else {
                     // Normal transaction transmission
                     connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::TX, *mi->second));
@@ -2575,17 +2574,14 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
 
         // Veil: check for dandelion
         int64_t nTimeStemPhase = 0;
-        {
-            LOCK(veil::dandelion.cs);
-            if (strCommand == NetMsgType::TX_DAND && !fEnableDandelion) {
-                connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::REJECT, strCommand, REJECT_DANDELION, std::string(
-                        "Received tx_dand after opting out of dandelion")));
-                LOCK(cs_main);
-                Misbehaving(pfrom->GetId(), 1);
-                return false;
-            } else if (strCommand == NetMsgType::TX_DAND)
-                vRecv >> nTimeStemPhase;
-        }
+        if (strCommand == NetMsgType::TX_DAND && !fEnableDandelion) {
+            connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::REJECT, strCommand, REJECT_DANDELION, std::string(
+                    "Received tx_dand after opting out of dandelion")));
+            LOCK(cs_main);
+            Misbehaving(pfrom->GetId(), 1);
+            return false;
+        } else if (strCommand == NetMsgType::TX_DAND)
+            vRecv >> nTimeStemPhase;
 
         CInv inv(MSG_TX, tx.GetHash(), nTimeStemPhase);
         pfrom->AddInventoryKnown(inv);
@@ -2603,9 +2599,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         if (!tx.IsZerocoinSpend() && !AlreadyHave(inv) &&
             AcceptToMemoryPool(mempool, state, ptx, &fMissingInputs, &lRemovedTxn, false /* bypass_limits */, 0 /* nAbsurdFee */)) {
             mempool.check(pcoinsTip.get());
-            if (inv.IsDandelion()) {
+            if (inv.IsDandelion() && veil::dandelion.Add(inv.hash, inv.nTimeStemPhaseEnd, pfrom->GetId())) {
                 LogPrintf("Received dandelion transaction %s, delaying full rebroadcast until %d\n", inv.hash.GetHex(), inv.nTimeStemPhaseEnd);
-                veil::dandelion.Add(inv.hash, inv.nTimeStemPhaseEnd, pfrom->GetId());
             } else {
                 RelayTransaction(tx, connman);
             }
@@ -4027,18 +4022,9 @@ bool PeerLogicValidation::SendMessages(CNode* pto)
                 std::vector<std::set<uint256>::iterator> vInvTx;
                 vInvTx.reserve(pto->setInventoryTxToSend.size());
                 for (std::set<uint256>::iterator it = pto->setInventoryTxToSend.begin(); it != pto->setInventoryTxToSend.end(); it++) {
-                    //Veil: don't send any dandelion inventory unless marked for sending
-                    if (veil::dandelion.IsInStemPhase(*it)) {
-                        if (!veil::dandelion.IsQueuedToSend(*it))
-                            continue;
-
-                        //Don't send to the same node that sent the tx here
-                        if (veil::dandelion.IsFromNode(*it, pto->GetId()))
-                            continue;
-
-                        if(!veil::dandelion.IsCorrectNodeToSend(*it, pto->GetId()))
-                            continue;
-                    }
+                    //Veil: inventory in the stem phase is only sent from the peer's stem queue
+                    if (veil::dandelion.IsInStemPhase(*it))
+                        continue;
 
                     vInvTx.push_back(it);
                 }
@@ -4078,21 +4064,8 @@ bool PeerLogicValidation::SendMessages(CNode* pto)
                     }
                     if (pto->pfilter && !pto->pfilter->IsRelevantAndUpdate(*txinfo.tx)) continue;
 
-                    //Veil: dandelion broadcast
-                    int64_t nTimeStemPhaseEnd = 0;
-                    if (veil::dandelion.IsInStemPhase(hash)) {
-                        //Don't send stem phase to more than one peer
-                        if (veil::dandelion.IsSent(hash))
-                            continue;
-
-                        nTimeStemPhaseEnd = veil::dandelion.GetTimeStemPhaseEnd(hash);
-
-                        //Record that this is the node that inventory was sent to
-                        veil::dandelion.SetInventorySent(hash, pto->GetId());
-                    }
-
                     // Send
-                    vInv.emplace_back(CInv(MSG_TX, hash, nTimeStemPhaseEnd));
+                    vInv.push_back(CInv(MSG_TX, hash));
                     nRelayedTransactions++;
                     {
                         // Expire old relay messages
@@ -4114,6 +4087,28 @@ bool PeerLogicValidation::SendMessages(CNode* pto)
                     pto->filterInventoryKnown.insert(hash);
                 }
             }
+
+            //Veil: dandelion stem inventory that was routed to this peer
+            if (fSendTrickle && fEnableDandelion) {
+                std::vector<uint256> vStemInv;
+                veil::dandelion.GetStemInventoryToSend(pto->GetId(), vStemInv);
+                for (const uint256& hash : vStemInv) {
+                    auto txinfo = mempool.info(hash);
+                    if (!txinfo.tx)
+                        continue;
+
+                    vInv.emplace_back(CInv(MSG_TX, hash, veil::dandelion.GetTimeStemPhaseEnd(hash)));
+                    auto ret = mapRelay.insert(std::make_pair(hash, std::move(txinfo.tx)));
+                    if (ret.second) {
+                        vRelayExpiration.push_back(std::make_pair(nNow + 15 * 60 * 1000000, ret.first));
+                    }
+                    if (vInv.size() == MAX_INV_SZ) {
+                        connman->PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
+                        vInv.clear();
+                    }
+                    pto->filterInventoryKnown.insert(hash);
+                }
+            }
         }
         if (!vInv.empty())
             connman->PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
@@ -226,6 +226,22 @@ unsigned int DarkGravityWave(const CBlockIndex* pindexLast, const Consensus::Par
     unsigned int nCountBlocks = 0;
     int64_t nPastBlocks = Params().GetDwgPastBlocks(pindexLast, nPoWType, fProofOfStake);
     bool fNewPoW = true;
+
+    // Skipped blocks are stepped over with the per-algorithm links when the walk is for a
+    // single class, they lead straight to the next block that is counted or ends the walk
+    int nAlgoLink = -1;
+    if (fProofOfStake && !nPoWType)
+        nAlgoLink = CBlockIndex::ALGO_LINK_POS;
+    else if (!fProofOfStake && nPoWType == CBlockHeader::PROGPOW_BLOCK)
+        nAlgoLink = CBlockIndex::ALGO_LINK_PROGPOW;
+    else if (!fProofOfStake && nPoWType == CBlockHeader::RANDOMX_BLOCK)
+        nAlgoLink = CBlockIndex::ALGO_LINK_RANDOMX;
+    else if (!fProofOfStake && nPoWType == CBlockHeader::SHA256D_BLOCK)
+        nAlgoLink = CBlockIndex::ALGO_LINK_SHA256D;
+    auto SkipBlock = [nAlgoLink](const CBlockIndex* p) {
+        return nAlgoLink >= 0 && p->fHaveAlgoLinks ? p->pprevAlgo[nAlgoLink] : p->pprev;
+    };
+
     while (nCountBlocks < nPastBlocks) {
         // Ran out of blocks, return pow limit
         if (!pindex)
@@ -244,19 +260,19 @@ unsigned int DarkGravityWave(const CBlockIndex* pindexLast, const Consensus::Par
 
         // Only consider PoW or PoS blocks but not both
         if (pindex->IsProofOfStake() != fProofOfStake) {
-            pindex = pindex->pprev;
+            pindex = SkipBlock(pindex);
             continue;
         } else if ((nPoWType & CBlockHeader::PROGPOW_BLOCK) && !pindex->IsProgProofOfWork()) {
-            pindex = pindex->pprev;
+            pindex = SkipBlock(pindex);
             continue;
         } else if ((nPoWType & CBlockHeader::RANDOMX_BLOCK) && !pindex->IsRandomXProofOfWork()) {
-            pindex = pindex->pprev;
+            pindex = SkipBlock(pindex);
             continue;
         } else if ((nPoWType & CBlockHeader::SHA256D_BLOCK) && !pindex->IsSha256DProofOfWork()) {
-            pindex = pindex->pprev;
+            pindex = SkipBlock(pindex);
             continue;
         } else if (pindex->IsX16RTProofOfWork() && !fProofOfStake && nPoWType != 0) {
-            pindex = pindex->pprev;
+            pindex = SkipBlock(pindex);
             continue;
         } else if (!pindexLastMatchingProof) {
             // save the tip block for the proof
@@ -410,17 +426,22 @@ bool CheckProofOfWork(uint256 hash, unsigned int nBits, const Consensus::Params&
 #define KEY_CHANGE 2048
 #define SWITCH_KEY 64
 
-uint256 GetKeyBlock(const uint32_t& nHeight)
+int GetKeyBlockHeight(const uint32_t& nHeight)
 {
-    static uint256 current_key_block = uint256();
-
     uint32_t checkMultiplier = 0;
 
     // We don't want to go negative
     if (nHeight >= SWITCH_KEY)
         checkMultiplier = (nHeight - SWITCH_KEY) / KEY_CHANGE;
 
-    int checkHeight = checkMultiplier * KEY_CHANGE;
+    return checkMultiplier * KEY_CHANGE;
+}
+
+uint256 GetKeyBlock(const uint32_t& nHeight)
+{
+    static uint256 current_key_block = uint256();
+
+    int checkHeight = GetKeyBlockHeight(nHeight);
 
     if (chainActive.Height() >= checkHeight) {
 	    current_key_block = chainActive[checkHeight]->GetBlockHash();
@@ -598,3 +619,86 @@ void DeallocateCache()
     myMiningCache = nullptr;
 }
 
+
+/** Hash headers of the given PoW type on nThreads threads for nMilliseconds, returns the total hashes per second */
+static double MeasurePoWHashrate(int nPoWType, int nThreads, int64_t nMilliseconds, randomx_cache* cache)
+{
+    std::atomic<bool> fStop(false);
+    std::vector<uint64_t> vHashes(nThreads, 0);
+    std::vector<std::thread> vThreads;
+
+    int64_t nTimeStart = GetTimeMillis();
+    for (int i = 0; i < nThreads; i++) {
+        vThreads.emplace_back([i, nPoWType, cache, &fStop, &vHashes] {
+            CBlockHeader header;
+            header.SetNull();
+            header.nVersion = nPoWType;
+            header.nTime = GetTime();
+            header.nNonce = i * 100000;
+            header.nNonce64 = header.nNonce;
+
+            randomx_vm* vm = nullptr;
+            if (nPoWType == CBlockHeader::RANDOMX_BLOCK)
+                vm = randomx_create_vm(randomx_get_flags(), cache, nullptr);
+
+            char hash[RANDOMX_HASH_SIZE];
+            uint256 mix_hash;
+            uint256 midState = header.GetSha256dMidstate();
+            while (!fStop) {
+                if (nPoWType == CBlockHeader::RANDOMX_BLOCK) {
+                    uint256 hash_blob = header.GetRandomXHeaderHash();
+                    randomx_calculate_hash(vm, &hash_blob, sizeof uint256(), hash);
+                } else if (nPoWType == CBlockHeader::PROGPOW_BLOCK) {
+                    ProgPowHash(header, mix_hash);
+                } else if (nPoWType == CBlockHeader::SHA256D_BLOCK) {
+                    header.GetSha256D(midState);
+                } else {
+                    header.GetX16RTPoWHash();
+                }
+                header.nNonce++;
+                header.nNonce64++;
+                vHashes[i]++;
+            }
+
+            if (vm)
+                randomx_destroy_vm(vm);
+        });
+    }
+
+    UninterruptibleSleep(std::chrono::milliseconds{nMilliseconds});
+    fStop = true;
+    for (auto& thread : vThreads)
+        thread.join();
+    int64_t nTimeElapsed = std::max(GetTimeMillis() - nTimeStart, (int64_t)1);
+
+    uint64_t nTotal = 0;
+    for (auto nHashes : vHashes)
+        nTotal += nHashes;
+
+    return nTotal * 1000.0 / nTimeElapsed;
+}
+
+void BenchmarkPoWHashrate(int64_t nMilliseconds)
+{
+    static const std::vector<int> vPoWTypes = {0, CBlockHeader::SHA256D_BLOCK, CBlockHeader::PROGPOW_BLOCK, CBlockHeader::RANDOMX_BLOCK};
+
+    // The validation (light) cache, keyed the same way a node without a chain would be
+    uint256 key_block = Params().GenesisBlock().GetHash();
+    randomx_cache* cache = randomx_alloc_cache(randomx_get_flags());
+    randomx_init_cache(cache, &key_block, sizeof uint256());
+
+    std::vector<int> vThreadCounts = {1};
+    if (GetNumCores() > 1)
+        vThreadCounts.emplace_back(GetNumCores());
+
+    LogPrintf("%s: Measuring proof-of-work hashrate for %dms per algorithm and thread count\n", __func__, nMilliseconds);
+    for (int nPoWType : vPoWTypes) {
+        for (int nThreads : vThreadCounts) {
+            double dHashrate = MeasurePoWHashrate(nPoWType, nThreads, nMilliseconds, cache);
+            LogPrintf("%s: %s %d thread(s): %.2f H/s (%.2f H/s per thread)\n", __func__,
+                      GetMiningType(nPoWType), nThreads, dHashrate, dHashrate / nThreads);
+        }
+    }
+
+    randomx_release_cache(cache);
+}
@@ -41,6 +41,8 @@ bool CheckIfMiningKeyShouldChange(const uint256& check_block);
 void CheckIfValidationKeyShouldChangeAndUpdate(const uint256& check_block);
 void DeallocateRandomXLightCache();
 uint256 GetCurrentKeyBlock();
+/** Height of the block whose hash keys the RandomX hashes of blocks at nHeight */
+int GetKeyBlockHeight(const uint32_t& nHeight);
 uint256 GetKeyBlock(const uint32_t& nHeight);
 randomx_vm* GetMyMachineValidating();
 
@@ -54,4 +56,10 @@ void DeallocateCache();
 void StartRandomXMining(void* pPowThreadGroup, const int nThreads, std::shared_ptr<CReserveScript> pCoinbaseScript);
 void CreateRandomXInitDataSet(int nThreads, randomx_dataset* dataset, randomx_cache* cache);
 
+/** Default time spent hashing per algorithm and thread count by -benchpow */
+static const int64_t DEFAULT_BENCHPOW_MILLISECONDS = 2000;
+
+/** Log the achievable hashrate of every PoW algorithm (RandomX in light mode) on one and on all cores */
+void BenchmarkPoWHashrate(int64_t nMilliseconds = DEFAULT_BENCHPOW_MILLISECONDS);
+
 #endif // BITCOIN_POW_H
@@ -16,6 +16,11 @@
 
 #include <secp256k1_rangeproof.h>
 
+#include <algorithm>
+#include <memory>
+#include <variant>
+#include <vector>
+
 static const int SERIALIZE_TRANSACTION_NO_WITNESS = 0x40000000;
 
 enum OutputTypes
@@ -358,10 +363,11 @@ public:
     virtual bool PutValue(std::vector<uint8_t> &vchAmount) const { return false; };
 
     virtual bool GetScriptPubKey(CScript &scriptPubKey_) const { return false; };
-    virtual const CScript *GetPScriptPubKey() const { return nullptr; };
 
-    virtual secp256k1_pedersen_commitment *GetPCommitment() { return nullptr; };
-    virtual std::vector<uint8_t> *GetPRangeproof() { return nullptr; };
+    // Dispatched on nVersion rather than virtual, these are called for every output during validation
+    inline const CScript *GetPScriptPubKey() const;
+    inline secp256k1_pedersen_commitment *GetPCommitment();
+    inline std::vector<uint8_t> *GetPRangeproof();
 
     virtual bool GetCTFee(CAmount &nFee) const { return false; };
     virtual bool SetCTFee(CAmount &nFee) { return false; };
@@ -427,11 +433,6 @@ public:
         return true;
     }
 
-    virtual const CScript *GetPScriptPubKey() const override
-    {
-        return &scriptPubKey;
-    }
-
     CTxOut ToTxOut() const { return CTxOut(nValue, scriptPubKey); }
 };
 
@@ -486,21 +487,6 @@ public:
     }
 
     bool SetScriptPubKey(const CScript& scriptPubKey) override;
-
-    virtual const CScript *GetPScriptPubKey() const override
-    {
-        return &scriptPubKey;
-    }
-
-    secp256k1_pedersen_commitment *GetPCommitment() override
-    {
-        return &commitment;
-    }
-
-    std::vector<uint8_t> *GetPRangeproof() override
-    {
-        return &vRangeproof;
-    }
 };
 
 class CTxOutRingCT : public CTxOutBase
@@ -547,16 +533,6 @@ public:
         return true;
     }
 
-    secp256k1_pedersen_commitment *GetPCommitment() override
-    {
-        return &commitment;
-    }
-
-    std::vector<uint8_t> *GetPRangeproof() override
-    {
-        return &vRangeproof;
-    }
-
     bool SetScriptPubKey(const CScript& scriptPubKey) override { return false; }
 };
 
@@ -648,6 +624,77 @@ public:
     bool SetScriptPubKey(const CScript& scriptPubKey) override { return false; }
 };
 
+const CScript *CTxOutBase::GetPScriptPubKey() const
+{
+    switch (nVersion) {
+        case OUTPUT_STANDARD:
+            return &((const CTxOutStandard*) this)->scriptPubKey;
+        case OUTPUT_CT:
+            return &((const CTxOutCT*) this)->scriptPubKey;
+        default:
+            return nullptr;
+    }
+}
+
+secp256k1_pedersen_commitment *CTxOutBase::GetPCommitment()
+{
+    switch (nVersion) {
+        case OUTPUT_CT:
+            return &((CTxOutCT*) this)->commitment;
+        case OUTPUT_RINGCT:
+            return &((CTxOutRingCT*) this)->commitment;
+        default:
+            return nullptr;
+    }
+}
+
+std::vector<uint8_t> *CTxOutBase::GetPRangeproof()
+{
+    switch (nVersion) {
+        case OUTPUT_CT:
+            return &((CTxOutCT*) this)->vRangeproof;
+        case OUTPUT_RINGCT:
+            return &((CTxOutRingCT*) this)->vRangeproof;
+        default:
+            return nullptr;
+    }
+}
+
+/**
+ * Storage for the outputs of a deserialized transaction.
+ *
+ * Outputs of every type are constructed in place in a few contiguous chunks instead of with a make_shared each, and
+ * the transaction's vpout holds aliasing pointers into it that all share the arena's one reference count. Holding on
+ * to any one output keeps the arena alive. Chunks are capped so a bogus output count cannot reserve a lot of memory.
+ */
+class CTxOutArena
+{
+public:
+    typedef std::variant<CTxOutStandard, CTxOutCT, CTxOutRingCT, CTxOutData> Slot;
+    static constexpr size_t MAX_CHUNK_OUTPUTS = 256;
+
+    explicit CTxOutArena(size_t nOutputs) : nRemaining(nOutputs) {}
+
+    //! Construct the next output, never more than the number of outputs the arena was created for
+    template<typename T>
+    T *Emplace()
+    {
+        if (nRemaining == 0)
+            throw std::runtime_error("CTxOutArena: too many outputs");
+        if (vChunks.empty() || vChunks.back().size() == vChunks.back().capacity()) {
+            vChunks.emplace_back();
+            vChunks.back().reserve(std::min(nRemaining, MAX_CHUNK_OUTPUTS));
+        }
+        nRemaining--;
+        return &std::get<T>(vChunks.back().emplace_back(std::in_place_type<T>));
+    }
+
+private:
+    // Never grown past their reserved capacity, so outputs do not move
+    std::vector<std::vector<Slot>> vChunks;
+    size_t nRemaining;
+};
+
 struct CMutableTransaction;
 
 /**
@@ -689,27 +736,29 @@ inline void UnserializeTransaction(TxType& tx, Stream& s) {
 
     size_t nOutputs = ReadCompactSize(s);
     tx.vpout.resize(nOutputs);
+    std::shared_ptr<CTxOutArena> arena = nOutputs > 0 ? std::make_shared<CTxOutArena>(nOutputs) : nullptr;
     for (size_t k = 0; k < tx.vpout.size(); ++k) {
         s >> bv;
+        CTxOutBase *pout;
         switch (bv) {
             case OUTPUT_STANDARD:
-                tx.vpout[k] = MAKE_OUTPUT<CTxOutStandard>();
+                pout = arena->Emplace<CTxOutStandard>();
                 break;
             case OUTPUT_CT:
-                tx.vpout[k] = MAKE_OUTPUT<CTxOutCT>();
+                pout = arena->Emplace<CTxOutCT>();
                 break;
             case OUTPUT_RINGCT:
-                tx.vpout[k] = MAKE_OUTPUT<CTxOutRingCT>();
+                pout = arena->Emplace<CTxOutRingCT>();
                 break;
             case OUTPUT_DATA:
-                tx.vpout[k] = MAKE_OUTPUT<CTxOutData>();
+                pout = arena->Emplace<CTxOutData>();
                 break;
             default:
                 throw std::runtime_error("UnserializeTransaction error: output type does not exist");
         }
 
-        tx.vpout[k]->nVersion = bv;
-        s >> *tx.vpout[k];
+        s >> *pout;
+        tx.vpout[k] = CTxOutBaseRef(arena, pout);
     }
 
     if (fUseSegwit) {
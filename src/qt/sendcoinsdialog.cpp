@@ -448,7 +448,6 @@ void SendCoinsDialog::PrepareTransactionFinished()
         coinControlUpdateLabels();
         uint256 hashCurrentTx = m_prepareData->tx->getWtx()->get().GetHash();
         if (fDandelion) {
-            LOCK(veil::dandelion.cs);
             veil::dandelion.Add(hashCurrentTx, GetAdjustedTime() + veil::dandelion.nDefaultStemTime, veil::dandelion.nDefaultNodeID);
         }
         Q_EMIT coinsSent(hashCurrentTx);
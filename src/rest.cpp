@@ -12,11 +12,15 @@
 #include <validation.h>
 #include <httpserver.h>
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <streams.h>
 #include <sync.h>
+#include <txdb.h>
 #include <txmempool.h>
 #include <util/strencodings.h>
+#include <veil/ringct/rctindex.h>
+#include <veil/zerocoin/accumulators.h>
 #include <version.h>
 
 #include <boost/algorithm/string.hpp>
@@ -24,6 +28,8 @@
 #include <univalue.h>
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
+static const int64_t MAX_REST_ANON_OUTPUTS = 1000;
+static const size_t MAX_REST_KEY_IMAGES = 1000;
 
 enum class RetFormat {
     UNDEF,
@@ -61,6 +67,25 @@ struct CCoin {
     }
 };
 
+struct CAccumulatorCheckpointValue {
+    int64_t nDenomination;
+    uint256 hashChecksum;
+    CBigNum bnValue;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(nDenomination);
+        READWRITE(hashChecksum);
+        std::vector<unsigned char> vchValue = bnValue.getvch();
+        READWRITE(vchValue);
+        if (ser_action.ForRead())
+            bnValue.setvch(vchValue);
+    }
+};
+
 static bool RESTERR(HTTPRequest* req, enum HTTPStatusCode status, std::string message)
 {
     req->WriteHeader("Content-Type", "text/plain");
@@ -239,10 +264,11 @@ static bool rest_block(HTTPRequest* req,
     }
 
     case RetFormat::JSON: {
-        UniValue objBlock = blockToJSON(block, tip, pblockindex, showTxDetails);
-        std::string strJSON = objBlock.write() + "\n";
+        JSONStreamWriter writer([req](const std::string& strPart) { req->WriteReplyPart(strPart); });
+        blockToJSONStream(writer, block, tip, pblockindex, showTxDetails);
+        writer.Flush();
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        req->WriteReply(HTTP_OK, "\n");
         return true;
     }
 
@@ -569,6 +595,301 @@ static bool rest_getutxos(HTTPRequest* req, const std::string& strURIPart)
     }
 }
 
+static bool rest_anonoutputs(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() != 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "No output range specified. Use /rest/anonoutputs/<start>/<count>.<ext>.");
+
+    int64_t nStart, nCount;
+    if (!ParseInt64(path[0], &nStart) || nStart < 1)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid start index: " + path[0]);
+    if (!ParseInt64(path[1], &nCount) || nCount < 1 || nCount > MAX_REST_ANON_OUTPUTS)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Output count out of range: " + path[1]);
+
+    std::vector<CLightWalletAnonOutputData> vOutputs;
+    {
+        LOCK(cs_main);
+        // Outputs past the tip's last index don't exist yet, the range is cut short there.
+        // A start past the tip leaves the range empty, without computing nStart + nCount
+        // which can overflow.
+        const int64_t nLast = chainActive.Tip()->nAnonOutputs;
+        const int64_t nEnd = nStart > nLast ? nLast : nStart + std::min(nCount, nLast - nStart + 1) - 1;
+        for (int64_t i = nStart; i <= nEnd; i++) {
+            CLightWalletAnonOutputData data;
+            data.index = i;
+            if (!pblocktree->ReadRCTOutput(i, data.output))
+                return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, strprintf("Anon output %d not found", i));
+            vOutputs.emplace_back(data);
+        }
+    }
+
+    CDataStream ssOutputs(SER_NETWORK, PROTOCOL_VERSION);
+    ssOutputs << vOutputs;
+
+    switch (rf) {
+    case RetFormat::BINARY: {
+        std::string binaryOutputs = ssOutputs.str();
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, binaryOutputs);
+        return true;
+    }
+
+    case RetFormat::HEX: {
+        std::string strHex = HexStr(ssOutputs) + "\n";
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, strHex);
+        return true;
+    }
+
+    case RetFormat::JSON: {
+        UniValue jsonOutputs(UniValue::VARR);
+        for (const CLightWalletAnonOutputData& data : vOutputs) {
+            UniValue output(UniValue::VOBJ);
+            output.pushKV("index", data.index);
+            output.pushKV("pubkey", HexStr(data.output.pubkey.begin(), data.output.pubkey.end()));
+            output.pushKV("commitment", HexStr(&data.output.commitment.data[0], &data.output.commitment.data[0] + 33));
+            output.pushKV("txid", data.output.outpoint.hash.GetHex());
+            output.pushKV("n", (int)data.output.outpoint.n);
+            output.pushKV("height", data.output.nBlockHeight);
+            output.pushKV("compromised", (int)data.output.nCompromised);
+            jsonOutputs.push_back(output);
+        }
+        std::string strJSON = jsonOutputs.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool rest_keyimages(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    std::vector<std::string> uriParts;
+    if (param.length() > 1)
+    {
+        std::string strUriParams = param.substr(1);
+        boost::split(uriParts, strUriParams, boost::is_any_of("/"));
+    }
+
+    std::string strRequestMutable = req->ReadBody();
+    if (strRequestMutable.length() == 0 && uriParts.size() == 0)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Error: empty request");
+
+    bool fInputParsed = false;
+    bool fCheckMemPool = false;
+    std::vector<CCmpPubKey> vKeyImages;
+
+    // Same scheme as getutxos: /rest/keyimages/checkmempool/<keyimage>/<keyimage>/... or a posted body
+    // of the same format as the output
+    if (uriParts.size() > 0)
+    {
+        if (uriParts[0] == "checkmempool") fCheckMemPool = true;
+
+        for (size_t i = (fCheckMemPool) ? 1 : 0; i < uriParts.size(); i++)
+        {
+            if (!IsHex(uriParts[i]) || uriParts[i].size() != 66)
+                return RESTERR(req, HTTP_BAD_REQUEST, "Parse error");
+            vKeyImages.emplace_back(ParseHex(uriParts[i]));
+        }
+
+        if (vKeyImages.size() > 0)
+            fInputParsed = true;
+        else
+            return RESTERR(req, HTTP_BAD_REQUEST, "Error: empty request");
+    }
+
+    switch (rf) {
+    case RetFormat::HEX: {
+        std::vector<unsigned char> strRequestV = ParseHex(strRequestMutable);
+        strRequestMutable.assign(strRequestV.begin(), strRequestV.end());
+    }
+
+    case RetFormat::BINARY: {
+        try {
+            if (strRequestMutable.size() > 0)
+            {
+                if (fInputParsed)
+                    return RESTERR(req, HTTP_BAD_REQUEST, "Combination of URI scheme inputs and raw post data is not allowed");
+
+                CDataStream oss(SER_NETWORK, PROTOCOL_VERSION);
+                oss << strRequestMutable;
+                oss >> fCheckMemPool;
+                oss >> vKeyImages;
+            }
+        } catch (const std::ios_base::failure& e) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Parse error");
+        }
+        break;
+    }
+
+    case RetFormat::JSON: {
+        if (!fInputParsed)
+            return RESTERR(req, HTTP_BAD_REQUEST, "Error: empty request");
+        break;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+
+    if (vKeyImages.size() > MAX_REST_KEY_IMAGES)
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Error: max key images exceeded (max: %d, tried: %d)", MAX_REST_KEY_IMAGES, vKeyImages.size()));
+
+    // Spent key images form a bitmap, followed by the spending txids in the same order
+    std::vector<unsigned char> bitmap((vKeyImages.size() + 7) / 8);
+    std::vector<uint256> vSpendTxids;
+    std::string bitmapStringRepresentation;
+    int nHeight;
+    uint256 hashTip;
+    {
+        std::map<CCmpPubKey, uint256> mapSpent;
+        LOCK(cs_main);
+        pblocktree->ReadRCTKeyImages(vKeyImages, mapSpent);
+        if (fCheckMemPool)
+            mempool.HaveKeyImages(vKeyImages, mapSpent);
+        nHeight = chainActive.Height();
+        hashTip = chainActive.Tip()->GetBlockHash();
+
+        for (size_t i = 0; i < vKeyImages.size(); ++i) {
+            auto it = mapSpent.find(vKeyImages[i]);
+            const bool hit = it != mapSpent.end();
+            bitmapStringRepresentation.append(hit ? "1" : "0");
+            bitmap[i / 8] |= ((uint8_t)hit) << (i % 8);
+            if (hit)
+                vSpendTxids.emplace_back(it->second);
+        }
+    }
+
+    switch (rf) {
+    case RetFormat::BINARY:
+    case RetFormat::HEX: {
+        CDataStream ssKeyImagesResponse(SER_NETWORK, PROTOCOL_VERSION);
+        ssKeyImagesResponse << nHeight << hashTip << bitmap << vSpendTxids;
+
+        if (rf == RetFormat::HEX) {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ssKeyImagesResponse) + "\n");
+        } else {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ssKeyImagesResponse.str());
+        }
+        return true;
+    }
+
+    case RetFormat::JSON: {
+        UniValue objKeyImagesResponse(UniValue::VOBJ);
+        objKeyImagesResponse.pushKV("chainHeight", nHeight);
+        objKeyImagesResponse.pushKV("chaintipHash", hashTip.GetHex());
+        objKeyImagesResponse.pushKV("bitmap", bitmapStringRepresentation);
+
+        UniValue spends(UniValue::VARR);
+        for (const uint256& txid : vSpendTxids)
+            spends.push_back(txid.GetHex());
+        objKeyImagesResponse.pushKV("spends", spends);
+
+        std::string strJSON = objKeyImagesResponse.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool rest_accumulatorcheckpoint(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    int32_t nHeight;
+    if (!ParseInt32(param, &nHeight) || nHeight < 0)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid height: " + param);
+
+    uint256 hashBlock;
+    std::vector<CAccumulatorCheckpointValue> vValues;
+    {
+        LOCK(cs_main);
+        const CBlockIndex* pindex = chainActive[nHeight];
+        if (!pindex)
+            return RESTERR(req, HTTP_NOT_FOUND, "Block height out of range: " + param);
+        hashBlock = pindex->GetBlockHash();
+
+        for (const libzerocoin::CoinDenomination denom : libzerocoin::zerocoinDenomList) {
+            CAccumulatorCheckpointValue value;
+            value.nDenomination = libzerocoin::ZerocoinDenominationToAmount(denom);
+            value.hashChecksum = pindex->GetAccumulatorHash(denom);
+            // Blocks before the first mint of a denomination have no value for it
+            if (!value.hashChecksum.IsNull() && !GetAccumulatorValueFromChecksum(value.hashChecksum, false, value.bnValue))
+                return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Accumulator value not found: " + value.hashChecksum.GetHex());
+            vValues.emplace_back(value);
+        }
+    }
+
+    CDataStream ssCheckpoint(SER_NETWORK, PROTOCOL_VERSION);
+    ssCheckpoint << hashBlock << nHeight << vValues;
+
+    switch (rf) {
+    case RetFormat::BINARY: {
+        std::string binaryCheckpoint = ssCheckpoint.str();
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, binaryCheckpoint);
+        return true;
+    }
+
+    case RetFormat::HEX: {
+        std::string strHex = HexStr(ssCheckpoint) + "\n";
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, strHex);
+        return true;
+    }
+
+    case RetFormat::JSON: {
+        UniValue objCheckpoint(UniValue::VOBJ);
+        objCheckpoint.pushKV("blockhash", hashBlock.GetHex());
+        objCheckpoint.pushKV("height", nHeight);
+
+        UniValue accumulators(UniValue::VARR);
+        for (const CAccumulatorCheckpointValue& value : vValues) {
+            UniValue accumulator(UniValue::VOBJ);
+            accumulator.pushKV("denomination", ValueFromAmount(value.nDenomination));
+            accumulator.pushKV("checksum", value.hashChecksum.GetHex());
+            accumulator.pushKV("value", value.bnValue.GetHex());
+            accumulators.push_back(accumulator);
+        }
+        objCheckpoint.pushKV("accumulators", accumulators);
+
+        std::string strJSON = objCheckpoint.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(HTTPRequest* req, const std::string& strReq);
@@ -581,6 +902,9 @@ static const struct {
       {"/rest/mempool/contents", rest_mempool_contents},
       {"/rest/headers/", rest_headers},
       {"/rest/getutxos", rest_getutxos},
+      {"/rest/anonoutputs/", rest_anonoutputs},
+      {"/rest/keyimages", rest_keyimages},
+      {"/rest/accumulatorcheckpoint/", rest_accumulatorcheckpoint},
 };
 
 bool StartREST()
@@ -22,6 +22,7 @@
 #include <policy/policy.h>
 #include <pow.h>
 #include <primitives/transaction.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <script/descriptor.h>
 #include <streams.h>
@@ -49,6 +50,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <veil/zerocoin/zchain.h>
+#include <veil/validationstats.h>
 #include <crypto/ethash/include/ethash/ethash.hpp>
 
 struct CUpdatedBlock
@@ -137,6 +139,15 @@ UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex
     return result;
 }
 
+static UniValue blockTxToJSON(const CTransaction& tx)
+{
+    UniValue objTx(UniValue::VOBJ);
+    std::vector<std::vector<COutPoint> > vInputs;
+    GetRingCtInputs(tx.vin[0], vInputs);
+    TxToUniv(tx, uint256(), vInputs, objTx, true, RPCSerializationFlags());
+    return objTx;
+}
+
 UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, bool txDetails)
 {
     // Serialize passed information without accessing chain state of the active chain!
@@ -183,13 +194,7 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
     for(const auto& tx : block.vtx)
     {
         if(txDetails)
-        {
-            UniValue objTx(UniValue::VOBJ);
-            std::vector<std::vector<COutPoint> > vInputs;
-            GetRingCtInputs(tx->vin[0], vInputs);
-            TxToUniv(*tx, uint256(), vInputs, objTx, true, RPCSerializationFlags());
-            txs.push_back(objTx);
-        }
+            txs.push_back(blockTxToJSON(*tx));
         else
             txs.push_back(tx->GetHash().GetHex());
     }
@@ -220,6 +225,28 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
     return result;
 }
 
+void blockToJSONStream(JSONStreamWriter& writer, const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, bool txDetails)
+{
+    // Everything but the transaction details is small, write it in the same order blockToJSON does
+    UniValue result = blockToJSON(block, tip, blockindex, false);
+    const std::vector<std::string>& keys = result.getKeys();
+    const std::vector<UniValue>& values = result.getValues();
+
+    writer.BeginObject();
+    for (size_t i = 0; i < keys.size(); i++) {
+        writer.Key(keys[i]);
+        if (!txDetails || keys[i] != "tx") {
+            writer.Value(values[i]);
+            continue;
+        }
+        writer.BeginArray();
+        for (const auto& tx : block.vtx)
+            writer.Value(blockTxToJSON(*tx));
+        writer.EndArray();
+    }
+    writer.EndObject();
+}
+
 static UniValue getblockcount(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 0)
@@ -268,6 +295,8 @@ static UniValue getchainalgostats(const JSONRPCRequest& request)
             + HelpExampleRpc("getchainalgostats", "count, height")
         );
 
+    LOCK(cs_main);
+
     int nBlockCount = ALGO_RATIO_LOOK_BACK_BLOCK_COUNT;
     if (nBlockCount > chainActive.Height()) {
         nBlockCount = chainActive.Height();
@@ -285,45 +314,12 @@ static UniValue getchainalgostats(const JSONRPCRequest& request)
             throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range");
     }
 
-    int nX16rtCount  = 0;
-    int nRandomxCount  = 0;
-    int nProgPowCount  = 0;
-    int nSha256dCount  = 0;
-    int nPoSCount = 0;
+    CChainAlgoStats stats;
+    if (!chainActive.GetAlgoStats(nHeight - nBlockCount + 1, nHeight, stats))
+        throw JSONRPCError(RPC_MISC_ERROR, "Check parameters");
 
     CBlockIndex *pend = chainActive[nHeight];
-    if (!pend)
-        throw JSONRPCError(RPC_MISC_ERROR, "Chain reorged during execution.  Try again");
-
-    CBlockIndex *pindex = pend;
-
-    try {
-        // Rather than holding a lock the whole time in case they grind a
-        // long chain. just catch the exception and tell them no bueno.
-        while (pindex) {
-            nBlockCount--;
-            if (pindex->IsProofOfStake()) {
-                nPoSCount++;
-            } else if (pindex->IsProgProofOfWork()) {
-                nProgPowCount++;
-            } else if (pindex->IsRandomXProofOfWork()) {
-                nRandomxCount++;
-            } else if (pindex->IsSha256DProofOfWork()) {
-                nSha256dCount++;
-            } else if (pindex->IsX16RTProofOfWork()) {
-                nX16rtCount++;
-            }
-            if(nBlockCount <= 0) {
-                break;
-            }
-            pindex=pindex->pprev;
-        }
-    } catch (std::exception &e) {
-        throw JSONRPCError(RPC_MISC_ERROR, "Chain reorged during execution.  Try again");
-    }
-
-    if (!pindex)
-        throw JSONRPCError(RPC_MISC_ERROR, "Check parameters");
+    CBlockIndex *pindex = chainActive[nHeight - nBlockCount + 1];
 
     UniValue obj(UniValue::VOBJ);
 
@@ -332,11 +328,11 @@ static UniValue getchainalgostats(const JSONRPCRequest& request)
     obj.pushKV("period", (uint64_t)(pend->nTime - pindex->nTime)/60);
     obj.pushKV("startblock", (uint64_t)pindex->nHeight);
     obj.pushKV("endblock", (uint64_t)pend->nHeight);
-    obj.pushKV("pos", nPoSCount);
-    obj.pushKV("progpow", nProgPowCount);
-    obj.pushKV("randomx", nRandomxCount);
-    obj.pushKV("sha256d", nSha256dCount);
-    obj.pushKV("x16rt", nX16rtCount);
+    obj.pushKV("pos", stats.nBlocks[CChainAlgoStats::POS]);
+    obj.pushKV("progpow", stats.nBlocks[CChainAlgoStats::PROGPOW]);
+    obj.pushKV("randomx", stats.nBlocks[CChainAlgoStats::RANDOMX]);
+    obj.pushKV("sha256d", stats.nBlocks[CChainAlgoStats::SHA256D]);
+    obj.pushKV("x16rt", stats.nBlocks[CChainAlgoStats::X16RT]);
 
     return obj;
 }
@@ -1082,6 +1078,10 @@ static UniValue getblock(const JSONRPCRequest& request)
         return strHex;
     }
 
+    if (request.stream) {
+        blockToJSONStream(*request.stream, block, tip, pblockindex, verbosity >= 2);
+        return NullUniValue;
+    }
     return blockToJSON(block, tip, pblockindex, verbosity >= 2);
 }
 
@@ -1425,6 +1425,9 @@ UniValue getblockchaininfo(const JSONRPCRequest& request)
             "  \"initialblockdownload\": xxxx, (bool) (debug information) estimate of whether this node is in Initial Block Download mode.\n"
             "  \"chainwork\": \"xxxx\"         (string) total amount of work in active chain, in hexadecimal\n"
             "  \"chainpow\": \"xxxx\"          (string) total amount of PoW work in active chain, in hexadecimal\n"
+            "  \"chainwork_progpow\": \"xxxx\"  (string) total ProgPow work in active chain, in hexadecimal\n"
+            "  \"chainwork_randomx\": \"xxxx\"  (string) total RandomX work in active chain, in hexadecimal\n"
+            "  \"chainwork_sha256d\": \"xxxx\"  (string) total SHA256D work in active chain, in hexadecimal\n"
             "  \"size_on_disk\": xxxxxx,       (numeric) the estimated size of the block and undo files on disk\n"
             "  \"pruned\": xx,                 (boolean) if the blocks are subject to pruning\n"
             "  \"pruneheight\": xxxxxx,        (numeric) lowest-height complete block stored (only present if pruning is enabled)\n"
@@ -1502,6 +1505,11 @@ UniValue getblockchaininfo(const JSONRPCRequest& request)
     obj.pushKV("initialblockdownload",  IsInitialBlockDownload());
     obj.pushKV("chainwork",             chainActive.Tip()->nChainWork.GetHex());
     obj.pushKV("chainpow",             chainActive.Tip()->nChainPoW.GetHex());
+    CChainAlgoStats stats;
+    chainActive.GetAlgoStats(0, chainActive.Height(), stats);
+    obj.pushKV("chainwork_progpow",     stats.nWork[CChainAlgoStats::PROGPOW].GetHex());
+    obj.pushKV("chainwork_randomx",     stats.nWork[CChainAlgoStats::RANDOMX].GetHex());
+    obj.pushKV("chainwork_sha256d",     stats.nWork[CChainAlgoStats::SHA256D].GetHex());
     obj.pushKV("size_on_disk",          CalculateCurrentUsage());
     obj.pushKV("pruned",                fPruneMode);
     if (fPruneMode) {
@@ -2488,6 +2496,92 @@ UniValue findserial(const JSONRPCRequest& request)
     return ret;
 }
 
+/** Upper bounds of the validation stage histogram buckets in microseconds, the last bucket holds everything slower */
+static const std::array<int64_t, 5> VALIDATION_STAGE_BUCKETS_MICROS = {100, 1000, 10000, 100000, 1000000};
+
+static UniValue getvalidationstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            "getvalidationstats ( reset )\n"
+            "\nReturns timings of the block validation stages since startup, and percentiles and a histogram over the\n"
+            "last " + std::to_string(VALIDATION_STATS_WINDOW) + " samples of each stage. Most stages are sampled once per connected block, range proofs,\n"
+            "MLSAGs and ring member reads once per verification while checking or connecting a block. Verifications for mempool\n"
+            "acceptance and block template checks are not sampled.\n"
+            "\nArguments:\n"
+            "1. reset    (boolean, optional, default=false) Clear the stats after returning them\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"stage\": {               (object) One of checkblock, connecttransactions, rangeproof, mlsag, rctoutputread,\n"
+            "                             zerocoinspend, accumulatorcheckpoint, veildatahash, zerocoindatabase,\n"
+            "                             flushview and connectblock\n"
+            "    \"samples\": n,          (numeric) Number of samples since startup\n"
+            "    \"total_ms\": n,         (numeric) Total time of all samples\n"
+            "    \"avg_ms\": n,           (numeric) Average time per sample\n"
+            "    \"max_ms\": n,           (numeric) Slowest sample\n"
+            "    \"recent\": {\n"
+            "      \"samples\": n,        (numeric) Number of samples in the recent window\n"
+            "      \"p50_ms\": n,\n"
+            "      \"p90_ms\": n,\n"
+            "      \"p99_ms\": n,\n"
+            "      \"histogram\": {       (object) Number of recent samples per time bucket\n"
+            "        \"<=0.1ms\": n,\n"
+            "        ...\n"
+            "        \">1000ms\": n\n"
+            "      }\n"
+            "    }\n"
+            "  }, ...\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getvalidationstats", "")
+            + HelpExampleRpc("getvalidationstats", "true")
+        );
+
+    bool fReset = !request.params[0].isNull() && request.params[0].get_bool();
+
+    UniValue ret(UniValue::VOBJ);
+    for (int i = 0; i < (int)ValidationStage::COUNT; i++) {
+        const ValidationStage stage = (ValidationStage)i;
+        ValidationStageStats stats = GetValidationStageStats(stage);
+
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("samples", stats.nSamples);
+        obj.pushKV("total_ms", stats.nTotalMicros * 0.001);
+        obj.pushKV("avg_ms", stats.nSamples ? stats.nTotalMicros * 0.001 / stats.nSamples : 0);
+        obj.pushKV("max_ms", stats.nMaxMicros * 0.001);
+
+        std::vector<int64_t>& vRecent = stats.vRecentMicros;
+        std::sort(vRecent.begin(), vRecent.end());
+        auto percentile = [&vRecent](int p) {
+            return vRecent.empty() ? 0 : vRecent[(vRecent.size() - 1) * p / 100] * 0.001;
+        };
+
+        UniValue recent(UniValue::VOBJ);
+        recent.pushKV("samples", (uint64_t)vRecent.size());
+        recent.pushKV("p50_ms", percentile(50));
+        recent.pushKV("p90_ms", percentile(90));
+        recent.pushKV("p99_ms", percentile(99));
+
+        UniValue histogram(UniValue::VOBJ);
+        auto itBucketStart = vRecent.begin();
+        for (const int64_t nBound : VALIDATION_STAGE_BUCKETS_MICROS) {
+            auto itBucketEnd = std::upper_bound(itBucketStart, vRecent.end(), nBound);
+            histogram.pushKV(strprintf("<=%gms", nBound * 0.001), (uint64_t)(itBucketEnd - itBucketStart));
+            itBucketStart = itBucketEnd;
+        }
+        histogram.pushKV(strprintf(">%gms", VALIDATION_STAGE_BUCKETS_MICROS.back() * 0.001), (uint64_t)(vRecent.end() - itBucketStart));
+        recent.pushKV("histogram", histogram);
+        obj.pushKV("recent", recent);
+
+        ret.pushKV(GetValidationStageName(stage), obj);
+    }
+
+    if (fReset)
+        ResetValidationStats();
+
+    return ret;
+}
+
 static const CRPCCommand commands[] =
 { //  category              name                      actor (function)         argNames
   //  --------------------- ------------------------  -----------------------  ----------
@@ -2511,6 +2605,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getrawmempool",          &getrawmempool,          {"verbose"} },
     { "blockchain",         "gettxout",               &gettxout,               {"txid","n","include_mempool"} },
     { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {} },
+    { "blockchain",         "getvalidationstats",     &getvalidationstats,     {"reset"} },
     { "blockchain",         "getzerocoinsupply",      &getzerocoinsupply,      {"height"} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        {"height"} },
     { "blockchain",         "savemempool",            &savemempool,            {} },
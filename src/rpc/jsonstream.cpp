@@ -0,0 +1,90 @@
+// Copyright (c) 2019-2022 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonstream.h>
+
+#include <assert.h>
+
+JSONStreamWriter::JSONStreamWriter(const Sink& sinkIn, size_t nFlushSizeIn) :
+    sink(sinkIn), nFlushSize(nFlushSizeIn), fAfterKey(false), fDone(false)
+{
+}
+
+void JSONStreamWriter::BeginValue()
+{
+    assert(ExpectsValue() || (!vObject.empty() && !vObject.back()));
+    if (fAfterKey) {
+        fAfterKey = false;
+    } else if (!vCount.empty()) {
+        if (vCount.back()++ > 0)
+            strBuffer += ',';
+    }
+}
+
+void JSONStreamWriter::EndValue()
+{
+    if (vCount.empty())
+        fDone = true;
+    if (strBuffer.size() >= nFlushSize)
+        Flush();
+}
+
+void JSONStreamWriter::BeginObject()
+{
+    BeginValue();
+    strBuffer += '{';
+    vCount.push_back(0);
+    vObject.push_back(true);
+}
+
+void JSONStreamWriter::EndObject()
+{
+    assert(!vObject.empty() && vObject.back() && !fAfterKey);
+    strBuffer += '}';
+    vCount.pop_back();
+    vObject.pop_back();
+    EndValue();
+}
+
+void JSONStreamWriter::BeginArray()
+{
+    BeginValue();
+    strBuffer += '[';
+    vCount.push_back(0);
+    vObject.push_back(false);
+}
+
+void JSONStreamWriter::EndArray()
+{
+    assert(!vObject.empty() && !vObject.back());
+    strBuffer += ']';
+    vCount.pop_back();
+    vObject.pop_back();
+    EndValue();
+}
+
+void JSONStreamWriter::Key(const std::string& strKey)
+{
+    assert(!vObject.empty() && vObject.back() && !fAfterKey);
+    if (vCount.back()++ > 0)
+        strBuffer += ',';
+    strBuffer += UniValue(strKey).write();
+    strBuffer += ':';
+    fAfterKey = true;
+}
+
+void JSONStreamWriter::Value(const UniValue& val)
+{
+    BeginValue();
+    strBuffer += val.write();
+    EndValue();
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (strBuffer.empty())
+        return;
+    sink(strBuffer);
+    strBuffer.clear();
+}
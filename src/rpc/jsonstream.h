@@ -0,0 +1,58 @@
+// Copyright (c) 2019-2022 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef VEIL_RPC_JSONSTREAM_H
+#define VEIL_RPC_JSONSTREAM_H
+
+#include <univalue.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Writes a JSON value piece by piece into a sink, so large RPC and REST results
+ * can be serialized while they are produced instead of first being built up as
+ * one UniValue tree. The output is compact, the same as UniValue::write(), and
+ * reaches the sink in parts of about nFlushSize bytes.
+ */
+class JSONStreamWriter
+{
+public:
+    typedef std::function<void(const std::string&)> Sink;
+    static const size_t DEFAULT_FLUSH_SIZE = 64 * 1024;
+
+    explicit JSONStreamWriter(const Sink& sinkIn, size_t nFlushSizeIn = DEFAULT_FLUSH_SIZE);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+    /** Write the key of the next value of the current object */
+    void Key(const std::string& strKey);
+    /** Write a complete value */
+    void Value(const UniValue& val);
+
+    /** Whether the next thing written must be a value, because nothing was written yet or a key was just written */
+    bool ExpectsValue() const { return fAfterKey || (vCount.empty() && !fDone); }
+
+    /** Pass everything written so far on to the sink */
+    void Flush();
+
+private:
+    Sink sink;
+    size_t nFlushSize;
+    std::string strBuffer;
+    //! Number of values or keys written so far in each open array or object
+    std::vector<size_t> vCount;
+    //! Whether each open container is an object
+    std::vector<bool> vObject;
+    bool fAfterKey;
+    bool fDone;
+
+    void BeginValue();
+    void EndValue();
+};
+
+#endif // VEIL_RPC_JSONSTREAM_H
@@ -615,8 +615,12 @@ static UniValue getblocktemplate_impl(const std::string &strMode, const UniValue
     // Cache whether the last invocation was with segwit support, to avoid returning
     // a segwit-block to a non-segwit caller.
     static bool fLastTemplateSupportsSegwit = true;
+    // Rebuild right away when a transaction in the template left the mempool, and at most every 5 seconds to
+    // pick up new ones. Other mempool churn leaves the template as it is.
+    static BlockTemplateTracker templateTracker(mempool);
     if (pindexPrev != chainActive.Tip() ||
-        (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - nStart > 5) ||
+        templateTracker.IsInvalid() ||
+        (templateTracker.GetAdded() > 0 && GetTime() - nStart > 5) ||
         fLastTemplateSupportsSegwit != fSupportsSegwit)
     {
         // Clear pindexPrev so future calls make a new block, despite any failures from here on
@@ -662,6 +666,7 @@ static UniValue getblocktemplate_impl(const std::string &strMode, const UniValue
 
         // Need to update only after we know CreateNewBlock succeeded
         pindexPrev = pindexPrevNew;
+        templateTracker.Reset(pblocktemplate->block);
     }
     assert(pindexPrev);
     CBlock* pblock = &pblocktemplate->block; // pointer for convenience
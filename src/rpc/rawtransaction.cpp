@@ -1194,7 +1194,6 @@ static UniValue sendrawtransaction(const JSONRPCRequest& request)
 
     CInv inv(MSG_TX, hashTx);
     if (fDandelion) {
-        LOCK(veil::dandelion.cs);
         veil::dandelion.Add(hashTx, GetAdjustedTime() + veil::dandelion.nDefaultStemTime, veil::dandelion.nDefaultNodeID);
     }
     else {
@@ -20,6 +20,7 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 
+#include <array>
 #include <memory> // for unique_ptr
 #include <unordered_map>
 
@@ -32,6 +33,38 @@ static RPCTimerInterface* timerInterface = nullptr;
 /* Map of name to timer. */
 static std::map<std::string, std::unique_ptr<RPCTimerBase> > deadlineTimers;
 
+/** Upper bounds of the RPC latency histogram buckets, the last bucket holds everything slower */
+static const std::array<int64_t, 8> RPC_LATENCY_BUCKETS_MS = {1, 5, 10, 50, 100, 500, 1000, 5000};
+
+struct RPCMethodStats
+{
+    uint64_t nCalls{0};
+    uint64_t nErrors{0};
+    int64_t nTotalMicros{0};
+    int64_t nMaxMicros{0};
+    std::array<uint64_t, RPC_LATENCY_BUCKETS_MS.size() + 1> vBuckets{};
+};
+
+static CCriticalSection cs_rpcStats;
+static std::map<std::string, RPCMethodStats> mapRPCStats GUARDED_BY(cs_rpcStats);
+
+static void RecordRPCLatency(const std::string& strMethod, int64_t nMicros, bool fError)
+{
+    LogPrint(BCLog::BENCH, "  - RPC %s: %.2fms%s\n", strMethod, nMicros * 0.001, fError ? " (error)" : "");
+
+    size_t nBucket = 0;
+    while (nBucket < RPC_LATENCY_BUCKETS_MS.size() && nMicros > RPC_LATENCY_BUCKETS_MS[nBucket] * 1000)
+        nBucket++;
+
+    LOCK(cs_rpcStats);
+    RPCMethodStats& stats = mapRPCStats[strMethod];
+    stats.nCalls++;
+    stats.nErrors += fError;
+    stats.nTotalMicros += nMicros;
+    stats.nMaxMicros = std::max(stats.nMaxMicros, nMicros);
+    stats.vBuckets[nBucket]++;
+}
+
 static struct CRPCSignals
 {
     boost::signals2::signal<void ()> Started;
@@ -255,6 +288,101 @@ static UniValue uptime(const JSONRPCRequest& jsonRequest)
     return GetTime() - GetStartupTime();
 }
 
+static UniValue getperfstats(const JSONRPCRequest& jsonRequest)
+{
+    if (jsonRequest.fHelp || jsonRequest.params.size() > 1)
+        throw std::runtime_error(
+                "getperfstats ( reset )\n"
+                        "\nReturns the latency of every RPC method called since startup and, when the node runs with -profilelocks,\n"
+                        "the wait and hold times of every lock site.\n"
+                        "\nArguments:\n"
+                        "1. reset    (boolean, optional, default=false) Clear the stats after returning them\n"
+                        "\nResult:\n"
+                        "{\n"
+                        "  \"rpc\": {\n"
+                        "    \"method\": {\n"
+                        "      \"calls\": n,           (numeric) Number of calls\n"
+                        "      \"errors\": n,          (numeric) Number of calls that returned an error\n"
+                        "      \"total_ms\": n,        (numeric) Total time spent executing the method\n"
+                        "      \"max_ms\": n,          (numeric) Slowest call\n"
+                        "      \"histogram\": {       (object) Number of calls per latency bucket\n"
+                        "        \"<=1ms\": n,\n"
+                        "        ...\n"
+                        "        \">5000ms\": n\n"
+                        "      }\n"
+                        "    }, ...\n"
+                        "  },\n"
+                        "  \"lockprofiling\": true|false,  (boolean) If lock sites are being profiled\n"
+                        "  \"locks\": [                 (array) Lock sites ordered by total wait time\n"
+                        "    {\n"
+                        "      \"lock\": \"name\",        (string) The locked mutex\n"
+                        "      \"site\": \"file:line\",   (string) Where it was locked\n"
+                        "      \"count\": n,            (numeric) Times the site was entered\n"
+                        "      \"contended\": n,        (numeric) Times the site had to wait for the lock\n"
+                        "      \"wait_total_ms\": n,\n"
+                        "      \"wait_max_ms\": n,\n"
+                        "      \"hold_total_ms\": n,\n"
+                        "      \"hold_max_ms\": n\n"
+                        "    }, ...\n"
+                        "  ]\n"
+                        "}\n"
+                        "\nExamples:\n"
+                + HelpExampleCli("getperfstats", "")
+                + HelpExampleRpc("getperfstats", "true")
+        );
+
+    bool fReset = !jsonRequest.params[0].isNull() && jsonRequest.params[0].get_bool();
+
+    UniValue rpc(UniValue::VOBJ);
+    {
+        LOCK(cs_rpcStats);
+        for (const auto& it : mapRPCStats) {
+            const RPCMethodStats& stats = it.second;
+            UniValue method(UniValue::VOBJ);
+            method.pushKV("calls", stats.nCalls);
+            method.pushKV("errors", stats.nErrors);
+            method.pushKV("total_ms", stats.nTotalMicros * 0.001);
+            method.pushKV("max_ms", stats.nMaxMicros * 0.001);
+
+            UniValue histogram(UniValue::VOBJ);
+            for (size_t i = 0; i < RPC_LATENCY_BUCKETS_MS.size(); i++)
+                histogram.pushKV(strprintf("<=%dms", RPC_LATENCY_BUCKETS_MS[i]), stats.vBuckets[i]);
+            histogram.pushKV(strprintf(">%dms", RPC_LATENCY_BUCKETS_MS.back()), stats.vBuckets.back());
+            method.pushKV("histogram", histogram);
+            rpc.pushKV(it.first, method);
+        }
+        if (fReset)
+            mapRPCStats.clear();
+    }
+
+    std::vector<LockSiteStats> vLockStats = GetLockSiteStats();
+    if (fReset)
+        ResetLockSiteStats();
+    std::sort(vLockStats.begin(), vLockStats.end(), [](const LockSiteStats& a, const LockSiteStats& b) {
+        return a.nWaitMicros > b.nWaitMicros;
+    });
+
+    UniValue locks(UniValue::VARR);
+    for (const LockSiteStats& stats : vLockStats) {
+        UniValue site(UniValue::VOBJ);
+        site.pushKV("lock", stats.strName);
+        site.pushKV("site", strprintf("%s:%d", stats.strFile, stats.nLine));
+        site.pushKV("count", stats.nCount);
+        site.pushKV("contended", stats.nContended);
+        site.pushKV("wait_total_ms", stats.nWaitMicros * 0.001);
+        site.pushKV("wait_max_ms", stats.nMaxWaitMicros * 0.001);
+        site.pushKV("hold_total_ms", stats.nHoldMicros * 0.001);
+        site.pushKV("hold_max_ms", stats.nMaxHoldMicros * 0.001);
+        locks.push_back(site);
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("rpc", rpc);
+    result.pushKV("lockprofiling", g_lock_profiling.load());
+    result.pushKV("locks", locks);
+    return result;
+}
+
 /**
  * Call Table
  */
@@ -265,6 +393,7 @@ static const CRPCCommand vRPCCommands[] =
     { "control",            "help",                   &help,                   {"command"}  },
     { "control",            "stop",                   &stop,                   {}  },
     { "control",            "uptime",                 &uptime,                 {}  },
+    { "control",            "getperfstats",           &getperfstats,           {"reset"}  },
 };
 
 CRPCTable::CRPCTable()
@@ -487,19 +616,30 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
 
     g_rpcSignals.PreCommand(*pcmd);
 
+    const int64_t nTimeStart = GetTimeMicros();
     try
     {
         // Execute, convert arguments to array if necessary
+        UniValue result;
         if (request.params.isObject()) {
-            return pcmd->actor(transformNamedArguments(request, pcmd->argNames));
+            result = pcmd->actor(transformNamedArguments(request, pcmd->argNames));
         } else {
-            return pcmd->actor(request);
+            result = pcmd->actor(request);
         }
+        RecordRPCLatency(request.strMethod, GetTimeMicros() - nTimeStart, false);
+        return result;
     }
     catch (const std::exception& e)
     {
+        RecordRPCLatency(request.strMethod, GetTimeMicros() - nTimeStart, true);
         throw JSONRPCError(RPC_MISC_ERROR, e.what());
     }
+    catch (...)
+    {
+        // JSONRPCError throws a UniValue
+        RecordRPCLatency(request.strMethod, GetTimeMicros() - nTimeStart, true);
+        throw;
+    }
 }
 
 std::vector<std::string> CRPCTable::listCommands() const
@@ -13,9 +13,71 @@
 
 #include <stdio.h>
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <set>
+#include <tuple>
+
+std::atomic<bool> g_lock_profiling{false};
+
+//! Waits at least this long are logged with -debug=bench while profiling locks
+static const int64_t LOCK_WAIT_LOG_MICROS = 10000;
+
+namespace {
+
+struct LockSite {
+    const char* pszName;
+    const char* pszFile;
+    int nLine;
+
+    // Names and files are string literals, so their addresses identify the site
+    bool operator<(const LockSite& other) const
+    {
+        return std::tie(pszFile, nLine, pszName) < std::tie(other.pszFile, other.nLine, other.pszName);
+    }
+};
+
+// A plain mutex, locking it must not be profiled itself
+std::mutex g_lock_stats_mutex;
+std::map<LockSite, LockSiteStats> g_lock_stats;
+
+} // namespace
+
+void RecordLockSite(const char* pszName, const char* pszFile, int nLine, bool fContended, int64_t nWaitMicros, int64_t nHoldMicros)
+{
+    if (nWaitMicros >= LOCK_WAIT_LOG_MICROS)
+        LogPrint(BCLog::BENCH, "      - Lock %s at %s:%d waited %.2fms\n", pszName, pszFile, nLine, nWaitMicros * 0.001);
+
+    std::lock_guard<std::mutex> guard(g_lock_stats_mutex);
+    LockSiteStats& stats = g_lock_stats[{pszName, pszFile, nLine}];
+    stats.nCount++;
+    stats.nContended += fContended;
+    stats.nWaitMicros += nWaitMicros;
+    stats.nMaxWaitMicros = std::max(stats.nMaxWaitMicros, nWaitMicros);
+    stats.nHoldMicros += nHoldMicros;
+    stats.nMaxHoldMicros = std::max(stats.nMaxHoldMicros, nHoldMicros);
+}
+
+std::vector<LockSiteStats> GetLockSiteStats()
+{
+    std::vector<LockSiteStats> vStats;
+    std::lock_guard<std::mutex> guard(g_lock_stats_mutex);
+    vStats.reserve(g_lock_stats.size());
+    for (const auto& it : g_lock_stats) {
+        vStats.emplace_back(it.second);
+        vStats.back().strName = it.first.pszName;
+        vStats.back().strFile = it.first.pszFile;
+        vStats.back().nLine = it.first.nLine;
+    }
+    return vStats;
+}
+
+void ResetLockSiteStats()
+{
+    std::lock_guard<std::mutex> guard(g_lock_stats_mutex);
+    g_lock_stats.clear();
+}
 
 #ifdef DEBUG_LOCKCONTENTION
 #if !defined(HAVE_THREAD_LOCAL)
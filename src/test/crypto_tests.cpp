@@ -562,4 +562,28 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+BOOST_AUTO_TEST_CASE(sha256d80)
+{
+    unsigned char header[80];
+    for (int j = 0; j < 80; ++j) {
+        header[j] = InsecureRandBits(8);
+    }
+    uint32_t midstate[8];
+    SHA256D80Midstate(midstate, header);
+
+    for (int i = 0; i <= 32; ++i) {
+        unsigned char in[16 * 32];
+        unsigned char out1[32 * 32], out2[32 * 32];
+        for (int j = 0; j < i; ++j) {
+            for (int k = 0; k < 16; ++k) {
+                in[16 * j + k] = InsecureRandBits(8);
+            }
+            memcpy(header + 64, in + 16 * j, 16);
+            CHash256().Write(header, 80).Finalize(out1 + 32 * j);
+        }
+        SHA256D80(out2, midstate, in, i);
+        BOOST_CHECK(memcmp(out1, out2, 32 * i) == 0);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,143 @@
+// Copyright (c) 2026 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Tests for the stem routing and expiry of DandelionInventory.
+
+#include <test/test_veil.h>
+
+#include <chainparams.h>
+#include <net.h>
+#include <util/time.h>
+#include <veil/dandelioninventory.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+CService ip(uint32_t i)
+{
+    struct in_addr s;
+    s.s_addr = i;
+    return CService(CNetAddr(s), Params().GetDefaultPort());
+}
+
+struct DandelionTestingSetup : public BasicTestingSetup {
+    const int64_t nTimeStart = 1600000000;
+    NodeId nNextId = 0;
+
+    DandelionTestingSetup()
+    {
+        SetMockTime(nTimeStart);
+    }
+    ~DandelionTestingSetup()
+    {
+        SetMockTime(0);
+    }
+
+    std::unique_ptr<CNode> NewNode()
+    {
+        CAddress addr(ip(0xa0b0c001 + nNextId), NODE_NONE);
+        return MakeUnique<CNode>(nNextId++, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "", /*fInboundIn=*/ false);
+    }
+
+    static std::vector<uint256> ToSend(veil::DandelionInventory& inventory, const CNode& node)
+    {
+        std::vector<uint256> vHashes;
+        inventory.GetStemInventoryToSend(node.GetId(), vHashes);
+        return vHashes;
+    }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(dandelion_tests, DandelionTestingSetup)
+
+// Peers can not keep inventory in the stem phase for longer than this node would
+BOOST_AUTO_TEST_CASE(add_clamps_stem_end)
+{
+    veil::DandelionInventory inventory;
+    const uint256 hashPast = InsecureRand256();
+    const uint256 hashFar = InsecureRand256();
+
+    BOOST_CHECK(!inventory.Add(hashPast, nTimeStart, 0));
+    BOOST_CHECK(!inventory.IsInStemPhase(hashPast));
+
+    BOOST_CHECK(inventory.Add(hashFar, std::numeric_limits<int64_t>::max(), 0));
+    BOOST_CHECK_EQUAL(inventory.GetTimeStemPhaseEnd(hashFar), nTimeStart + inventory.nDefaultStemTime);
+
+    std::vector<uint256> vFluff;
+    SetMockTime(nTimeStart + inventory.nDefaultStemTime);
+    inventory.Process({}, vFluff);
+    BOOST_CHECK(vFluff == std::vector<uint256>{hashFar});
+    BOOST_CHECK(!inventory.IsInStemPhase(hashFar));
+}
+
+// A stem end that sits in a slot the wheel passes before it is due stays
+// there until the wheel comes around again
+BOOST_AUTO_TEST_CASE(expire_on_wheel)
+{
+    veil::DandelionInventory inventory;
+    std::vector<uint256> vFluff;
+    inventory.Process({}, vFluff);
+
+    // Added 200s after the wheel was last advanced, so the slot of its end is
+    // reached while it is still more than one turn away
+    SetMockTime(nTimeStart + 200);
+    const uint256 hash = InsecureRand256();
+    const uint256 hashSoon = InsecureRand256();
+    BOOST_REQUIRE(inventory.Add(hash, nTimeStart + 320, inventory.nDefaultNodeID));
+    BOOST_REQUIRE(inventory.Add(hashSoon, nTimeStart + 201, inventory.nDefaultNodeID));
+
+    SetMockTime(nTimeStart + 201);
+    inventory.Process({}, vFluff);
+    BOOST_CHECK(vFluff == std::vector<uint256>{hashSoon});
+    BOOST_CHECK(inventory.IsInStemPhase(hash));
+
+    vFluff.clear();
+    SetMockTime(nTimeStart + 319);
+    inventory.Process({}, vFluff);
+    BOOST_CHECK(vFluff.empty());
+
+    SetMockTime(nTimeStart + 320);
+    inventory.Process({}, vFluff);
+    BOOST_CHECK(vFluff == std::vector<uint256>{hash});
+    BOOST_CHECK(!inventory.IsInStemPhase(hash));
+}
+
+// Inventory is routed to a stem peer other than its source, and is routed
+// again in the next epoch when that peer disconnects before it was sent
+BOOST_AUTO_TEST_CASE(route_and_reroute)
+{
+    veil::DandelionInventory inventory;
+    std::unique_ptr<CNode> nodeA = NewNode();
+    std::unique_ptr<CNode> nodeB = NewNode();
+    std::unique_ptr<CNode> nodeC = NewNode();
+
+    // No stem peers yet, so the inventory waits for the first epoch
+    const uint256 hash = InsecureRand256();
+    BOOST_REQUIRE(inventory.Add(hash, nTimeStart + 60, nodeC->GetId()));
+    std::vector<uint256> vFluff;
+    inventory.Process({nodeA.get(), nodeC.get()}, vFluff);
+    BOOST_CHECK(vFluff.empty());
+    BOOST_CHECK(!inventory.IsSent(hash));
+
+    // A stem peer disconnecting starts a new epoch, and the queued inventory follows its routes
+    nodeA->fDisconnect = true;
+    inventory.Process({nodeA.get(), nodeB.get(), nodeC.get()}, vFluff);
+    BOOST_CHECK(ToSend(inventory, *nodeA).empty());
+    BOOST_CHECK(ToSend(inventory, *nodeC).empty());
+    BOOST_CHECK(ToSend(inventory, *nodeB) == std::vector<uint256>{hash});
+    BOOST_CHECK(inventory.IsSent(hash));
+    BOOST_CHECK(inventory.IsNodePendingSend(hash, nodeB->GetId()));
+
+    // Draining the queue sends it once
+    BOOST_CHECK(ToSend(inventory, *nodeB).empty());
+
+    // Inventory from the same source keeps its route for the rest of the epoch
+    const uint256 hash2 = InsecureRand256();
+    BOOST_REQUIRE(inventory.Add(hash2, nTimeStart + 60, nodeC->GetId()));
+    BOOST_CHECK(ToSend(inventory, *nodeB) == std::vector<uint256>{hash2});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,206 @@
+// Copyright (c) 2026 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Tests for the lanes of the RPC work queue: how requests are classified, how
+// workers take items and how the lanes are sized.
+
+#include <httprpc.h>
+#include <httpserver.h>
+#include <test/test_veil.h>
+#include <util/system.h>
+
+#include <future>
+#include <thread>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+struct TestWorkItem final : public HTTPClosure {
+    int n;
+    std::function<void()> func;
+
+    explicit TestWorkItem(int nIn, std::function<void()> funcIn = nullptr) : n(nIn), func(funcIn) {}
+    void operator()() override
+    {
+        if (func)
+            func();
+    }
+};
+
+typedef WorkQueue<TestWorkItem> TestWorkQueue;
+
+int TakeNumber(TestWorkQueue& queue, HTTPWorkLane lane)
+{
+    std::unique_ptr<TestWorkItem> item = queue.TryTake(lane);
+    return item ? item->n : -1;
+}
+
+struct LaneArgsTestingSetup : public BasicTestingSetup {
+    LaneArgsTestingSetup()
+    {
+        gArgs.ClearArgs();
+        for (const char* arg : {"-rpcthreads", "-rpcworkqueue", "-rpclane", "-rpclanedepth", "-rpclanethreads"})
+            gArgs.AddArg(arg, "", false, OptionsCategory::RPC);
+    }
+    ~LaneArgsTestingSetup()
+    {
+        ResetArgs("");
+        std::string strError;
+        InitRPCMethodLanes(strError);
+        gArgs.ClearArgs();
+    }
+
+    static void ResetArgs(const std::string& strArg)
+    {
+        std::vector<std::string> vecArg;
+        if (strArg.size())
+            boost::split(vecArg, strArg, boost::is_space(), boost::token_compress_on);
+        vecArg.insert(vecArg.begin(), "testveil");
+
+        std::vector<const char*> vecChar;
+        for (std::string& s : vecArg)
+            vecChar.push_back(s.c_str());
+
+        std::string error;
+        BOOST_REQUIRE(gArgs.ParseParameters(vecChar.size(), vecChar.data(), error));
+    }
+
+    static std::array<int, HTTP_WORK_LANES> Threads(const std::string& strArg)
+    {
+        ResetArgs(strArg);
+        std::array<int, HTTP_WORK_LANES> threads;
+        std::string strError;
+        BOOST_CHECK(GetHTTPWorkLaneThreads(threads, strError));
+        return threads;
+    }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(httpserver_tests, LaneArgsTestingSetup)
+
+// A worker takes its own lane first, then the lighter lanes in order, and
+// never a heavier lane. Every lane is first in first out.
+BOOST_AUTO_TEST_CASE(work_queue_take_order)
+{
+    const std::array<size_t, HTTP_WORK_LANES> depths{{2, 2, 2}};
+    TestWorkQueue queue(depths);
+    BOOST_CHECK(queue.Enqueue(new TestWorkItem(1), HTTPWorkLane::CHEAP));
+    BOOST_CHECK(queue.Enqueue(new TestWorkItem(2), HTTPWorkLane::CHEAP));
+    BOOST_CHECK(queue.Enqueue(new TestWorkItem(3), HTTPWorkLane::WALLET));
+    BOOST_CHECK(queue.Enqueue(new TestWorkItem(4), HTTPWorkLane::HEAVY));
+
+    // Full lanes reject items, the others still take them
+    std::unique_ptr<TestWorkItem> itemRejected(new TestWorkItem(5));
+    BOOST_CHECK(!queue.Enqueue(itemRejected.get(), HTTPWorkLane::CHEAP));
+    BOOST_CHECK(queue.Enqueue(new TestWorkItem(6), HTTPWorkLane::WALLET));
+
+    BOOST_CHECK_EQUAL(TakeNumber(queue, HTTPWorkLane::HEAVY), 4);
+    BOOST_CHECK_EQUAL(TakeNumber(queue, HTTPWorkLane::HEAVY), 3);
+    BOOST_CHECK_EQUAL(TakeNumber(queue, HTTPWorkLane::CHEAP), 1);
+    BOOST_CHECK_EQUAL(TakeNumber(queue, HTTPWorkLane::WALLET), 6);
+    BOOST_CHECK_EQUAL(TakeNumber(queue, HTTPWorkLane::WALLET), 2);
+    BOOST_CHECK_EQUAL(TakeNumber(queue, HTTPWorkLane::HEAVY), -1);
+
+    // A cheap worker leaves the heavier lanes alone
+    BOOST_CHECK(queue.Enqueue(new TestWorkItem(7), HTTPWorkLane::HEAVY));
+    BOOST_CHECK(queue.Enqueue(new TestWorkItem(8), HTTPWorkLane::WALLET));
+    BOOST_CHECK_EQUAL(TakeNumber(queue, HTTPWorkLane::CHEAP), -1);
+    BOOST_CHECK_EQUAL(TakeNumber(queue, HTTPWorkLane::WALLET), 8);
+    BOOST_CHECK_EQUAL(TakeNumber(queue, HTTPWorkLane::WALLET), -1);
+    BOOST_CHECK_EQUAL(TakeNumber(queue, HTTPWorkLane::HEAVY), 7);
+}
+
+// A waiting worker is woken for a lane it may run and runs it, while an item
+// of a heavier lane stays queued
+BOOST_AUTO_TEST_CASE(work_queue_run_lighter_lane)
+{
+    const std::array<size_t, HTTP_WORK_LANES> depths{{4, 4, 4}};
+    TestWorkQueue queue(depths);
+    std::thread worker([&queue] { queue.Run(HTTPWorkLane::WALLET); });
+
+    std::promise<void> ranCheap;
+    BOOST_CHECK(queue.Enqueue(new TestWorkItem(1), HTTPWorkLane::HEAVY));
+    BOOST_CHECK(queue.Enqueue(new TestWorkItem(2, [&ranCheap] { ranCheap.set_value(); }), HTTPWorkLane::CHEAP));
+    BOOST_CHECK(ranCheap.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+
+    queue.Interrupt();
+    worker.join();
+    BOOST_CHECK_EQUAL(TakeNumber(queue, HTTPWorkLane::HEAVY), 1);
+}
+
+// A request goes to the lane of its method and a batch to the heaviest lane of
+// its methods, whatever the whitespace around the method key
+BOOST_AUTO_TEST_CASE(classify_requests)
+{
+    ResetArgs("-rpclane=getblockcount:wallet -rpclane=scantxoutset:cheap");
+    std::string strError;
+    BOOST_REQUIRE(InitRPCMethodLanes(strError));
+
+    BOOST_CHECK(GetJSONRPCRequestLane("") == HTTPWorkLane::CHEAP);
+    BOOST_CHECK(GetJSONRPCRequestLane("{\"method\":\"getbestblockhash\",\"params\":[]}") == HTTPWorkLane::CHEAP);
+    BOOST_CHECK(GetJSONRPCRequestLane("{\"method\":\"nosuchmethod\"}") == HTTPWorkLane::CHEAP);
+    BOOST_CHECK(GetJSONRPCRequestLane("{\"method\":\"getblockcount\"}") == HTTPWorkLane::WALLET);
+    BOOST_CHECK(GetJSONRPCRequestLane("{\"method\" :\r\n \"rescanblockchain\"}") == HTTPWorkLane::HEAVY);
+    BOOST_CHECK(GetJSONRPCRequestLane("{\"method\":\"scantxoutset\"}") == HTTPWorkLane::CHEAP);
+
+    // Only "method" keys count, not values that happen to name a method
+    BOOST_CHECK(GetJSONRPCRequestLane("{\"method\":\"getbestblockhash\",\"params\":[\"method\",\"rescanblockchain\"]}") == HTTPWorkLane::CHEAP);
+    BOOST_CHECK(GetJSONRPCRequestLane("{\"params\":{\"method\":1},\"method\":\"getblockcount\"}") == HTTPWorkLane::WALLET);
+
+    BOOST_CHECK(GetJSONRPCRequestLane("[{\"method\":\"getbestblockhash\"},{\"method\":\"getblockcount\"}]") == HTTPWorkLane::WALLET);
+    BOOST_CHECK(GetJSONRPCRequestLane("[{\"method\":\"rescanblockchain\"},{\"method\":\"getblockcount\"}]") == HTTPWorkLane::HEAVY);
+    // A method cut off by the end of the peeked body is ignored
+    BOOST_CHECK(GetJSONRPCRequestLane("[{\"method\":\"getblockcount\"},{\"method\":\"rescanbl") == HTTPWorkLane::WALLET);
+
+    ResetArgs("-rpclane=getblockcount");
+    BOOST_CHECK(!InitRPCMethodLanes(strError));
+    ResetArgs("-rpclane=getblockcount:fast");
+    BOOST_CHECK(!InitRPCMethodLanes(strError));
+}
+
+BOOST_AUTO_TEST_CASE(lane_depths)
+{
+    std::array<size_t, HTTP_WORK_LANES> depths;
+    std::string strError;
+
+    ResetArgs("");
+    BOOST_CHECK(GetHTTPWorkLaneDepths(depths, strError));
+    BOOST_CHECK(depths == (std::array<size_t, HTTP_WORK_LANES>{{DEFAULT_HTTP_WORKQUEUE, DEFAULT_HTTP_WORKQUEUE, DEFAULT_HTTP_WORKQUEUE}}));
+
+    ResetArgs("-rpcworkqueue=32 -rpclanedepth=heavy:2 -rpclanedepth=cheap:64");
+    BOOST_CHECK(GetHTTPWorkLaneDepths(depths, strError));
+    BOOST_CHECK(depths == (std::array<size_t, HTTP_WORK_LANES>{{64, 32, 2}}));
+
+    for (const char* strArg : {"-rpclanedepth=heavy", "-rpclanedepth=slow:2", "-rpclanedepth=heavy:0", "-rpclanedepth=heavy:x"}) {
+        ResetArgs(strArg);
+        BOOST_CHECK(!GetHTTPWorkLaneDepths(depths, strError));
+    }
+}
+
+// Lanes that aren't set leave the wallet lane the threads the others don't use
+BOOST_AUTO_TEST_CASE(lane_threads)
+{
+    typedef std::array<int, HTTP_WORK_LANES> Threads_t;
+    BOOST_CHECK(Threads("") == (Threads_t{{1, DEFAULT_HTTP_THREADS - 2, 1}}));
+    BOOST_CHECK(Threads("-rpcthreads=16") == (Threads_t{{1, 14, 1}}));
+    BOOST_CHECK(Threads("-rpcthreads=8 -rpclanethreads=heavy:3") == (Threads_t{{1, 4, 3}}));
+    BOOST_CHECK(Threads("-rpcthreads=8 -rpclanethreads=cheap:4") == (Threads_t{{4, 3, 1}}));
+    BOOST_CHECK(Threads("-rpcthreads=8 -rpclanethreads=wallet:2") == (Threads_t{{5, 2, 1}}));
+    BOOST_CHECK(Threads("-rpcthreads=8 -rpclanethreads=wallet:2 -rpclanethreads=cheap:2") == (Threads_t{{2, 2, 1}}));
+
+    // Every lane has a worker, even with fewer -rpcthreads
+    BOOST_CHECK(Threads("-rpcthreads=1") == (Threads_t{{1, 1, 1}}));
+
+    std::array<int, HTTP_WORK_LANES> threads;
+    std::string strError;
+    for (const char* strArg : {"-rpclanethreads=wallet", "-rpclanethreads=slow:2", "-rpclanethreads=wallet:0"}) {
+        ResetArgs(strArg);
+        BOOST_CHECK(!GetHTTPWorkLaneThreads(threads, strError));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,148 @@
+// Copyright (c) 2026 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Tests for the RingCT index cache and key image filter in front of the block
+// database, and the batched key image lookups used by consensus and the light
+// wallet RPCs.
+
+#include <test/test_veil.h>
+
+#include <key.h>
+#include <txdb.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+CCmpPubKey NewKeyImage()
+{
+    CKey key;
+    key.MakeNewKey(true);
+    return CCmpPubKey(key.GetPubKey());
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(keyimage_tests, TestingSetup)
+
+// A Bloom filter may answer "maybe" for anything, but never "no" for a key
+// image that was inserted.
+BOOST_AUTO_TEST_CASE(filter_has_no_false_negatives)
+{
+    CKeyImageFilter filter;
+    filter.Reset(1000);
+
+    std::vector<CCmpPubKey> vInserted;
+    for (int i = 0; i < 1000; i++) {
+        vInserted.emplace_back(NewKeyImage());
+        filter.Insert(vInserted.back());
+    }
+    for (const CCmpPubKey& ki : vInserted)
+        BOOST_CHECK(filter.MaybeContains(ki));
+    BOOST_CHECK_EQUAL(filter.GetInserted(), 1000U);
+
+    int nFalsePositives = 0;
+    for (int i = 0; i < 1000; i++)
+        nFalsePositives += filter.MaybeContains(NewKeyImage());
+    BOOST_CHECK(nFalsePositives < 10);
+}
+
+// Flushed and pending key images, and erasures of both, are consistent with
+// what the filter lets through.
+BOOST_AUTO_TEST_CASE(blocktree_keyimage_lookups)
+{
+    const CCmpPubKey kiBefore = NewKeyImage();
+    const uint256 txBefore = InsecureRand256();
+    BOOST_REQUIRE(pblocktree->WriteRCTKeyImage(kiBefore, txBefore));
+    BOOST_REQUIRE(pblocktree->FlushRCTCache(InsecureRand256()));
+
+    // Key images flushed before the filter is loaded are picked up by the scan
+    BOOST_REQUIRE(pblocktree->LoadRCTKeyImageFilter());
+
+    // Only in the cache
+    const CCmpPubKey kiAfter = NewKeyImage();
+    const uint256 txAfter = InsecureRand256();
+    BOOST_REQUIRE(pblocktree->WriteRCTKeyImage(kiAfter, txAfter));
+
+    const CCmpPubKey kiUnspent = NewKeyImage();
+    uint256 txhash;
+    BOOST_CHECK(pblocktree->ReadRCTKeyImage(kiBefore, txhash) && txhash == txBefore);
+    BOOST_CHECK(pblocktree->ReadRCTKeyImage(kiAfter, txhash) && txhash == txAfter);
+    BOOST_CHECK(!pblocktree->ReadRCTKeyImage(kiUnspent, txhash));
+
+    std::map<CCmpPubKey, uint256> mapSpent;
+    pblocktree->ReadRCTKeyImages({kiBefore, kiUnspent, kiAfter, kiAfter}, mapSpent);
+    BOOST_CHECK_EQUAL(mapSpent.size(), 2U);
+    BOOST_CHECK(mapSpent[kiBefore] == txBefore);
+    BOOST_CHECK(mapSpent[kiAfter] == txAfter);
+
+    BOOST_REQUIRE(pblocktree->FlushRCTCache(InsecureRand256()));
+    BOOST_CHECK(pblocktree->ReadRCTKeyImage(kiAfter, txhash) && txhash == txAfter);
+
+    // A pending erasure hides the key image on disk, and removes it once flushed.
+    // Erased key images stay in the filter but the database has the final say.
+    BOOST_REQUIRE(pblocktree->EraseRCTKeyImage(kiBefore));
+    BOOST_CHECK(!pblocktree->ReadRCTKeyImage(kiBefore, txhash));
+    BOOST_REQUIRE(pblocktree->FlushRCTCache(InsecureRand256()));
+    BOOST_CHECK(!pblocktree->ReadRCTKeyImage(kiBefore, txhash));
+    mapSpent.clear();
+    pblocktree->ReadRCTKeyImages({kiBefore, kiAfter}, mapSpent);
+    BOOST_CHECK_EQUAL(mapSpent.size(), 1U);
+    BOOST_CHECK(mapSpent.count(kiAfter));
+}
+
+BOOST_AUTO_TEST_CASE(blocktree_rct_cache_flush)
+{
+    BOOST_CHECK(pblocktree->ReadRCTBestBlock().IsNull());
+
+    const CCmpPubKey pk = NewKeyImage();
+    COutPoint op(InsecureRand256(), 1);
+    CAnonOutput ao(pk, secp256k1_pedersen_commitment(), op, 10, 0);
+    BOOST_REQUIRE(pblocktree->WriteRCTOutput(1, ao));
+    BOOST_REQUIRE(pblocktree->WriteRCTOutputLink(pk, 1));
+    BOOST_CHECK(pblocktree->RCTCacheDynamicMemoryUsage() > 0);
+
+    // Nothing has reached the disk yet
+    int64_t nIndex;
+    BOOST_CHECK(!pblocktree->Exists(std::make_pair(DB_RCTOUTPUT_LINK, pk)));
+    BOOST_CHECK(pblocktree->ReadRCTOutputLink(pk, nIndex) && nIndex == 1);
+
+    const uint256 hashBestBlock = InsecureRand256();
+    BOOST_REQUIRE(pblocktree->FlushRCTCache(hashBestBlock));
+    BOOST_CHECK(pblocktree->ReadRCTBestBlock() == hashBestBlock);
+    BOOST_CHECK(pblocktree->Exists(std::make_pair(DB_RCTOUTPUT_LINK, pk)));
+
+    CAnonOutput aoRead;
+    BOOST_CHECK(pblocktree->ReadRCTOutput(1, aoRead) && aoRead.outpoint == op && aoRead.pubkey == pk);
+
+    BOOST_REQUIRE(pblocktree->EraseRCTOutput(1));
+    BOOST_REQUIRE(pblocktree->EraseRCTOutputLink(pk));
+    BOOST_CHECK(!pblocktree->ReadRCTOutput(1, aoRead));
+    BOOST_CHECK(!pblocktree->ReadRCTOutputLink(pk, nIndex));
+    BOOST_REQUIRE(pblocktree->FlushRCTCache(hashBestBlock));
+    BOOST_CHECK(!pblocktree->Exists(std::make_pair(DB_RCTOUTPUT, (int64_t)1)));
+}
+
+BOOST_AUTO_TEST_CASE(mempool_keyimage_lookups)
+{
+    CTxMemPool pool;
+    const CCmpPubKey kiSpent = NewKeyImage();
+    const uint256 txSpent = InsecureRand256();
+    {
+        LOCK(pool.cs);
+        pool.mapKeyImages[kiSpent] = txSpent;
+    }
+
+    std::map<CCmpPubKey, uint256> mapSpent;
+    pool.HaveKeyImages({NewKeyImage(), kiSpent}, mapSpent);
+    BOOST_CHECK_EQUAL(mapSpent.size(), 1U);
+    BOOST_CHECK(mapSpent[kiSpent] == txSpent);
+
+    uint256 txhash;
+    BOOST_CHECK(pool.HaveKeyImage(kiSpent, txhash) && txhash == txSpent);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -531,4 +531,40 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
 }
 */
 
+// A cached template only has to be rebuilt when one of its transactions leaves the mempool
+BOOST_AUTO_TEST_CASE(BlockTemplateTracker_invalidation)
+{
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+    BlockTemplateTracker tracker(pool);
+    BOOST_CHECK(tracker.IsInvalid());
+
+    CMutableTransaction txs[3];
+    for (int i = 0; i < 3; i++) {
+        txs[i].vin.resize(1);
+        txs[i].vin[0].scriptSig = CScript() << OP_11;
+        txs[i].vin[0].prevout.hash = InsecureRand256();
+        txs[i].vpout.push_back(MAKE_OUTPUT<CTxOutStandard>(11000LL, CScript() << OP_11 << OP_EQUAL));
+    }
+
+    LOCK(pool.cs);
+    pool.addUnchecked(txs[0].GetHash(), entry.FromTx(txs[0]));
+    pool.addUnchecked(txs[1].GetHash(), entry.FromTx(txs[1]));
+
+    CBlock block;
+    block.vtx.emplace_back(MakeTransactionRef(txs[0]));
+    tracker.Reset(block);
+    BOOST_CHECK(!tracker.IsInvalid());
+    BOOST_CHECK_EQUAL(tracker.GetAdded(), 0U);
+
+    // New and removed transactions outside the template only make it stale
+    pool.addUnchecked(txs[2].GetHash(), entry.FromTx(txs[2]));
+    pool.removeRecursive(txs[1]);
+    BOOST_CHECK(!tracker.IsInvalid());
+    BOOST_CHECK_EQUAL(tracker.GetAdded(), 1U);
+
+    pool.removeRecursive(txs[0]);
+    BOOST_CHECK(tracker.IsInvalid());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
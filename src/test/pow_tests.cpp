@@ -87,4 +87,102 @@ BOOST_AUTO_TEST_CASE(GetBlockProofEquivalentTime_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(block_index_pow_hash_cache)
+{
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.hashVeilData = InsecureRand256();
+    header.hashMerkleRoot = InsecureRand256();
+    header.nTime = 1600000000;
+    header.nBits = 0x207fffff;
+    header.nNonce = 42;
+
+    const uint256 hashBlock = header.GetHash();
+    CBlockIndex index(header);
+    BOOST_CHECK(!index.powHashCache.entry);
+
+    // Not in mapBlockIndex, its header could still change, so nothing is cached
+    BOOST_CHECK(index.GetX16RTPoWHash() == header.GetX16RTPoWHash());
+    BOOST_CHECK(!index.powHashCache.entry);
+
+    index.phashBlock = &hashBlock;
+    const uint256 hashPoW = index.GetX16RTPoWHash();
+    BOOST_CHECK(hashPoW == header.GetX16RTPoWHash());
+    BOOST_REQUIRE(index.powHashCache.entry);
+    BOOST_CHECK(index.powHashCache.entry->hash == hashPoW);
+    BOOST_CHECK(index.GetX16RTPoWHash() == hashPoW);
+
+    // The block's own algorithm is still cached after stake modifier sampling took its X16RT hash
+    BOOST_CHECK(!index.powHashCache.Find(CPoWHashCache::SHA256D));
+    const uint256 hashSha256D = index.GetSha256DPowHash();
+    BOOST_CHECK(hashSha256D == header.GetSha256DPoWHash());
+    const CPoWHashCache::Entry* entrySha256D = index.powHashCache.Find(CPoWHashCache::SHA256D);
+    BOOST_REQUIRE(entrySha256D);
+    BOOST_CHECK(entrySha256D->hash == hashSha256D);
+    BOOST_CHECK(index.GetSha256DPowHash() == hashSha256D);
+    BOOST_CHECK(index.powHashCache.Find(CPoWHashCache::SHA256D) == entrySha256D);
+    const CPoWHashCache::Entry* entryX16RT = index.powHashCache.Find(CPoWHashCache::X16RT);
+    BOOST_REQUIRE(entryX16RT);
+    BOOST_CHECK(entryX16RT->hash == hashPoW);
+
+    BOOST_CHECK(index.GetX16RTPoWHash(true) == header.GetX16RTPoWHash(true));
+    BOOST_CHECK(index.powHashCache.Find(CPoWHashCache::X16RT_NULL_VEILDATA));
+    BOOST_CHECK(index.powHashCache.Find(CPoWHashCache::X16RT) == entryX16RT);
+
+    // Copies start out empty
+    CBlockIndex indexCopy(index);
+    BOOST_CHECK(!indexCopy.powHashCache.entry);
+    BOOST_CHECK(indexCopy.GetSha256DPowHash() == header.GetSha256DPoWHash());
+    BOOST_REQUIRE(indexCopy.powHashCache.entry);
+    BOOST_CHECK(indexCopy.powHashCache.entry->algo == CPoWHashCache::SHA256D);
+    BOOST_CHECK(!indexCopy.powHashCache.Find(CPoWHashCache::X16RT));
+}
+
+BOOST_AUTO_TEST_CASE(dgw_algo_links)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    const int64_t nSwitchTime = Params().PowUpdateTimestamp();
+    const int32_t algos[] = {CBlockHeader::PROGPOW_BLOCK, CBlockHeader::RANDOMX_BLOCK, CBlockHeader::SHA256D_BLOCK};
+
+    // A mixed chain that starts before the switchover, with runs of every block class
+    std::vector<CBlockIndex> blocks(3000);
+    for (size_t i = 0; i < blocks.size(); i++) {
+        blocks[i].pprev = i ? &blocks[i - 1] : nullptr;
+        blocks[i].nHeight = i;
+        blocks[i].nTime = nSwitchTime - 200 * 60 + i * 60 + InsecureRandRange(30);
+        blocks[i].nBits = 0x1d00ffff - InsecureRandRange(0x10000);
+        if (InsecureRandRange(3) == 0)
+            blocks[i].SetProofOfStake();
+        else if (blocks[i].GetBlockTime() >= nSwitchTime && i % 500 > 50)
+            blocks[i].nVersion = algos[InsecureRandRange(3)];
+        blocks[i].BuildAlgoLinks();
+        BOOST_CHECK(blocks[i].fHaveAlgoLinks);
+    }
+
+    // Each link is the nearest predecessor of its class
+    for (size_t i = 1; i < blocks.size(); i++) {
+        for (int c = 0; c < CBlockIndex::ALGO_LINK_COUNT; c++) {
+            const CBlockIndex* pindex = blocks[i].pprev;
+            while (pindex && !pindex->IsAlgoLinkTarget(c))
+                pindex = pindex->pprev;
+            BOOST_CHECK(blocks[i].pprevAlgo[c] == pindex);
+        }
+    }
+
+    // And walking them gives the same difficulty as walking every block
+    std::vector<std::pair<bool, int>> vTypes = {{true, 0}, {false, 0}};
+    for (int32_t nAlgo : algos)
+        vTypes.emplace_back(false, nAlgo);
+    for (size_t i = 200; i < blocks.size(); i += 37) {
+        for (const auto& type : vTypes) {
+            for (auto& block : blocks)
+                block.fHaveAlgoLinks = true;
+            unsigned int nBitsLinked = DarkGravityWave(&blocks[i], params, type.first, type.second);
+            for (auto& block : blocks)
+                block.fHaveAlgoLinks = false;
+            BOOST_CHECK_EQUAL(nBitsLinked, DarkGravityWave(&blocks[i], params, type.first, type.second));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
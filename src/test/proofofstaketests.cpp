@@ -17,6 +17,7 @@
 #include <script/standard.h>
 #include <key_io.h>
 #include <veil/zerocoin/accumulators.h>
+#include <veil/proofofstake/stakeinput.h>
 
 
 BOOST_FIXTURE_TEST_SUITE(proofofstake_tests, BasicTestingSetup)
@@ -151,4 +152,54 @@ BOOST_AUTO_TEST_CASE(proofofstake_block)
 
 }
 
+// The modifier is cached on the index, but not while a sampled PoS block has no PoS hash yet
+BOOST_AUTO_TEST_CASE(stake_modifier_cache)
+{
+    std::vector<CBlockIndex> vIndex(200);
+    for (size_t i = 0; i < vIndex.size(); i++) {
+        vIndex[i].nHeight = i;
+        vIndex[i].pprev = i ? &vIndex[i - 1] : nullptr;
+        vIndex[i].fProofOfStake = true;
+        vIndex[i].SetPoSHash(InsecureRand256());
+        vIndex[i].BuildSkip();
+    }
+    CBlockIndex& indexPrev = vIndex.back();
+    CBlockIndex& indexSample = vIndex[indexPrev.nHeight - 100];
+
+    // Samples without a PoS hash are used as null hashes, and nothing depending on them is cached
+    const uint256 hashProof = indexSample.GetBlockPoSHash();
+    indexSample.vHashProof.clear();
+    uint64_t nModifierNoProof;
+    BOOST_REQUIRE(GetStakeModifier(nModifierNoProof, indexPrev));
+    {
+        LOCK(cs_stakeModifierCache);
+        BOOST_CHECK(!indexPrev.stakeModifierCache.fModifier);
+        BOOST_CHECK(!indexSample.stakeModifierCache.fSampleHash);
+    }
+
+    indexSample.SetPoSHash(hashProof);
+    uint64_t nModifier;
+    BOOST_REQUIRE(GetStakeModifier(nModifier, indexPrev));
+    BOOST_CHECK(nModifier != nModifierNoProof);
+    {
+        LOCK(cs_stakeModifierCache);
+        BOOST_CHECK(indexPrev.stakeModifierCache.fModifier);
+        BOOST_CHECK(indexSample.stakeModifierCache.fSampleHash);
+    }
+
+    // Cached modifiers don't look at the samples again
+    vIndex[indexPrev.nHeight - 106].SetPoSHash(InsecureRand256());
+    uint64_t nModifierCached;
+    BOOST_REQUIRE(GetStakeModifier(nModifierCached, indexPrev));
+    BOOST_CHECK_EQUAL(nModifierCached, nModifier);
+
+    // A copy starts out with an empty cache
+    CBlockIndex indexCopy(indexPrev);
+    BOOST_CHECK(!indexCopy.stakeModifierCache.fModifier);
+
+    // Too short a chain has no modifier
+    uint64_t nModifierShort;
+    BOOST_CHECK(!GetStakeModifier(nModifierShort, vIndex[150]));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
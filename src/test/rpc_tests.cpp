@@ -16,7 +16,11 @@
 
 #include <univalue.h>
 
+#include <chainparams.h>
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
+#include <validation.h>
+#include <veil/validationstats.h>
 
 UniValue CallRPC(std::string args)
 {
@@ -416,4 +420,130 @@ BOOST_AUTO_TEST_CASE(rpc_getblockstats_calculate_percentiles_by_weight)
     }
 }
 
+BOOST_AUTO_TEST_CASE(rpc_getperfstats_locks)
+{
+    CCriticalSection cs_profiled;
+    g_lock_profiling = true;
+    {
+        LOCK(cs_profiled);
+    }
+    {
+        LOCK(cs_profiled);
+    }
+    g_lock_profiling = false;
+    {
+        LOCK(cs_profiled);
+    }
+
+    UniValue r = CallRPC("getperfstats true");
+    BOOST_CHECK_EQUAL(find_value(r.get_obj(), "lockprofiling").get_bool(), false);
+    int nSites = 0;
+    for (const UniValue& site : find_value(r.get_obj(), "locks").getValues()) {
+        if (find_value(site, "lock").get_str() != "cs_profiled")
+            continue;
+        nSites++;
+        BOOST_CHECK_EQUAL(find_value(site, "count").get_int(), 1);
+        BOOST_CHECK_EQUAL(find_value(site, "contended").get_int(), 0);
+    }
+    // Two sites entered once each while profiling, the third one wasn't profiled
+    BOOST_CHECK_EQUAL(nSites, 2);
+
+    // The stats were reset
+    r = CallRPC("getperfstats");
+    BOOST_CHECK(find_value(r.get_obj(), "locks").empty());
+}
+
+BOOST_AUTO_TEST_CASE(rpc_getvalidationstats)
+{
+    CallRPC("getvalidationstats true");
+    RecordValidationStage(ValidationStage::MLSAG, 50);
+    RecordValidationStage(ValidationStage::MLSAG, 2000);
+    RecordValidationStage(ValidationStage::MLSAG, 4000);
+
+    UniValue r = CallRPC("getvalidationstats");
+    const UniValue& mlsag = find_value(r.get_obj(), "mlsag");
+    BOOST_CHECK_EQUAL(find_value(mlsag, "samples").get_int(), 3);
+    BOOST_CHECK_EQUAL(find_value(mlsag, "max_ms").get_real(), 4.0);
+    const UniValue& recent = find_value(mlsag, "recent");
+    BOOST_CHECK_EQUAL(find_value(recent, "p50_ms").get_real(), 2.0);
+    const UniValue& histogram = find_value(recent, "histogram");
+    BOOST_CHECK_EQUAL(find_value(histogram, "<=0.1ms").get_int(), 1);
+    BOOST_CHECK_EQUAL(find_value(histogram, "<=10ms").get_int(), 2);
+    BOOST_CHECK_EQUAL(find_value(find_value(r.get_obj(), "flushview"), "samples").get_int(), 0);
+
+    // Timers only record while a block is being connected
+    {
+        ValidationStatsScope scope(false);
+        ValidationStageTimer timer(ValidationStage::RANGEPROOF);
+    }
+    {
+        ValidationStageTimer timer(ValidationStage::RANGEPROOF);
+    }
+    BOOST_CHECK_EQUAL(GetValidationStageStats(ValidationStage::RANGEPROOF).nSamples, 0U);
+    {
+        ValidationStatsScope scope(true);
+        ValidationStageTimer timer(ValidationStage::RANGEPROOF);
+    }
+    BOOST_CHECK_EQUAL(GetValidationStageStats(ValidationStage::RANGEPROOF).nSamples, 1U);
+}
+
+BOOST_AUTO_TEST_CASE(rpc_json_stream_writer)
+{
+    UniValue inner(UniValue::VOBJ);
+    inner.pushKV("a\"b", 1);
+    inner.pushKV("c", UniValue(UniValue::VARR));
+
+    std::vector<std::string> vParts;
+    JSONStreamWriter writer([&](const std::string& strPart) { vParts.push_back(strPart); }, 8);
+    BOOST_CHECK(writer.ExpectsValue());
+    writer.BeginObject();
+    writer.Key("x");
+    BOOST_CHECK(writer.ExpectsValue());
+    writer.BeginArray();
+    writer.Value(inner);
+    writer.Value("str");
+    writer.BeginObject();
+    writer.EndObject();
+    writer.EndArray();
+    BOOST_CHECK(!writer.ExpectsValue());
+    writer.Key("y");
+    writer.Value(NullUniValue);
+    writer.EndObject();
+    writer.Flush();
+    BOOST_CHECK(!writer.ExpectsValue());
+
+    UniValue arr(UniValue::VARR);
+    arr.push_back(inner);
+    arr.push_back("str");
+    arr.push_back(UniValue(UniValue::VOBJ));
+    UniValue expected(UniValue::VOBJ);
+    expected.pushKV("x", arr);
+    expected.pushKV("y", NullUniValue);
+
+    // The output is passed on in parts once it grows past the flush size
+    BOOST_CHECK(vParts.size() > 1);
+    BOOST_CHECK_EQUAL(boost::algorithm::join(vParts, ""), expected.write());
+}
+
+BOOST_AUTO_TEST_CASE(rpc_block_to_json_stream)
+{
+    CBlock block;
+    const CBlockIndex* pindex;
+    const CBlockIndex* tip;
+    {
+        LOCK(cs_main);
+        pindex = chainActive.Genesis();
+        tip = chainActive.Tip();
+    }
+    BOOST_REQUIRE(ReadBlockFromDisk(block, pindex, Params().GetConsensus()));
+
+    for (bool txDetails : {false, true}) {
+        std::string strStreamed;
+        JSONStreamWriter writer([&](const std::string& strPart) { strStreamed += strPart; });
+        blockToJSONStream(writer, block, tip, pindex, txDetails);
+        writer.Flush();
+        BOOST_CHECK_EQUAL(strStreamed, blockToJSON(block, tip, pindex, txDetails).write());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <chain.h>
+#include <chainparams.h>
 #include <util/system.h>
 #include <test/test_veil.h>
 
@@ -177,4 +178,64 @@ BOOST_AUTO_TEST_CASE(findearliestatleast_edge_test)
     BOOST_CHECK(!chain.FindEarliestAtLeast(int64_t(std::numeric_limits<unsigned int>::max()) + 1));
 }
 
+BOOST_AUTO_TEST_CASE(chain_algo_stats_test)
+{
+    const int32_t algos[] = {CBlockHeader::PROGPOW_BLOCK, CBlockHeader::RANDOMX_BLOCK, CBlockHeader::SHA256D_BLOCK};
+    auto MakeChain = [&algos](std::vector<CBlockIndex>& blocks, CBlockIndex* pfork) {
+        for (size_t i = 0; i < blocks.size(); i++) {
+            CBlockIndex* prev = i ? &blocks[i - 1] : pfork;
+            blocks[i].pprev = prev;
+            blocks[i].nHeight = prev ? prev->nHeight + 1 : 0;
+            blocks[i].nTime = Params().PowUpdateTimestamp() - 300 * 60 + blocks[i].nHeight * 60;
+            blocks[i].nBits = 0x1d00ffff - InsecureRandRange(0x10000);
+            if (InsecureRandBool())
+                blocks[i].SetProofOfStake();
+            else if (blocks[i].GetBlockTime() >= Params().PowUpdateTimestamp())
+                blocks[i].nVersion = algos[InsecureRandRange(3)];
+        }
+    };
+    std::vector<CBlockIndex> vBlocksMain(1000);
+    MakeChain(vBlocksMain, nullptr);
+    std::vector<CBlockIndex> vBlocksSide(400);
+    MakeChain(vBlocksSide, &vBlocksMain[699]);
+
+    auto CheckRanges = [](const CChain& chain) {
+        for (int i = 0; i < 100; i++) {
+            int nStart = InsecureRandRange(chain.Height() + 1);
+            int nEnd = nStart + InsecureRandRange(chain.Height() + 1 - nStart);
+            CChainAlgoStats expected;
+            for (int nHeight = nStart; nHeight <= nEnd; nHeight++)
+                expected.Add(chain[nHeight]);
+
+            CChainAlgoStats stats;
+            BOOST_REQUIRE(chain.GetAlgoStats(nStart, nEnd, stats));
+            for (int j = 0; j < CChainAlgoStats::COUNT; j++) {
+                BOOST_CHECK_EQUAL(stats.nBlocks[j], expected.nBlocks[j]);
+                BOOST_CHECK(stats.nWork[j] == expected.nWork[j]);
+            }
+        }
+        CChainAlgoStats stats;
+        BOOST_CHECK(!chain.GetAlgoStats(0, chain.Height() + 1, stats));
+        BOOST_CHECK(!chain.GetAlgoStats(2, 1, stats));
+    };
+
+    // Sums stay correct as the tip moves to a longer fork, back, and below the fork
+    CChain chain;
+    chain.SetTip(&vBlocksMain.back());
+    CheckRanges(chain);
+    chain.SetTip(&vBlocksSide.back());
+    CheckRanges(chain);
+    chain.SetTip(&vBlocksMain.back());
+    CheckRanges(chain);
+    chain.SetTip(&vBlocksMain[300]);
+    CheckRanges(chain);
+
+    CChainAlgoStats stats;
+    BOOST_REQUIRE(chain.GetAlgoStats(0, chain.Height(), stats));
+    int nTotal = 0;
+    for (int j = 0; j < CChainAlgoStats::COUNT; j++)
+        nTotal += stats.nBlocks[j];
+    BOOST_CHECK_EQUAL(nTotal, 301);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
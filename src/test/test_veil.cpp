@@ -17,6 +17,7 @@
 #include <rpc/server.h>
 #include <rpc/register.h>
 #include <script/sigcache.h>
+#include <veil/ringct/blind.h>
 
 void CConnmanTest::AddNode(CNode& node)
 {
@@ -50,6 +51,7 @@ BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
     SHA256AutoDetect();
     RandomInit();
     ECC_Start();
+    ECC_Start_Blinding();
     SetupEnvironment();
     SetupNetworking();
     InitSignatureCache();
@@ -62,6 +64,7 @@ BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
 BasicTestingSetup::~BasicTestingSetup()
 {
     fs::remove_all(m_path_root);
+    ECC_Stop_Blinding();
     ECC_Stop();
 }
 
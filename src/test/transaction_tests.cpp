@@ -286,6 +286,74 @@ BOOST_AUTO_TEST_CASE(basic_transaction_tests)
     BOOST_CHECK_MESSAGE(!CheckTransaction(tx, state) || !state.IsValid(), "Transaction with duplicate txins should be invalid.");
 }
 
+BOOST_AUTO_TEST_CASE(output_arena_roundtrip)
+{
+    // Enough outputs of every type to span several arena chunks
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    const size_t nOutputs = CTxOutArena::MAX_CHUNK_OUTPUTS * 2 + 3;
+    for (size_t i = 0; i < nOutputs; i++) {
+        switch (i % 4) {
+            case 0:
+                mtx.vpout.push_back(MAKE_OUTPUT<CTxOutStandard>(i, CScript() << OP_TRUE));
+                break;
+            case 1: {
+                auto out = MAKE_OUTPUT<CTxOutCT>();
+                out->commitment.data[0] = 0x08;
+                out->vData.assign(33, i & 0xff);
+                out->scriptPubKey = CScript() << OP_TRUE;
+                out->vRangeproof.assign(64, 0x01);
+                mtx.vpout.push_back(out);
+                break;
+            }
+            case 2: {
+                auto out = MAKE_OUTPUT<CTxOutRingCT>();
+                out->commitment.data[0] = 0x09;
+                out->vData.assign(33, i & 0xff);
+                out->vRangeproof.assign(32, 0x02);
+                mtx.vpout.push_back(out);
+                break;
+            }
+            case 3: {
+                auto out = MAKE_OUTPUT<CTxOutData>();
+                CAmount nFee = i;
+                out->SetCTFee(nFee);
+                mtx.vpout.push_back(out);
+                break;
+            }
+        }
+    }
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << mtx;
+    const std::string strSerialized = ss.str();
+    CMutableTransaction mtxRead;
+    ss >> mtxRead;
+
+    CDataStream ssRead(SER_NETWORK, PROTOCOL_VERSION);
+    ssRead << mtxRead;
+    BOOST_CHECK(ssRead.str() == strSerialized);
+    BOOST_REQUIRE_EQUAL(mtxRead.vpout.size(), nOutputs);
+
+    for (size_t i = 0; i < nOutputs; i++) {
+        const CTxOutBaseRef& pout = mtxRead.vpout[i];
+        // All outputs share the reference count of their arena
+        BOOST_CHECK_EQUAL(pout.use_count(), (long)nOutputs);
+        BOOST_CHECK_EQUAL(pout->GetPCommitment() != nullptr, pout->IsType(OUTPUT_CT) || pout->IsType(OUTPUT_RINGCT));
+        BOOST_CHECK_EQUAL(pout->GetPScriptPubKey() != nullptr, pout->IsType(OUTPUT_STANDARD) || pout->IsType(OUTPUT_CT));
+    }
+    BOOST_CHECK_EQUAL(mtxRead.vpout[4]->GetValue(), 4);
+    BOOST_CHECK_EQUAL(mtxRead.vpout[5]->GetPCommitment()->data[0], 0x08);
+    BOOST_CHECK_EQUAL(mtxRead.vpout[6]->GetPRangeproof()->size(), 32U);
+    CAmount nFee;
+    BOOST_CHECK(mtxRead.vpout[7]->GetCTFee(nFee) && nFee == 7);
+
+    // A truncated transaction throws without leaking the outputs read so far
+    CDataStream ssTruncated(strSerialized.data(), strSerialized.data() + strSerialized.size() / 2, SER_NETWORK, PROTOCOL_VERSION);
+    CMutableTransaction mtxTruncated;
+    BOOST_CHECK_THROW(ssTruncated >> mtxTruncated, std::ios_base::failure);
+}
+
 //
 // Helper: create two dummy transactions, each with
 // two outputs.  The first has 11 and 50 CENT outputs
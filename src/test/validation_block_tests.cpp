@@ -14,9 +14,13 @@
 #include <validation.h>
 #include <validationinterface.h>
 #include <veil/budget.h>
+#include <veil/ringct/blind.h>
+#include <veil/validationstats.h>
 #include <script/standard.h>
 #include <key_io.h>
 
+#include <secp256k1_rangeproof.h>
+
 struct RegtestingSetup : public TestingSetup {
     RegtestingSetup() : TestingSetup(CBaseChainParams::REGTEST) {}
 };
@@ -179,4 +183,38 @@ BOOST_AUTO_TEST_CASE(processnewblock_signals_ordering)
     BOOST_CHECK_EQUAL(sub.m_expected_tip, chainActive.Tip()->GetBlockHash());
 }
 
+// Range proofs of a received block are verified by ProcessNewBlock's CheckBlock, ConnectBlock
+// only finds the block checked, so that is where they have to be timed
+BOOST_FIXTURE_TEST_CASE(rangeproof_stats, TestChain100Setup)
+{
+    const CAmount nValue = COIN;
+    uint8_t blind[32];
+    GetRandBytes(blind, 32);
+    auto out = MAKE_OUTPUT<CTxOutCT>();
+    BOOST_REQUIRE(secp256k1_pedersen_commit(secp256k1_ctx_blind, &out->commitment, blind, (uint64_t)nValue, secp256k1_generator_h));
+
+    uint64_t min_value = 0;
+    int ct_exponent = 2;
+    int ct_bits = 32;
+    BOOST_REQUIRE_EQUAL(SelectRangeProofParameters(nValue, min_value, ct_exponent, ct_bits), 0);
+    uint256 nonce = GetRandHash();
+    size_t nRangeProofLen = 5134;
+    out->vRangeproof.resize(nRangeProofLen);
+    BOOST_REQUIRE_EQUAL(secp256k1_rangeproof_sign(secp256k1_ctx_blind, out->vRangeproof.data(), &nRangeProofLen, min_value, &out->commitment,
+            blind, nonce.begin(), ct_exponent, ct_bits, nValue, nullptr, 0, nullptr, 0, secp256k1_generator_h), 1);
+    out->vRangeproof.resize(nRangeProofLen);
+    out->vData.assign(33, 0x02);
+    out->scriptPubKey = CScript() << OP_TRUE;
+
+    CMutableTransaction mtx;
+    mtx.vin.emplace_back(m_coinbase_txns[0]->GetHash(), 0);
+    mtx.vpout.push_back(out);
+
+    ResetValidationStats();
+    CreateAndProcessBlock({mtx}, CScript() << OP_TRUE);
+    BOOST_CHECK_GT(GetValidationStageStats(ValidationStage::RANGEPROOF).nSamples, 0U);
+    BOOST_CHECK_GT(GetValidationStageStats(ValidationStage::CHECK_BLOCK).nSamples, 0U);
+    ResetValidationStats();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
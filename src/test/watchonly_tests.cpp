@@ -8,8 +8,9 @@
 // transaction at index 0 with the stored count not including it (the count
 // only covers indices 1..count), permanently under-counting, while the
 // cached/bulk path was 1-based. The fixes make fresh writes 1-based and make
-// erasure probe index 0 so legacy layouts are swept completely and the
-// removed-count is truthful.
+// erasure sweep every stored index so legacy layouts are swept completely and
+// the removed-count is truthful. Transaction keys store the index big-endian
+// so a key's transactions can be read back in index order with one seek.
 
 #include <test/test_veil.h>
 
@@ -84,7 +85,7 @@ BOOST_AUTO_TEST_CASE(fresh_key_writes_one_based)
 }
 
 // Erasure must sweep a legacy layout completely: first transaction at index
-// 0, count not including it. The probe loop covers 0..count and the removed
+// 0, count not including it. Every stored index is erased and the removed
 // count reports what was actually erased.
 BOOST_AUTO_TEST_CASE(erase_sweeps_legacy_index0_layout)
 {
@@ -136,4 +137,54 @@ BOOST_AUTO_TEST_CASE(erase_one_based_layout)
     BOOST_CHECK(!GetWatchOnlyKeyCount(key, nCount));
 }
 
+// Range reads return exactly the requested indexes in order, across the byte
+// boundaries a little-endian key would scatter, and stop at the key's end.
+BOOST_AUTO_TEST_CASE(range_read_in_index_order)
+{
+    const CKey key = NewScanKey();
+    const CKey keyOther = NewScanKey();
+
+    std::vector<CWatchOnlyTx> vTxes;
+    for (int i = 0; i < 600; i++)
+        vTxes.emplace_back(MakeTx(key));
+    BOOST_REQUIRE(pwatchonlyDB->WriteBulkWatchOnlyTx(key, 0, vTxes));
+    BOOST_REQUIRE(pwatchonlyDB->WriteBulkWatchOnlyTx(keyOther, 0, {MakeTx(keyOther)}));
+
+    std::vector<std::pair<int, CWatchOnlyTx>> vRead;
+    BOOST_REQUIRE(ReadWatchOnlyTransactions(key, 250, 520, vRead));
+    BOOST_REQUIRE_EQUAL(vRead.size(), 271U);
+    for (size_t i = 0; i < vRead.size(); i++) {
+        BOOST_CHECK_EQUAL(vRead[i].first, 250 + (int)i);
+        BOOST_CHECK(vRead[i].second.tx_hash == vTxes[249 + i].tx_hash);
+    }
+
+    vRead.clear();
+    BOOST_REQUIRE(ReadWatchOnlyTransactions(key, 590, 2000, vRead));
+    BOOST_CHECK_EQUAL(vRead.size(), 11U);
+    BOOST_CHECK_EQUAL(vRead.back().first, 600);
+}
+
+// Transactions written under the little-endian V2 keys are moved to the V3
+// keys and can be range read afterwards.
+BOOST_AUTO_TEST_CASE(migrate_to_v3)
+{
+    const CKey key = NewScanKey();
+    std::vector<CWatchOnlyTx> vTxes;
+    for (int i = 0; i <= 300; i++) {
+        vTxes.emplace_back(MakeTx(key));
+        BOOST_REQUIRE(pwatchonlyDB->Write(std::make_pair('T', std::make_pair(key, i)), vTxes.back()));
+    }
+    BOOST_REQUIRE(pwatchonlyDB->SetDatabaseVersion(WATCHONLY_DB_VERSION_2));
+
+    BOOST_REQUIRE(pwatchonlyDB->MigrateToV3());
+    BOOST_CHECK_EQUAL(pwatchonlyDB->GetDatabaseVersion(), WATCHONLY_DB_VERSION_3);
+    BOOST_CHECK(!pwatchonlyDB->Exists(std::make_pair('T', std::make_pair(key, 0))));
+
+    std::vector<std::pair<int, CWatchOnlyTx>> vRead;
+    BOOST_REQUIRE(ReadWatchOnlyTransactions(key, 0, 300, vRead));
+    BOOST_REQUIRE_EQUAL(vRead.size(), vTxes.size());
+    for (size_t i = 0; i < vRead.size(); i++)
+        BOOST_CHECK(vRead[i].second.tx_hash == vTxes[i].tx_hash);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
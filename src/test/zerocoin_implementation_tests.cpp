@@ -18,6 +18,7 @@
 #include <wallet/deterministicmint.h>
 #include <veil/zerocoin/zwallet.h>
 #include <veil/zerocoin/accumulators.h>
+#include <veil/zerocoin/accumulatormap.h>
 #include "wallet/wallet.h"
 #include "veil/zerocoin/zchain.h"
 #include "consensus/tx_verify.h"
@@ -641,4 +642,30 @@ BOOST_AUTO_TEST_CASE(test_coinspendv4)
 
 
 
+BOOST_AUTO_TEST_CASE(accumulatormap_parallel_test)
+{
+    std::cout << "Running accumulatormap_parallel_test...\n";
+    std::list<PublicCoin> listPubcoins;
+    for (unsigned int i = 0; i < 6; i++) {
+        // Leave ZQ_TEN_THOUSAND unused
+        PrivateCoin c(Params().Zerocoin_Params(), zerocoinDenomList[i % 3], true);
+        listPubcoins.emplace_back(c.getPublicCoin());
+    }
+
+    AccumulatorMap mapSerial(Params().Zerocoin_Params());
+    for (const PublicCoin& pubcoin : listPubcoins)
+        BOOST_CHECK(mapSerial.Accumulate(pubcoin));
+
+    // Accumulating the denominations on separate threads gives the same checkpoints, with and without validation
+    for (bool fSkipValidation : {false, true}) {
+        AccumulatorMap mapParallel(Params().Zerocoin_Params());
+        BOOST_CHECK(mapParallel.Accumulate(listPubcoins, fSkipValidation));
+        BOOST_CHECK(mapParallel.GetCheckpoints(true) == mapSerial.GetCheckpoints(true));
+        BOOST_CHECK(mapParallel.GetCheckpoints(true).at(CoinDenomination::ZQ_TEN_THOUSAND).IsNull());
+    }
+
+    AccumulatorMap mapEmpty(Params().Zerocoin_Params());
+    BOOST_CHECK(mapEmpty.Accumulate(std::list<PublicCoin>()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
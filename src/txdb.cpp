@@ -38,6 +38,7 @@ static const char DB_HEAD_BLOCKS = 'H';
 static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
+static const char DB_RCT_BEST_BLOCK = 'r';
 
 static const char DB_BLACKLISTOUT = 'X';
 static const char DB_BLACKLISTPUB = 'P';
@@ -348,62 +349,288 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
 
 bool CBlockTreeDB::ReadRCTOutput(int64_t i, CAnonOutput &ao)
 {
+    {
+        LOCK(cs_rctcache);
+        auto it = cacheRCTOutputs.find(i);
+        if (it != cacheRCTOutputs.end()) {
+            if (!it->second)
+                return false;
+            ao = *it->second;
+            return true;
+        }
+    }
     return Read(std::make_pair(DB_RCTOUTPUT, i), ao);
 };
 
 bool CBlockTreeDB::WriteRCTOutput(int64_t i, const CAnonOutput &ao)
 {
-    CDBBatch batch(*this);
-    batch.Write(std::make_pair(DB_RCTOUTPUT, i), ao);
-    return WriteBatch(batch);
+    LOCK(cs_rctcache);
+    cacheRCTOutputs[i] = ao;
+    return true;
 };
 
 bool CBlockTreeDB::EraseRCTOutput(int64_t i)
 {
-    CDBBatch batch(*this);
-    batch.Erase(std::make_pair(DB_RCTOUTPUT, i));
-    return WriteBatch(batch);
+    LOCK(cs_rctcache);
+    cacheRCTOutputs[i] = nullopt;
+    return true;
 };
 
 
 bool CBlockTreeDB::ReadRCTOutputLink(const CCmpPubKey &pk, int64_t &i)
 {
+    {
+        LOCK(cs_rctcache);
+        auto it = cacheRCTOutputLinks.find(pk);
+        if (it != cacheRCTOutputLinks.end()) {
+            if (!it->second)
+                return false;
+            i = *it->second;
+            return true;
+        }
+    }
     return Read(std::make_pair(DB_RCTOUTPUT_LINK, pk), i);
 };
 
 bool CBlockTreeDB::WriteRCTOutputLink(const CCmpPubKey &pk, int64_t i)
 {
-    CDBBatch batch(*this);
-    batch.Write(std::make_pair(DB_RCTOUTPUT_LINK, pk), i);
-    return WriteBatch(batch);
+    LOCK(cs_rctcache);
+    cacheRCTOutputLinks[pk] = i;
+    return true;
 };
 
 bool CBlockTreeDB::EraseRCTOutputLink(const CCmpPubKey &pk)
 {
-    CDBBatch batch(*this);
-    batch.Erase(std::make_pair(DB_RCTOUTPUT_LINK, pk));
-    return WriteBatch(batch);
+    LOCK(cs_rctcache);
+    cacheRCTOutputLinks[pk] = nullopt;
+    return true;
 };
 
+void CBlockTreeDB::ReadRCTOutputLinks(const std::vector<CCmpPubKey> &vPubKeys, std::map<CCmpPubKey, int64_t> &mapIndexes)
+{
+    // Pubkeys that are pending in the cache are answered from it, the rest are read in key order
+    std::vector<CCmpPubKey> vRead;
+    {
+        LOCK(cs_rctcache);
+        for (const CCmpPubKey &pk : vPubKeys) {
+            auto it = cacheRCTOutputLinks.find(pk);
+            if (it != cacheRCTOutputLinks.end()) {
+                if (it->second)
+                    mapIndexes.emplace(pk, *it->second);
+                continue;
+            }
+            vRead.emplace_back(pk);
+        }
+    }
+    std::sort(vRead.begin(), vRead.end());
+    vRead.erase(std::unique(vRead.begin(), vRead.end()), vRead.end());
+
+    for (const CCmpPubKey &pk : vRead) {
+        int64_t i;
+        if (Read(std::make_pair(DB_RCTOUTPUT_LINK, pk), i))
+            mapIndexes.emplace(pk, i);
+    }
+}
+
 bool CBlockTreeDB::ReadRCTKeyImage(const CCmpPubKey &ki, uint256 &txhash)
 {
+    {
+        LOCK(cs_rctcache);
+        auto it = cacheRCTKeyImages.find(ki);
+        if (it != cacheRCTKeyImages.end()) {
+            if (!it->second)
+                return false;
+            txhash = *it->second;
+            return true;
+        }
+        if (fKeyImageFilterLoaded && !keyImageFilter.MaybeContains(ki))
+            return false;
+    }
     return Read(std::make_pair(DB_RCTKEYIMAGE, ki), txhash);
 };
 
 bool CBlockTreeDB::WriteRCTKeyImage(const CCmpPubKey &ki, const uint256 &txhash)
 {
-    CDBBatch batch(*this);
-    batch.Write(std::make_pair(DB_RCTKEYIMAGE, ki), txhash);
-    return WriteBatch(batch);
+    LOCK(cs_rctcache);
+    // Rebuild before inserting, the key image isn't on disk yet
+    if (fKeyImageFilterLoaded && keyImageFilter.GetInserted() >= keyImageFilter.GetCapacity())
+        LoadRCTKeyImageFilterLocked(1);
+    if (fKeyImageFilterLoaded)
+        keyImageFilter.Insert(ki);
+
+    cacheRCTKeyImages[ki] = txhash;
+    return true;
 };
 
 bool CBlockTreeDB::EraseRCTKeyImage(const CCmpPubKey &ki)
 {
-    CDBBatch batch(*this);
-    batch.Erase(std::make_pair(DB_RCTKEYIMAGE, ki));
-    return WriteBatch(batch);
+    LOCK(cs_rctcache);
+    cacheRCTKeyImages[ki] = nullopt;
+    return true;
 };
 
+void CBlockTreeDB::ReadRCTKeyImages(const std::vector<CCmpPubKey> &vKeyImages, std::map<CCmpPubKey, uint256> &mapSpent)
+{
+    // Only the key images the cache and filter can't answer go to disk, in key order so the reads stay local
+    std::vector<CCmpPubKey> vRead;
+    {
+        LOCK(cs_rctcache);
+        for (const CCmpPubKey &ki : vKeyImages) {
+            auto it = cacheRCTKeyImages.find(ki);
+            if (it != cacheRCTKeyImages.end()) {
+                if (it->second)
+                    mapSpent.emplace(ki, *it->second);
+                continue;
+            }
+            if (!fKeyImageFilterLoaded || keyImageFilter.MaybeContains(ki))
+                vRead.emplace_back(ki);
+        }
+    }
+    std::sort(vRead.begin(), vRead.end());
+    vRead.erase(std::unique(vRead.begin(), vRead.end()), vRead.end());
+
+    for (const CCmpPubKey &ki : vRead) {
+        uint256 txhash;
+        if (Read(std::make_pair(DB_RCTKEYIMAGE, ki), txhash))
+            mapSpent.emplace(ki, txhash);
+    }
+}
+
+bool CBlockTreeDB::FlushRCTCache(const uint256 &hashBestBlock)
+{
+    LOCK(cs_rctcache);
+    size_t nOutputs = cacheRCTOutputs.size(), nLinks = cacheRCTOutputLinks.size(), nKeyImages = cacheRCTKeyImages.size();
+
+    CDBBatch batch(*this);
+    for (const auto &it : cacheRCTOutputs) {
+        if (it.second)
+            batch.Write(std::make_pair(DB_RCTOUTPUT, it.first), *it.second);
+        else
+            batch.Erase(std::make_pair(DB_RCTOUTPUT, it.first));
+    }
+    for (const auto &it : cacheRCTOutputLinks) {
+        if (it.second)
+            batch.Write(std::make_pair(DB_RCTOUTPUT_LINK, it.first), *it.second);
+        else
+            batch.Erase(std::make_pair(DB_RCTOUTPUT_LINK, it.first));
+    }
+    for (const auto &it : cacheRCTKeyImages) {
+        if (it.second)
+            batch.Write(std::make_pair(DB_RCTKEYIMAGE, it.first), *it.second);
+        else
+            batch.Erase(std::make_pair(DB_RCTKEYIMAGE, it.first));
+    }
+    batch.Write(DB_RCT_BEST_BLOCK, hashBestBlock);
+
+    if (!WriteBatch(batch, true))
+        return false;
+
+    cacheRCTOutputs.clear();
+    cacheRCTOutputLinks.clear();
+    cacheRCTKeyImages.clear();
+    LogPrint(BCLog::COINDB, "Flushed %u anon outputs, %u output links and %u key images\n", nOutputs, nLinks, nKeyImages);
+    return true;
+}
+
+uint256 CBlockTreeDB::ReadRCTBestBlock()
+{
+    uint256 hashBestBlock;
+    if (!Read(DB_RCT_BEST_BLOCK, hashBestBlock))
+        return uint256();
+    return hashBestBlock;
+}
+
+size_t CBlockTreeDB::RCTCacheDynamicMemoryUsage() const
+{
+    LOCK(cs_rctcache);
+    return memusage::DynamicUsage(cacheRCTOutputs) + memusage::DynamicUsage(cacheRCTOutputLinks) + memusage::DynamicUsage(cacheRCTKeyImages);
+}
+
+bool CBlockTreeDB::LoadRCTKeyImageFilter()
+{
+    LOCK(cs_rctcache);
+    return LoadRCTKeyImageFilterLocked(0);
+}
+
+bool CBlockTreeDB::LoadRCTKeyImageFilterLocked(uint64_t nPending)
+{
+    int64_t nStart = GetTimeMillis();
+    fKeyImageFilterLoaded = false;
+
+    uint64_t nKeyImages = 0;
+    {
+        std::unique_ptr<CDBIterator> pcursor(NewIterator());
+        for (pcursor->Seek(std::make_pair(DB_RCTKEYIMAGE, CCmpPubKey())); pcursor->Valid(); pcursor->Next()) {
+            std::pair<char, CCmpPubKey> key;
+            if (!pcursor->GetKey(key) || key.first != DB_RCTKEYIMAGE)
+                break;
+            nKeyImages++;
+        }
+    }
+
+    // Leave room to grow so that the filter isn't rebuilt every few blocks
+    nPending += cacheRCTKeyImages.size();
+    keyImageFilter.Reset(std::max(CKeyImageFilter::MIN_CAPACITY, 2 * (nKeyImages + nPending)));
+
+    // Key images that haven't been flushed yet
+    for (const auto &it : cacheRCTKeyImages) {
+        if (it.second)
+            keyImageFilter.Insert(it.first);
+    }
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    for (pcursor->Seek(std::make_pair(DB_RCTKEYIMAGE, CCmpPubKey())); pcursor->Valid(); pcursor->Next()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CCmpPubKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_RCTKEYIMAGE)
+            break;
+        keyImageFilter.Insert(key.second);
+    }
+
+    fKeyImageFilterLoaded = true;
+    LogPrintf("%s: %u key images, sized for %u, %dms\n", __func__, keyImageFilter.GetInserted(),
+              keyImageFilter.GetCapacity(), GetTimeMillis() - nStart);
+    return true;
+}
+
+CKeyImageFilter::CKeyImageFilter() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+void CKeyImageFilter::Reset(uint64_t nCapacityIn)
+{
+    nCapacity = nCapacityIn;
+    nBits = nCapacity * BITS_PER_ELEMENT;
+    nInserted = 0;
+    vData.assign((nBits + 63) / 64, 0);
+}
+
+void CKeyImageFilter::Insert(const CCmpPubKey &ki)
+{
+    uint64_t nHash = CSipHasher(k0, k1).Write(ki.begin(), ki.size()).Finalize();
+    uint64_t nHash1 = nHash & 0xffffffff;
+    uint64_t nHash2 = nHash >> 32;
+    for (int i = 0; i < NUM_HASH_FUNCS; i++) {
+        uint64_t nBit = (nHash1 + i * nHash2) % nBits;
+        vData[nBit >> 6] |= (uint64_t)1 << (nBit & 63);
+    }
+    nInserted++;
+}
+
+bool CKeyImageFilter::MaybeContains(const CCmpPubKey &ki) const
+{
+    if (nBits == 0)
+        return true;
+
+    uint64_t nHash = CSipHasher(k0, k1).Write(ki.begin(), ki.size()).Finalize();
+    uint64_t nHash1 = nHash & 0xffffffff;
+    uint64_t nHash2 = nHash >> 32;
+    for (int i = 0; i < NUM_HASH_FUNCS; i++) {
+        uint64_t nBit = (nHash1 + i * nHash2) % nBits;
+        if (!(vData[nBit >> 6] & ((uint64_t)1 << (nBit & 63))))
+            return false;
+    }
+    return true;
+}
+
 namespace {
 
 //! Legacy class to deserialize pre-pertxout database entries without reindex.
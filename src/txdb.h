@@ -13,10 +13,13 @@
 #include <primitives/block.h>
 #include <libzerocoin/Coin.h>
 #include <libzerocoin/CoinSpend.h>
+#include <optional.h>
+#include <sync.h>
 
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -90,9 +93,61 @@ private:
     friend class CCoinsViewDB;
 };
 
-/** Access to the block database (blocks/index/) */
+/**
+ * Bloom filter over every key image in the block database.
+ *
+ * Almost every key image that is looked up has not been spent yet, so a negative answer from the filter
+ * lets those lookups skip LevelDB entirely. Erased key images stay in the filter, which only costs a
+ * false positive. CBlockTreeDB rebuilds it from disk before it fills past the capacity it was sized for.
+ */
+class CKeyImageFilter
+{
+private:
+    /** Salt */
+    const uint64_t k0, k1;
+
+    std::vector<uint64_t> vData;
+    uint64_t nBits = 0;
+    uint64_t nCapacity = 0;
+    uint64_t nInserted = 0;
+
+public:
+    //! Filter bits per key image, for a false positive rate of about 0.05%
+    static constexpr int BITS_PER_ELEMENT = 16;
+    static constexpr int NUM_HASH_FUNCS = 11;
+    //! Smallest number of key images the filter is sized for
+    static constexpr uint64_t MIN_CAPACITY = 1 << 20;
+
+    CKeyImageFilter();
+
+    void Reset(uint64_t nCapacityIn);
+    void Insert(const CCmpPubKey& ki);
+    bool MaybeContains(const CCmpPubKey& ki) const;
+    uint64_t GetCapacity() const { return nCapacity; }
+    uint64_t GetInserted() const { return nInserted; }
+};
+
+/**
+ * Access to the block database (blocks/index/)
+ *
+ * Changes to the RingCT index (anon outputs, output links and key images) are kept in a write-back cache
+ * and written in one batch by FlushRCTCache, which FlushStateToDisk calls right before it flushes the
+ * chainstate. An empty cache entry is an erasure that hasn't reached the disk yet. All RingCT reads check
+ * the cache first, so they always see the pending state.
+ */
 class CBlockTreeDB : public CDBWrapper
 {
+private:
+    mutable CCriticalSection cs_rctcache;
+    std::unordered_map<int64_t, Optional<CAnonOutput> > cacheRCTOutputs GUARDED_BY(cs_rctcache);
+    std::unordered_map<CCmpPubKey, Optional<int64_t>, SaltedKeyImageHasher> cacheRCTOutputLinks GUARDED_BY(cs_rctcache);
+    std::unordered_map<CCmpPubKey, Optional<uint256>, SaltedKeyImageHasher> cacheRCTKeyImages GUARDED_BY(cs_rctcache);
+
+    CKeyImageFilter keyImageFilter GUARDED_BY(cs_rctcache);
+    bool fKeyImageFilterLoaded GUARDED_BY(cs_rctcache) = false;
+
+    bool LoadRCTKeyImageFilterLocked(uint64_t nPending) EXCLUSIVE_LOCKS_REQUIRED(cs_rctcache);
+
 public:
     explicit CBlockTreeDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
 
@@ -112,10 +167,23 @@ public:
     bool ReadRCTOutputLink(const CCmpPubKey &pk, int64_t &i);
     bool WriteRCTOutputLink(const CCmpPubKey &pk, int64_t i);
     bool EraseRCTOutputLink(const CCmpPubKey &pk);
+    /** Look up the output index of many pubkeys at once, the ones that are indexed are returned in mapIndexes */
+    void ReadRCTOutputLinks(const std::vector<CCmpPubKey> &vPubKeys, std::map<CCmpPubKey, int64_t> &mapIndexes);
 
     bool ReadRCTKeyImage(const CCmpPubKey &ki, uint256 &txhash);
     bool WriteRCTKeyImage(const CCmpPubKey &ki, const uint256 &txhash);
     bool EraseRCTKeyImage(const CCmpPubKey &ki);
+
+    /** Look up many key images at once, the ones that are spent are returned in mapSpent with their tx */
+    void ReadRCTKeyImages(const std::vector<CCmpPubKey> &vKeyImages, std::map<CCmpPubKey, uint256> &mapSpent);
+    /** Size the key image filter for the key images on disk and fill it */
+    bool LoadRCTKeyImageFilter();
+
+    /** Write the pending RingCT index changes together with the block they bring the index up to */
+    bool FlushRCTCache(const uint256 &hashBestBlock);
+    /** The block the RingCT index on disk was last flushed at, null if it never was */
+    uint256 ReadRCTBestBlock();
+    size_t RCTCacheDynamicMemoryUsage() const;
 };
 
 /** Zerocoin database (zerocoin/) */
@@ -1016,8 +1016,7 @@ bool CTxMemPool::HaveKeyImage(const CCmpPubKey &ki, uint256 &hash) const
 {
     LOCK(cs);
 
-    std::map<CCmpPubKey, uint256>::const_iterator mi;
-    mi = mapKeyImages.find(ki);
+    auto mi = mapKeyImages.find(ki);
 
     if (mi != mapKeyImages.end()) {
         hash = mi->second;
@@ -1027,6 +1026,17 @@ bool CTxMemPool::HaveKeyImage(const CCmpPubKey &ki, uint256 &hash) const
     return false;
 }
 
+void CTxMemPool::HaveKeyImages(const std::vector<CCmpPubKey> &vKeyImages, std::map<CCmpPubKey, uint256> &mapSpent) const
+{
+    LOCK(cs);
+
+    for (const CCmpPubKey &ki : vKeyImages) {
+        auto mi = mapKeyImages.find(ki);
+        if (mi != mapKeyImages.end())
+            mapSpent.emplace(ki, mi->second);
+    }
+}
+
 bool CTxMemPool::HasZerocoinSerial(const uint256& hashSerial) const
 {
     LOCK(cs);
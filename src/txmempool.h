@@ -9,6 +9,7 @@
 #include <memory>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <string>
@@ -537,7 +538,7 @@ public:
     indirectmap<COutPoint, const CTransaction*> mapNextTx GUARDED_BY(cs);
     std::map<uint256, CAmount> mapDeltas;
 
-    std::map<CCmpPubKey, uint256> mapKeyImages;
+    std::unordered_map<CCmpPubKey, uint256, SaltedKeyImageHasher> mapKeyImages;
 
     /** Create a new CTxMemPool.
      */
@@ -590,6 +591,8 @@ public:
     void ClearPrioritisation(const uint256 hash);
 
     bool HaveKeyImage(const CCmpPubKey &ki, uint256 &hash) const;
+    /** Batched HaveKeyImage, the key images spent in the mempool are returned in mapSpent with their tx */
+    void HaveKeyImages(const std::vector<CCmpPubKey> &vKeyImages, std::map<CCmpPubKey, uint256> &mapSpent) const;
     bool HasZerocoinSerial(const uint256& hashSerial) const;
     bool HasPublicCoin(const uint256& hashPubcoin) const;
 
@@ -57,6 +57,7 @@
 #include <veil/proofofstake/kernel.h>
 #include <veil/ringct/blind.h>
 #include <veil/invalid.h>
+#include <veil/validationstats.h>
 
 #include <crypto/randomx/randomx.h>
 
@@ -756,15 +757,19 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
                 if (vKeyImages.size() != nInputs * 33)
                     return state.Invalid(false, REJECT_DUPLICATE, "anonin-badkeyimagesize");
 
+                std::vector<CCmpPubKey> vInputKeyImages;
                 for (size_t k = 0; k < nInputs; ++k) {
                     const CCmpPubKey &ki = *((CCmpPubKey *) &vKeyImages[k * 33]);
                     uint256 txidKeyImage;
                     if (pool.HaveKeyImage(ki, txidKeyImage))
                         return state.Invalid(false, REJECT_DUPLICATE, "keyimage-already-known");
-                    if (pblocktree->ReadRCTKeyImage(ki, txidKeyImage)) {
-                        LogPrint(BCLog::NET, "%s: Key image in tx %s\n", __func__, txidKeyImage.GetHex());
-                        return state.Invalid(false, REJECT_DUPLICATE, "bad-anonin-dup-keyimage");
-                    }
+                    vInputKeyImages.emplace_back(ki);
+                }
+                std::map<CCmpPubKey, uint256> mapSpentKeyImages;
+                pblocktree->ReadRCTKeyImages(vInputKeyImages, mapSpentKeyImages);
+                if (!mapSpentKeyImages.empty()) {
+                    LogPrint(BCLog::NET, "%s: Key image in tx %s\n", __func__, mapSpentKeyImages.begin()->second.GetHex());
+                    return state.Invalid(false, REJECT_DUPLICATE, "bad-anonin-dup-keyimage");
                 }
 
                 // check blacklisted anon outpoints
@@ -2239,6 +2244,8 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
     assert(pindex);
     assert(*pindex->phashBlock == block.GetHash());
     int64_t nTimeStart = GetTimeMicros();
+    // Proofs verified for a block template check are not block validation samples
+    ValidationStatsScope statsScope(!fJustCheck);
 
     bool fSkipComputation = false;
     int nHeightLastCheckpoint = Checkpoints::GetLastCheckpointHeight(chainparams.Checkpoints());
@@ -2258,7 +2265,8 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
     // is enforced in ContextualCheckBlockHeader(); we wouldn't want to
     // re-enforce that rule here (at least until we make it impossible for
     // GetAdjustedTime() to go backward).
-    if (!CheckBlock(block, state, chainparams.GetConsensus(), fSkipComputation, !fJustCheck, !fJustCheck)) {
+    const bool fCheckedBefore = block.fChecked;
+    if (!CheckBlock(block, state, chainparams.GetConsensus(), fSkipComputation, !fJustCheck, !fJustCheck, fJustCheck)) {
         if (state.CorruptionPossible()) {
             // We don't write down blocks to disk if they may have been
             // corrupted, so this should be impossible unless we're having hardware
@@ -2871,6 +2879,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
 
     // Zerocoin accumulator validation
 	int64_t nTimeAccumulate = 0;
+	bool fAccumulated = false;
 	AccumulatorMap mapAccumulators(Params().Zerocoin_Params());
 	
 	// This is the ONLY time ValidateAccumulatorCheckpoint() actually calculates accumulators
@@ -2890,6 +2899,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
 	    }
 	
 	    nTimeAccumulate = GetTimeMicros() - nStart;
+	    fAccumulated = true;
 	    LogPrint(BCLog::BENCH, "    - Accumulate (pre-LZC mandatory): %.2fms\n", MILLI * nTimeAccumulate);
 	}
 	// Post-Light Zerocoin: only validate when it matters
@@ -2910,6 +2920,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
 	        }
 	
 	        nTimeAccumulate = GetTimeMicros() - nStart;
+	        fAccumulated = true;
 	
 	        if (fChecksumBoundary) {
 	            LogPrint(BCLog::BENCH, "    - Accumulate (checksum boundary): %.2fms\n", MILLI * nTimeAccumulate);
@@ -2954,6 +2965,17 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
     if (fJustCheck)
         return true;
 
+    // Block template checks are left out, the stats describe connecting blocks. A block that was checked when
+    // it was received was timed by CheckNewBlock, this call only returned the cached result.
+    if (!fCheckedBefore)
+        RecordValidationStage(ValidationStage::CHECK_BLOCK, nTimeCheckBlock);
+    RecordValidationStage(ValidationStage::CONNECT_TRANSACTIONS, nTime3 - nTime2);
+    if (!mapSpends.empty())
+        RecordValidationStage(ValidationStage::ZEROCOIN_SPEND, nTimeZerocoinSpendCheck);
+    if (fAccumulated)
+        RecordValidationStage(ValidationStage::ACCUMULATOR_CHECKPOINT, nTimeAccumulate);
+    RecordValidationStage(ValidationStage::VEIL_DATA_HASH, nTime5 - nTime4);
+
 	pindex->nAnonOutputs = view.nLastRCTOutput;
 
 	const bool fWritePubcoinSpends = (pindex->nHeight >= Params().HeightLightZerocoin());
@@ -2974,6 +2996,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
 
     int64_t nTime6 = GetTimeMicros(); nTimeDatabaseZerocoin += nTime6 - nTime5;
     LogPrint(BCLog::BENCH, "    - Writing zerocoin to database : %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime6 - nTime5), nTimeDatabaseZerocoin * MICRO, nTimeDatabaseZerocoin * MILLI / nBlocksTotal);
+    RecordValidationStage(ValidationStage::ZEROCOIN_DATABASE, nTime6 - nTime5);
 
     //Record accumulator checksums - if they have been updated, which happens every ten blocks
     if (pindex->nHeight > 10 && pindex->nHeight % 10 == 0)
@@ -2996,6 +3019,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
 
     int64_t nTime8 = GetTimeMicros(); nTimeCallbacks += nTime8 - nTime7;
     LogPrint(BCLog::BENCH, "    - Callbacks: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime8 - nTime7), nTimeCallbacks * MICRO, nTimeCallbacks * MILLI / nBlocksTotal);
+    RecordValidationStage(ValidationStage::CONNECT_BLOCK, nTime8 - nTimeStart);
 
     return true;
 }
@@ -3048,7 +3072,7 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
         }
 
         int64_t nMempoolSizeMax = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
-        int64_t cacheSize = pcoinsTip->DynamicMemoryUsage();
+        int64_t cacheSize = pcoinsTip->DynamicMemoryUsage() + pblocktree->RCTCacheDynamicMemoryUsage();
         int64_t nTotalSpace = nCoinCacheUsage + std::max<int64_t>(nMempoolSizeMax - nMempoolUsage, 0);
         // The cache is large and we're within 10% and 10 MiB of the limit, but we have time now (not in the middle of a block processing).
         bool fCacheLarge = mode == FlushStateMode::PERIODIC && cacheSize > std::max((9 * nTotalSpace) / 10, nTotalSpace - MAX_BLOCK_COINSDB_USAGE * 1024 * 1024);
@@ -3107,6 +3131,9 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
             // overwrite one. Still, use a conservative safety factor of 2.
             if (!CheckDiskSpace(48 * 2 * 2 * pcoinsTip->GetCacheSize()))
                 return state.Error("out of disk space");
+            // Flush the RingCT index right before the chainstate, so that after a crash it is never behind it.
+            if (!pblocktree->FlushRCTCache(pcoinsTip->GetBestBlock()))
+                return AbortNode(state, "Failed to write RingCT index to block index database");
             // Flush the chainstate (which may refer to block index entries).
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
@@ -3151,6 +3178,10 @@ static void DoWarning(const std::string& strWarning)
     }
 }
 
+/**
+ * Move the RingCT index changes of a connected or disconnected block from the view into the block tree's RCT
+ * cache. They reach the disk with the next FlushStateToDisk that flushes the chainstate.
+ */
 bool FlushView(CCoinsViewCache *view, CValidationState& state, bool fDisconnecting)
 {
     if (!view->Flush())
@@ -3171,19 +3202,17 @@ bool FlushView(CCoinsViewCache *view, CValidationState& state, bool fDisconnecti
             }
         }
     } else {
-        CDBBatch batch(*pblocktree);
-
         for (auto &it : view->keyImages)
-            batch.Write(std::make_pair(DB_RCTKEYIMAGE, it.first), it.second);
+            if (!pblocktree->WriteRCTKeyImage(it.first, it.second))
+                return error("%s: WriteRCTKeyImage failed, txn %s.", __func__, it.second.ToString());
 
         for (auto &it : view->anonOutputs)
-            batch.Write(std::make_pair(DB_RCTOUTPUT, it.first), it.second);
+            if (!pblocktree->WriteRCTOutput(it.first, it.second))
+                return error("%s: WriteRCTOutput failed.", __func__);
 
         for (auto &it : view->anonOutputLinks)
-            batch.Write(std::make_pair(DB_RCTOUTPUT_LINK, it.first), it.second);
-
-        if (!pblocktree->WriteBatch(batch))
-            return error("%s: Write RCT outputs failed.", __func__);
+            if (!pblocktree->WriteRCTOutputLink(it.first, it.second))
+                return error("%s: WriteRCTOutputLink failed.", __func__);
     }
 
     view->nLastRCTOutput = 0;
@@ -3459,6 +3488,7 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
 
     int64_t nTime4 = GetTimeMicros(); nTimeFlush += nTime4 - nTime3;
     LogPrint(BCLog::BENCH, "  - Flush: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime4 - nTime3) * MILLI, nTimeFlush * MICRO, nTimeFlush * MILLI / nBlocksTotal);
+    RecordValidationStage(ValidationStage::FLUSH_VIEW, nTime4 - nTime3);
 
     // Write the chain state to disk, if necessary.
     if (!FlushStateToDisk(chainparams, state, FlushStateMode::IF_NEEDED))
@@ -4072,6 +4102,7 @@ CBlockIndex* CChainState::AddToBlockIndex(const CBlockHeader& block, bool fProof
             pindexNew->nHeight = pindexNew->pprev->nHeight + 1;
             pindexNew->BuildSkip();
         }
+        pindexNew->BuildAlgoLinks();
     }
     pindexNew->nTimeMax = (pindexNew->pprev ? std::max(pindexNew->pprev->nTimeMax, pindexNew->nTime) : pindexNew->nTime);
 
@@ -4270,7 +4301,7 @@ static bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state,
     return true;
 }
 
-bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fSkipComputation, bool fCheckPOW, bool fCheckMerkleRoot)
+bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fSkipComputation, bool fCheckPOW, bool fCheckMerkleRoot, bool fReuseMempoolProofs)
 {
     // These are checks that are independent of context.
     if (block.fChecked)
@@ -4324,7 +4355,10 @@ bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::P
     // Check transactions
     int64_t nTimeCheckTx = GetTimeMicros();
     for (const auto& tx : block.vtx) {
-        if (!CheckTransaction(*tx, state, fSkipComputation))
+        // Range proofs and zerocoin mints are committed to by the txid and were verified when the transaction
+        // entered the mempool
+        bool fProofsVerified = fReuseMempoolProofs && mempool.exists(tx->GetHash());
+        if (!CheckTransaction(*tx, state, fSkipComputation || fProofsVerified, fProofsVerified))
             return state.Invalid(false, state.GetRejectCode(), state.GetRejectReason(),
                                  strprintf("Transaction check failed (tx hash %s) %s", tx->GetHash().ToString(),
                                            state.GetDebugMessage()));
@@ -4989,6 +5023,18 @@ bool CChainState::ContextualCheckZerocoinStake(CBlockIndex* pindex, CStakeInput*
     return true;
 }
 
+/** CheckBlock of a block that is received or loaded from disk. Range proofs of these blocks are verified here
+ *  rather than in ConnectBlock, which finds the block already checked, so both are timed for getvalidationstats */
+static bool CheckNewBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fSkipComputation)
+{
+    if (block.fChecked)
+        return true;
+
+    ValidationStatsScope statsScope(true);
+    ValidationStageTimer timer(ValidationStage::CHECK_BLOCK);
+    return CheckBlock(block, state, consensusParams, fSkipComputation);
+}
+
 /** Store block on disk. If dbp is non-nullptr, the file is known to already reside on disk */
 std::map<uint256, uint256> mapDoubleStake;
 bool CChainState::AcceptBlock(const std::shared_ptr<const CBlock>& pblock, CValidationState& state,
@@ -5081,7 +5127,7 @@ bool CChainState::AcceptBlock(const std::shared_ptr<const CBlock>& pblock, CVali
 
     int nHeightLastCheckpoint = Checkpoints::GetLastCheckpointHeight(chainparams.Checkpoints());
     bool fSkipComputation = pindex->nHeight < nHeightLastCheckpoint;
-    if (!CheckBlock(block, state, chainparams.GetConsensus(), fSkipComputation) ||
+    if (!CheckNewBlock(block, state, chainparams.GetConsensus(), fSkipComputation) ||
         !ContextualCheckBlock(block, state, chainparams.GetConsensus(), pindex->pprev)) {
         if (state.IsInvalid() && !state.CorruptionPossible()) {
             pindex->nStatus |= BLOCK_FAILED_VALID;
@@ -5125,7 +5171,7 @@ bool ProcessNewBlock(const CChainParams& chainparams, const std::shared_ptr<cons
         CValidationState state;
         // Ensure that CheckBlock() passes before calling AcceptBlock, as
         // belt-and-suspenders.
-        bool ret = CheckBlock(*pblock, state, chainparams.GetConsensus(), fSkipComputation);
+        bool ret = CheckNewBlock(*pblock, state, chainparams.GetConsensus(), fSkipComputation);
         LOCK(cs_main);
         if (ret) {
             // Store to disk
@@ -5163,7 +5209,7 @@ bool TestBlockValidity(CValidationState& state, const CChainParams& chainparams,
     // NOTE: CheckBlockHeader is called by CheckBlock
     if (!ContextualCheckBlockHeader(block, state, chainparams, pindexPrev, GetAdjustedTime()))
         return error("%s: Consensus::ContextualCheckBlockHeader: %s", __func__, FormatStateMessage(state));
-    if (!CheckBlock(block, state, chainparams.GetConsensus(), true, fCheckPOW, fCheckMerkleRoot))
+    if (!CheckBlock(block, state, chainparams.GetConsensus(), true, fCheckPOW, fCheckMerkleRoot, true))
         return error("%s: Consensus::CheckBlock: %s", __func__, FormatStateMessage(state));
     if (!ContextualCheckBlock(block, state, chainparams.GetConsensus(), pindexPrev, true))
         return error("%s: Consensus::ContextualCheckBlock: %s", __func__, FormatStateMessage(state));
@@ -5460,6 +5506,7 @@ bool CChainState::LoadBlockIndex(const Consensus::Params& consensus_params, CBlo
             pindexBestInvalid = pindex;
         if (pindex->pprev)
             pindex->BuildSkip();
+        pindex->BuildAlgoLinks();
         if (pindex->IsValid(BLOCK_VALID_TREE) && (pindexBestHeader == nullptr || CBlockIndexWorkComparator()(pindexBestHeader, pindex)))
             pindexBestHeader = pindex;
     }
@@ -2,133 +2,239 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <random.h>
 #include <timedata.h>
 #include "dandelioninventory.h"
 
+#include <algorithm>
+
 namespace veil {
 
 DandelionInventory dandelion;
 
-void DandelionInventory::Add(const uint256& hashInventory, const int64_t& nTimeStemEnd, const int64_t& nNodeIDFrom)
+StemHasher::StemHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+DandelionInventory::DandelionInventory() : vStemWheel(STEM_WHEEL_SLOTS)
+{
+}
+
+bool DandelionInventory::Add(const uint256& hashInventory, const int64_t& nTimeStemEnd, const int64_t& nNodeIDFrom)
 {
+    LOCK(cs);
+    int64_t nNow = GetAdjustedTime();
+    if (nTimeStemEnd <= nNow)
+        return false;
+
     Stem stem;
-    stem.nTimeStemEnd = nTimeStemEnd;
+    //Peers pick the stem end, never keep inventory in the stem phase longer than this node would
+    stem.nTimeStemEnd = std::min(nTimeStemEnd, nNow + nDefaultStemTime);
     stem.nNodeIDFrom = nNodeIDFrom;
-    mapStemInventory.emplace(std::make_pair(hashInventory, stem));
+    stem.nNodeIDQueuedTo = nNoNodeID;
+    stem.nNodeIDSentTo = nNoNodeID;
+    auto ret = mapStemInventory.emplace(hashInventory, stem);
+    if (!ret.second)
+        return true;
+
+    vStemWheel[stem.nTimeStemEnd % STEM_WHEEL_SLOTS].emplace_back(hashInventory);
+    if (!Route(hashInventory, ret.first->second))
+        vUnrouted.emplace_back(hashInventory);
+    return true;
 }
 
 int64_t DandelionInventory::GetTimeStemPhaseEnd(const uint256& hashObject) const
 {
-    if (!mapStemInventory.count(hashObject))
+    LOCK(cs);
+    auto mi = mapStemInventory.find(hashObject);
+    if (mi == mapStemInventory.end())
         return 0;
 
-    return mapStemInventory.at(hashObject).nTimeStemEnd;
+    return mi->second.nTimeStemEnd;
 }
 
 bool DandelionInventory::IsFromNode(const uint256& hash, const int64_t nNodeID) const
 {
-    if (!mapStemInventory.count(hash))
+    LOCK(cs);
+    auto mi = mapStemInventory.find(hash);
+    if (mi == mapStemInventory.end())
         return false;
 
-    return mapStemInventory.at(hash).nNodeIDFrom == nNodeID;
+    return mi->second.nNodeIDFrom == nNodeID;
 }
 
 bool DandelionInventory::IsInStemPhase(const uint256& hash) const
 {
-    if (!mapStemInventory.count(hash))
+    LOCK(cs);
+    auto mi = mapStemInventory.find(hash);
+    if (mi == mapStemInventory.end())
         return false;
 
-    return mapStemInventory.at(hash).nTimeStemEnd < GetAdjustedTime();
+    return GetAdjustedTime() < mi->second.nTimeStemEnd;
 }
 
 //Only send to a node that requests the tx if the inventory was broadcast to this node
-bool DandelionInventory::IsNodePendingSend(const uint256& hashInventory, const int64_t nNodeID)
+bool DandelionInventory::IsNodePendingSend(const uint256& hashInventory, const int64_t nNodeID) const
 {
-    if (!mapStemInventory.count(hashInventory))
+    LOCK(cs);
+    auto mi = mapStemInventory.find(hashInventory);
+    if (mi == mapStemInventory.end())
         return true;
 
-    return mapStemInventory.at(hashInventory).nNodeIDSentTo == nNodeID;
+    return mi->second.nNodeIDSentTo == nNodeID;
 }
 
 bool DandelionInventory::IsSent(const uint256& hash) const
 {
+    LOCK(cs);
     //Assume that if it is not here, then it is sent
-    if (!mapStemInventory.count(hash))
+    auto mi = mapStemInventory.find(hash);
+    if (mi == mapStemInventory.end())
         return true;
 
-    return mapStemInventory.at(hash).nNodeIDSentTo != 0;
+    return mi->second.nNodeIDSentTo != nNoNodeID;
 }
 
 void DandelionInventory::SetInventorySent(const uint256& hash, const int64_t nNodeID)
 {
-    if (!mapStemInventory.count(hash))
+    LOCK(cs);
+    auto mi = mapStemInventory.find(hash);
+    if (mi == mapStemInventory.end())
         return;
-    mapStemInventory.at(hash).nNodeIDSentTo = nNodeID;
-    setPendingSend.erase(hash);
-    mapNodeToSentTo.erase(hash);
+    mi->second.nNodeIDSentTo = nNodeID;
 }
 
-bool DandelionInventory::IsQueuedToSend(const uint256& hashObject) const
+void DandelionInventory::GetStemInventoryToSend(const int64_t nNodeID, std::vector<uint256>& vHashes)
 {
-    //If no knowledge of this hash, then assume safe to send
-    if (!mapStemInventory.count(hashObject))
-        return true;
+    LOCK(cs);
+    auto it = mapStemQueue.find(nNodeID);
+    if (it == mapStemQueue.end())
+        return;
 
-    return static_cast<bool>(setPendingSend.count(hashObject));
+    for (const uint256& hash : it->second) {
+        auto mi = mapStemInventory.find(hash);
+        // Expired, or re-routed to another peer since it was queued
+        if (mi == mapStemInventory.end() || mi->second.nNodeIDQueuedTo != nNodeID)
+            continue;
+        if (mi->second.nNodeIDSentTo != nNoNodeID)
+            continue;
+        mi->second.nNodeIDSentTo = nNodeID;
+        vHashes.emplace_back(hash);
+    }
+    mapStemQueue.erase(it);
 }
 
-void DandelionInventory::MarkSent(const uint256& hash)
+bool DandelionInventory::Route(const uint256& hash, Stem& stem)
 {
-    mapStemInventory.erase(hash);
-    setPendingSend.erase(hash);
-    mapNodeToSentTo.erase(hash);
+    int64_t nNodeIDTo;
+    auto it = mapStemRoute.find(stem.nNodeIDFrom);
+    if (it != mapStemRoute.end()) {
+        nNodeIDTo = it->second;
+    } else {
+        //Never route back to the node the inventory came from
+        std::vector<int64_t> vCandidates;
+        for (const int64_t nNodeID : vStemPeers) {
+            if (nNodeID != stem.nNodeIDFrom)
+                vCandidates.emplace_back(nNodeID);
+        }
+        if (vCandidates.empty())
+            return false;
+
+        nNodeIDTo = vCandidates[GetRandInt(static_cast<int>(vCandidates.size()))];
+        mapStemRoute.emplace(stem.nNodeIDFrom, nNodeIDTo);
+    }
+
+    stem.nNodeIDQueuedTo = nNodeIDTo;
+    mapStemQueue[nNodeIDTo].emplace_back(hash);
+    return true;
 }
 
-void DandelionInventory::Process(const std::vector<CNode*>& vNodes)
+void DandelionInventory::NewEpoch(const std::vector<CNode*>& vNodes)
 {
-    //Clear all the old node destinations
-    mapNodeToSentTo.clear();
-    auto mapStem = mapStemInventory;
-    for (auto mi : mapStem) {
-        auto hash = mi.first;
-        auto stem = mi.second;
-
-        //If in the fluff phase, remove from this tracker
-        if (stem.nTimeStemEnd < GetAdjustedTime()) {
-            mapStemInventory.erase(mi.first);
-            setPendingSend.erase(mi.first);
-            continue;
-        }
-
-        //Already marked this to send
-        if (setPendingSend.count(mi.first))
+    //Prefer outbound peers for the stem, topping up with inbound peers if there are not enough
+    std::vector<int64_t> vOutbound;
+    std::vector<int64_t> vInbound;
+    for (const CNode* pnode : vNodes) {
+        if (pnode->fDisconnect)
             continue;
+        if (pnode->fInbound)
+            vInbound.emplace_back(pnode->GetId());
+        else
+            vOutbound.emplace_back(pnode->GetId());
+    }
 
-        //If rolled recently, then wait
-        if (GetAdjustedTime() - stem.nTimeLastRoll < 5)
-            continue;
-        mapStemInventory.at(hash).nTimeLastRoll = GetAdjustedTime();
+    FastRandomContext rng;
+    Shuffle(vOutbound.begin(), vOutbound.end(), rng);
+    Shuffle(vInbound.begin(), vInbound.end(), rng);
+    vOutbound.insert(vOutbound.end(), vInbound.begin(), vInbound.end());
+    if (vOutbound.size() > STEM_PEERS_PER_EPOCH)
+        vOutbound.resize(STEM_PEERS_PER_EPOCH);
+
+    vStemPeers = std::move(vOutbound);
+    mapStemRoute.clear();
+    nTimeEpochEnd = GetAdjustedTime() + nDefaultEpochTime;
+
+    //Anything that is still waiting in a stem queue follows the new routes
+    for (const auto& queue : mapStemQueue)
+        vUnrouted.insert(vUnrouted.end(), queue.second.begin(), queue.second.end());
+    mapStemQueue.clear();
+}
 
-        //Set the index to send to
-        int64_t nNodeID;
-        do {
-            int nRand = GetRandInt(static_cast<int>(vNodes.size() - 1));
-            nNodeID = vNodes[nRand]->GetId();
+void DandelionInventory::ExpireStems(std::vector<uint256>& vFluff)
+{
+    int64_t nNow = GetAdjustedTime();
+    if (nTimeWheel == 0 || nNow - nTimeWheel > STEM_WHEEL_SLOTS)
+        nTimeWheel = nNow - STEM_WHEEL_SLOTS;
+
+    for (; nTimeWheel < nNow; nTimeWheel++) {
+        std::vector<uint256>& vSlot = vStemWheel[(nTimeWheel + 1) % STEM_WHEEL_SLOTS];
+        std::vector<uint256> vPending;
+        for (const uint256& hash : vSlot) {
+            auto mi = mapStemInventory.find(hash);
+            if (mi == mapStemInventory.end())
+                continue;
+
+            //Stem ends more than one revolution away stay in the slot
+            if (mi->second.nTimeStemEnd > nNow) {
+                vPending.emplace_back(hash);
+                continue;
+            }
+
+            mapStemInventory.erase(mi);
+            vFluff.emplace_back(hash);
         }
-        while (nNodeID == stem.nNodeIDFrom);
-        mapNodeToSentTo.insert(std::make_pair<uint256&, int64_t& >(hash, nNodeID));
-
-        // Randomly decide to send this if it is in stem phase
-        auto n = GetRandInt(3);
-        if (n == 1)
-            setPendingSend.emplace(hash);
+        vSlot.swap(vPending);
     }
 }
 
-    bool DandelionInventory::IsCorrectNodeToSend(const uint256& hash, const int64_t nNodeID)
-    {
-        return mapNodeToSentTo[hash] == nNodeID;
+void DandelionInventory::Process(const std::vector<CNode*>& vNodes, std::vector<uint256>& vFluff)
+{
+    LOCK(cs);
+    ExpireStems(vFluff);
+
+    //Start a new epoch when it runs out, or when more peers are now available than were picked
+    size_t nConnected = std::count_if(vNodes.begin(), vNodes.end(), [](const CNode* pnode) { return !pnode->fDisconnect; });
+    bool fNewEpoch = GetAdjustedTime() >= nTimeEpochEnd || vStemPeers.size() < std::min(nConnected, STEM_PEERS_PER_EPOCH);
+    for (size_t i = 0; !fNewEpoch && i < vStemPeers.size(); i++) {
+        //A stem peer that went away ends the epoch early
+        auto it = std::find_if(vNodes.begin(), vNodes.end(), [&](const CNode* pnode) {
+            return pnode->GetId() == vStemPeers[i] && !pnode->fDisconnect;
+        });
+        fNewEpoch = it == vNodes.end();
     }
+    if (fNewEpoch)
+        NewEpoch(vNodes);
+
+    if (vUnrouted.empty() || vStemPeers.empty())
+        return;
 
+    std::vector<uint256> vRetry;
+    vRetry.swap(vUnrouted);
+    for (const uint256& hash : vRetry) {
+        auto mi = mapStemInventory.find(hash);
+        if (mi == mapStemInventory.end() || mi->second.nNodeIDSentTo != nNoNodeID)
+            continue;
+        if (!Route(hash, mi->second))
+            vUnrouted.emplace_back(hash);
+    }
 }
 
+}
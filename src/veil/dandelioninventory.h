@@ -5,46 +5,96 @@
 #ifndef VEIL_DANDELIONINVENTORY_H
 #define VEIL_DANDELIONINVENTORY_H
 
+#include <hash.h>
 #include <protocol.h>
 #include <sync.h>
 #include "net.h"
 
+#include <unordered_map>
+#include <vector>
+
 namespace veil {
 
 struct Stem
 {
     int64_t nTimeStemEnd;
-    int64_t nTimeLastRoll;
     int64_t nNodeIDFrom;
+    int64_t nNodeIDQueuedTo;
     int64_t nNodeIDSentTo;
 };
 
+class StemHasher
+{
+private:
+    /** Salt */
+    const uint64_t k0, k1;
+
+public:
+    StemHasher();
+
+    size_t operator()(const uint256& hash) const {
+        return SipHashUint256(k0, k1, hash);
+    }
+};
+
 class DandelionInventory;
 extern DandelionInventory dandelion;
 
+/**
+ * Tracks inventory that is in the stem phase and routes it along the stem.
+ *
+ * Routing follows Dandelion++: at the start of every epoch a small set of stem peers is picked, and each
+ * source (a peer, or this node) is mapped to one of them for the rest of the epoch. Inventory is pushed onto
+ * the outbound stem queue of its destination peer as soon as it is added, and SendMessages drains the queue
+ * of the peer it is serving. Stem expiry is driven by a timer wheel, so Process only touches the inventory
+ * that is due instead of everything that is being tracked.
+ */
 class DandelionInventory
 {
 private:
-    std::map<uint256, Stem> mapStemInventory;
-    std::set<uint256> setPendingSend; // Inventory that is ready to be sent
-    std::map<uint256, int64_t> mapNodeToSentTo; //Maps each tx to a next node to send to
+    //! Number of one second slots in the expiry wheel, stem ends further out wrap around
+    static constexpr int64_t STEM_WHEEL_SLOTS = 256;
+    //! Number of peers that stem inventory is routed to during an epoch
+    static constexpr size_t STEM_PEERS_PER_EPOCH = 2;
+
+    std::unordered_map<uint256, Stem, StemHasher> mapStemInventory;
+    std::vector<std::vector<uint256>> vStemWheel;
+    int64_t nTimeWheel = 0; // Last second the wheel was advanced to
+
+    int64_t nTimeEpochEnd = 0;
+    std::vector<int64_t> vStemPeers;
+    std::unordered_map<int64_t, int64_t> mapStemRoute; // Maps each source node to its stem peer for this epoch
+    std::unordered_map<int64_t, std::vector<uint256>> mapStemQueue; // Outbound stem inventory per peer
+    std::vector<uint256> vUnrouted; // Inventory that arrived while there was no stem peer to route it to
+
+    //! Protects all of the above, every public method takes it
+    mutable CCriticalSection cs;
+
+    bool Route(const uint256& hash, Stem& stem);
+    void NewEpoch(const std::vector<CNode*>& vNodes);
+    void ExpireStems(std::vector<uint256>& vFluff);
 public:
     const int64_t nDefaultStemTime = 120; //120 seconds
+    const int64_t nDefaultEpochTime = 600; //10 minutes
     //! Indicates the tx came from the current node
     const int64_t nDefaultNodeID = -1;
-    void Add(const uint256& hashInventory, const int64_t& nTimeStemEnd, const int64_t& nNodeIDFrom);
+    //! Indicates the inventory has not been queued for or sent to any node
+    const int64_t nNoNodeID = -2;
+
+    DandelionInventory();
+
+    /** Start tracking stem inventory, for at most nDefaultStemTime. Returns false if the stem phase has already ended. */
+    bool Add(const uint256& hashInventory, const int64_t& nTimeStemEnd, const int64_t& nNodeIDFrom);
     bool IsFromNode(const uint256& hash, const int64_t nNodeID) const;
-    bool IsNodePendingSend(const uint256& hashInventory, const int64_t nNodeID);
+    bool IsNodePendingSend(const uint256& hashInventory, const int64_t nNodeID) const;
     int64_t GetTimeStemPhaseEnd(const uint256& hashObject) const;
     bool IsInStemPhase(const uint256& hash) const;
     bool IsSent(const uint256& hash) const;
-    bool IsQueuedToSend(const uint256& hashObject) const;
     void SetInventorySent(const uint256& hash, const int64_t nNodeID);
-    void MarkSent(const uint256& hash);
-    void Process(const std::vector<CNode*>& vNodes);
-    bool IsCorrectNodeToSend(const uint256& hash, const int64_t nNodeID);
-
-    CCriticalSection cs;
+    /** Move the stem inventory queued for a node into vHashes and record it as sent to that node */
+    void GetStemInventoryToSend(const int64_t nNodeID, std::vector<uint256>& vHashes);
+    /** Refresh the epoch's stem peers if needed and return the inventory whose stem phase ended in vFluff */
+    void Process(const std::vector<CNode*>& vNodes, std::vector<uint256>& vFluff);
 };
 
 }
@@ -75,6 +75,15 @@ public:
         value = pos->second.first;
         return true;
     }
+
+    void erase(const K key) {
+        LOCK(cs_mycache);
+        auto pos = keyValuesMap.find(key);
+        if (pos == keyValuesMap.end())
+            return;
+        items.erase(pos->second.second);
+        keyValuesMap.erase(pos);
+    }
 };
 
 } // namespace veil
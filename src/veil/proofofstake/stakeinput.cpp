@@ -71,9 +71,46 @@ int GetSampleBits(int nSampleCount)
     }
 }
 
+CCriticalSection cs_stakeModifierCache;
+
+// The sample hash of a block never changes once its PoS hash is known, so it is only computed once. Every block is
+// sampled into the modifiers of ten later blocks, and for PoW blocks this saves recomputing the full PoW hash.
+static uint256 GetSampleHash(const CBlockIndex* pindexSample, bool& fCacheable)
+{
+    {
+        LOCK(cs_stakeModifierCache);
+        if (pindexSample->stakeModifierCache.fSampleHash)
+            return pindexSample->stakeModifierCache.hashSample;
+    }
+
+    //Get a sampling of entropy from this block. Rehash the sample, since PoW hashes may have lots of 0's
+    uint256 hashSample = GetHashFromIndex(pindexSample);
+    hashSample = Hash(hashSample.begin(), hashSample.end());
+
+    // A PoS block that is only known by its header has no PoS hash yet
+    if (pindexSample->IsProofOfStake() && pindexSample->vHashProof.empty()) {
+        fCacheable = false;
+        return hashSample;
+    }
+
+    LOCK(cs_stakeModifierCache);
+    pindexSample->stakeModifierCache.fSampleHash = true;
+    pindexSample->stakeModifierCache.hashSample = hashSample;
+    return hashSample;
+}
+
 bool GetStakeModifier(uint64_t& nStakeModifier, const CBlockIndex& pindexChainPrev)
 {
+    {
+        LOCK(cs_stakeModifierCache);
+        if (pindexChainPrev.stakeModifierCache.fModifier) {
+            nStakeModifier = pindexChainPrev.stakeModifierCache.nModifier;
+            return true;
+        }
+    }
+
     uint256 hashModifier;
+    bool fCacheable = true;
     //Use a new modifier that is less able to be "grinded"
     int nHeightChain = pindexChainPrev.nHeight;
     int nHeightPrevious = nHeightChain - 100;
@@ -83,9 +120,7 @@ bool GetStakeModifier(uint64_t& nStakeModifier, const CBlockIndex& pindexChainPr
         auto pindexSample = pindexChainPrev.GetAncestor(nHeightSample);
 
         if (!pindexSample) return false;
-        //Get a sampling of entropy from this block. Rehash the sample, since PoW hashes may have lots of 0's
-        uint256 hashSample = GetHashFromIndex(pindexSample);
-        hashSample = Hash(hashSample.begin(), hashSample.end());
+        uint256 hashSample = GetSampleHash(pindexSample, fCacheable);
 
         //Reduce the size of the sampling
         int nBitsToUse = GetSampleBits(i);
@@ -96,6 +131,11 @@ bool GetStakeModifier(uint64_t& nStakeModifier, const CBlockIndex& pindexChainPr
     }
 
     nStakeModifier = UintToArith256(hashModifier).GetLow64();
+    if (fCacheable) {
+        LOCK(cs_stakeModifierCache);
+        pindexChainPrev.stakeModifierCache.fModifier = true;
+        pindexChainPrev.stakeModifierCache.nModifier = nStakeModifier;
+    }
     return true;
 }
 
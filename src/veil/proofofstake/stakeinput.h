@@ -9,6 +9,7 @@
 #include "veil/zerocoin/accumulatormap.h"
 #include "chain.h"
 #include "streams.h"
+#include "sync.h"
 
 #include "libzerocoin/CoinSpend.h"
 
@@ -16,6 +17,11 @@ class CKeyStore;
 class CWallet;
 class CWalletTx;
 
+extern CCriticalSection cs_stakeModifierCache;
+
+/** Stake modifier of blocks staked on top of pindexChainPrev, sampled from ten of its ancestors. Cached on the block index. */
+bool GetStakeModifier(uint64_t& nStakeModifier, const CBlockIndex& pindexChainPrev);
+
 class CStakeInput
 {
 protected:
@@ -10,6 +10,7 @@
 
 #include <veil/ringct/blind.h>
 #include <veil/ringct/rctindex.h>
+#include <veil/validationstats.h>
 #include <txdb.h>
 #include <util/system.h>
 #include <validation.h>
@@ -21,6 +22,7 @@
 
 bool VerifyMLSAG(const CTransaction &tx, CValidationState &state)
 {
+    ValidationStageTimer timer(ValidationStage::MLSAG);
     int rv;
     std::set<int64_t> setHaveI; // Anon prev-outputs can only be used once per transaction.
     std::set<CCmpPubKey> setHaveKI;
@@ -116,7 +118,12 @@ bool VerifyMLSAG(const CTransaction &tx, CValidationState &state)
                     return state.DoS(100, false, REJECT_MALFORMED, "bad-anonin-dup-i");
 
                 CAnonOutput ao;
-                if (!pblocktree->ReadRCTOutput(nIndex, ao)) {
+                bool fFound;
+                {
+                    ValidationStageTimer timerRead(ValidationStage::RCT_OUTPUT_READ);
+                    fFound = pblocktree->ReadRCTOutput(nIndex, ao);
+                }
+                if (!fFound) {
                     return state.DoS(100, false, REJECT_MALFORMED, "bad-anonin-unknown-i");
                 }
 
@@ -127,7 +134,7 @@ bool VerifyMLSAG(const CTransaction &tx, CValidationState &state)
         }
 
         // checking for duplicate key image to prevent double spends
-        uint256 txhashKI;
+        std::vector<CCmpPubKey> vInputKeyImages;
         for (size_t k = 0; k < nInputs; ++k) {
             const CCmpPubKey &ki = *((CCmpPubKey*)&vKeyImages[k*33]);
 
@@ -139,8 +146,14 @@ bool VerifyMLSAG(const CTransaction &tx, CValidationState &state)
 //                return state.DoS(100, false, REJECT_INVALID, "bad-anonin-dup-ki-mempool");
 //            }
 
-            if (pblocktree->ReadRCTKeyImage(ki, txhashKI) && txhashKI != txhash) {
-                LogPrintf("%s: Key image in tx %s\n", __func__, txhashKI.GetHex());
+            vInputKeyImages.emplace_back(ki);
+        }
+
+        std::map<CCmpPubKey, uint256> mapSpentKeyImages;
+        pblocktree->ReadRCTKeyImages(vInputKeyImages, mapSpentKeyImages);
+        for (const auto &it : mapSpentKeyImages) {
+            if (it.second != txhash) {
+                LogPrintf("%s: Key image in tx %s\n", __func__, it.second.GetHex());
                 return state.DoS(100, false, REJECT_INVALID, "bad-anonin-dup-keyimage");
             }
         }
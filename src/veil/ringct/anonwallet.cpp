@@ -25,6 +25,7 @@
 #include <veil/invalid.h>
 #include <veil/ringct/blind.h>
 #include <veil/ringct/anon.h>
+#include <veil/ringct/decoyindex.h>
 #include <veil/ringct/watchonly.h>
 #include <veil/zerocoin/denomination_functions.h>
 #include <veil/zerocoin/zchain.h>
@@ -191,6 +192,7 @@ bool AnonWallet::Initialise(CExtKey* pExtMaster)
 void AnonWallet::AddToSpends(const COutPoint& outpoint, const uint256& wtxid)
 {
     mapTxSpends.insert(std::make_pair(outpoint, wtxid));
+    UpdateUnspentRecord(outpoint.hash);
 
 //    setLockedCoins.erase(outpoint);
 
@@ -205,6 +207,7 @@ void AnonWallet::LoadToWallet(const uint256 &hash, const CTransactionRecord &rtx
 
     MapRecords_t::iterator mri = ret.first;
     rtxOrdered.insert(std::make_pair(rtx.GetTxTime(), mri));
+    UpdateUnspentRecord(hash);
 
     // TODO: Spend only owned inputs?
 
@@ -492,7 +495,7 @@ void AnonWallet::ForgetUnusedStealthAddresses(int nBuffer)
         // Erase stealth address
         auto address = GenerateStealthAddressFromIndex(keyStealthAddress, 0);
         wdb.EraseStealthAddress(address);
-        mapStealthAddresses.erase(address.GetID());
+        RemoveStealthAddress(address.GetID());
         mapKeyPaths.erase(address.GetID());
 
         // Erase account
@@ -513,26 +516,26 @@ bool AnonWallet::ImportStealthAddress(const CStealthAddress &sxAddr, const CKey
     LOCK(pwalletParent->cs_wallet);
 
     // Must add before changing spend_secret
-    mapStealthAddresses.emplace(sxAddr.GetID(), sxAddr);
+    InsertStealthAddress(sxAddr);
 
     bool fOwned = skSpend.IsValid();
 
     if (fOwned) {
         // Owned addresses can only be added when wallet is unlocked
         if (IsLocked()) {
-            mapStealthAddresses.erase(sxAddr.GetID());
+            RemoveStealthAddress(sxAddr.GetID());
             return werror("%s: Wallet must be unlocked.", __func__);
         }
 
         CPubKey pk = skSpend.GetPubKey();
         if (!pwalletParent->AddKeyPubKey(skSpend, pk)) {
-            mapStealthAddresses.erase(sxAddr.GetID());
+            RemoveStealthAddress(sxAddr.GetID());
             return werror("%s: AddKeyPubKey failed.", __func__);
         }
     }
 
     if (!AnonWalletDB(*walletDatabase).WriteStealthAddress(sxAddr)) {
-        mapStealthAddresses.erase(sxAddr.GetID());
+        RemoveStealthAddress(sxAddr.GetID());
         return werror("%s: WriteStealthAddress failed.", __func__);
     }
 
@@ -979,9 +982,11 @@ CAmount AnonWallet::GetBalance(const isminefilter& filter, const int min_depth)
 
     LOCK2(cs_main, pwalletParent->cs_wallet);
 
-    for (const auto &ri : mapRecords) {
-        const uint256 &txhash = ri.first;
-        const CTransactionRecord &rtx = ri.second;
+    for (const uint256 &txhash : setUnspentRecords) {
+        MapRecords_t::const_iterator mri = mapRecords.find(txhash);
+        if (mri == mapRecords.end())
+            continue;
+        const CTransactionRecord &rtx = mri->second;
         if (!IsTrusted(txhash, rtx.blockHash, rtx.nIndex) || GetDepthInMainChain(rtx.blockHash, rtx.nIndex) < min_depth)
             continue;
 
@@ -1038,10 +1043,12 @@ CAmount AnonWallet::GetUnconfirmedBalance() const
 
     LOCK2(cs_main, pwalletParent->cs_wallet);
 
-    for (const auto &ri : mapRecords)
+    for (const uint256 &txhash : setUnspentRecords)
     {
-        const auto &txhash = ri.first;
-        const auto &rtx = ri.second;
+        MapRecords_t::const_iterator mri = mapRecords.find(txhash);
+        if (mri == mapRecords.end())
+            continue;
+        const auto &rtx = mri->second;
 
         if (IsTrusted(txhash, rtx.blockHash))
             continue;
@@ -1069,10 +1076,12 @@ CAmount AnonWallet::GetBlindBalance(const int min_depth)
 
     LOCK2(cs_main, pwalletParent->cs_wallet);
 
-    for (const auto &ri : mapRecords)
+    for (const uint256 &txhash : setUnspentRecords)
     {
-        const auto &txhash = ri.first;
-        const auto &rtx = ri.second;
+        MapRecords_t::const_iterator mri = mapRecords.find(txhash);
+        if (mri == mapRecords.end())
+            continue;
+        const auto &rtx = mri->second;
         int nDepth = GetDepthInMainChain(rtx.blockHash, 0);
 
         if (!IsTrusted(txhash, rtx.blockHash))
@@ -1099,10 +1108,12 @@ CAmount AnonWallet::GetAnonBalance(const int min_depth)
     CAmount nBalance = 0;
 
     LOCK2(cs_main, pwalletParent->cs_wallet);
-    for (const auto &ri : mapRecords)
+    for (const uint256 &txhash : setUnspentRecords)
     {
-        const auto &txhash = ri.first;
-        const auto &rtx = ri.second;
+        MapRecords_t::const_iterator mri = mapRecords.find(txhash);
+        if (mri == mapRecords.end())
+            continue;
+        const auto &rtx = mri->second;
         int nDepth = GetDepthInMainChain(rtx.blockHash, 0);
 
         if (!IsTrusted(txhash, rtx.blockHash))
@@ -1125,14 +1136,33 @@ CAmount AnonWallet::GetAnonBalance(const int min_depth)
     return nBalance;
 }
 
+static void AddBalances(BalanceList &bal, const BalanceList &balAnon)
+{
+    bal.nCT += balAnon.nCT;
+    bal.nCTUnconf += balAnon.nCTUnconf;
+    bal.nCTImmature += balAnon.nCTImmature;
+    bal.nRingCT += balAnon.nRingCT;
+    bal.nRingCTUnconf += balAnon.nRingCTUnconf;
+    bal.nRingCTImmature += balAnon.nRingCTImmature;
+}
+
 bool AnonWallet::GetBalances(BalanceList &bal)
 {
     assert(pwalletParent);
     LOCK2(cs_main, pwalletParent->cs_wallet);
 
-    for (const auto &ri : mapRecords) {
-        const auto &txhash = ri.first;
-        const auto &rtx = ri.second;
+    unsigned int nMempoolUpdated = mempool.GetTransactionsUpdated();
+    if (fBalancesCached && pindexBalancesCached == chainActive.Tip() && nMempoolUpdatedBalancesCached == nMempoolUpdated) {
+        AddBalances(bal, balancesCached);
+        return true;
+    }
+
+    BalanceList balAnon;
+    for (const uint256 &txhash : setUnspentRecords) {
+        MapRecords_t::const_iterator mri = mapRecords.find(txhash);
+        if (mri == mapRecords.end())
+            continue;
+        const auto &rtx = mri->second;
 
         bool fTrusted = IsTrusted(txhash, rtx.blockHash);
         int nDepth = GetDepthInMainChain(rtx.blockHash, 0);
@@ -1153,21 +1183,21 @@ bool AnonWallet::GetBalances(BalanceList &bal)
                     if (!(r.nFlags & ORF_OWNED) || r.IsSpent())
                         continue;
                     if (fTrusted && !fConfirmed)
-                        bal.nRingCTImmature += r.GetAmount();
+                        balAnon.nRingCTImmature += r.GetAmount();
                     else if (fTrusted && fConfirmed)
-                        bal.nRingCT += r.GetAmount();
+                        balAnon.nRingCT += r.GetAmount();
                     else if (fInMempool)
-                        bal.nRingCTUnconf += r.GetAmount();
+                        balAnon.nRingCTUnconf += r.GetAmount();
                     break;
                 case OUTPUT_CT:
                     if (!(r.nFlags & ORF_OWNED) || r.IsSpent())
                         continue;
                     if(fTrusted && !fConfirmed)
-                        bal.nCTImmature += r.GetAmount();
+                        balAnon.nCTImmature += r.GetAmount();
                     else if (fTrusted && fConfirmed)
-                        bal.nCT += r.GetAmount();
+                        balAnon.nCT += r.GetAmount();
                     else if (fInMempool)
-                        bal.nCTUnconf += r.GetAmount();
+                        balAnon.nCTUnconf += r.GetAmount();
                     break;
                 case OUTPUT_STANDARD:
                     break;
@@ -1180,6 +1210,12 @@ bool AnonWallet::GetBalances(BalanceList &bal)
     //if (!MoneyRange(nBalance))
     //    throw std::runtime_error(std::string(__func__) + ": value out of range");
 
+    balancesCached = balAnon;
+    pindexBalancesCached = chainActive.Tip();
+    nMempoolUpdatedBalancesCached = nMempoolUpdated;
+    fBalancesCached = true;
+
+    AddBalances(bal, balAnon);
     return true;
 };
 
@@ -1869,9 +1905,49 @@ bool AnonWallet::SaveRecord(const uint256& txid, const CTransactionRecord& rtx)
     if (!wdb.WriteTxRecord(txid, rtx))
         return error("%s: failed to write tx record\n", __func__);
     mapRecords[txid] = rtx;
+    UpdateUnspentRecord(txid);
     return true;
 }
 
+void AnonWallet::UpdateUnspentRecord(const uint256& txid)
+{
+    fBalancesCached = false;
+
+    // Outputs flagged spent are kept while their spenders may be conflicted, IsSpent decides when they are walked
+    MapRecords_t::const_iterator mri = mapRecords.find(txid);
+    if (mri != mapRecords.end()) {
+        for (const auto &r : mri->second.vout) {
+            if ((r.nFlags & ORF_OWN_ANY) && (!r.IsSpent(false) || !HasUnconflictedSpend(COutPoint(txid, r.n)))) {
+                setUnspentRecords.insert(txid);
+                return;
+            }
+        }
+    }
+    setUnspentRecords.erase(txid);
+}
+
+bool AnonWallet::HasUnconflictedSpend(const COutPoint& outpoint) const
+{
+    std::pair<TxSpends::const_iterator, TxSpends::const_iterator> range = mapTxSpends.equal_range(outpoint);
+    if (range.first == range.second)
+        return true; // IsSpent goes by the output's flag
+
+    // Mirrors IsSpent, where only conflicted (nIndex -1) or abandoned spenders can leave the output unspent
+    for (TxSpends::const_iterator it = range.first; it != range.second; ++it) {
+        MapRecords_t::const_iterator rit = mapRecords.find(it->second);
+        if (rit == mapRecords.end())
+            return true;
+        const COutputRecord* outRecord = rit->second.GetOutput(outpoint.n);
+        if (!outRecord || outRecord->IsSpent())
+            return true;
+        if (rit->second.IsAbandoned())
+            continue;
+        if (rit->second.nIndex != -1 || rit->second.HashUnset())
+            return true;
+    }
+    return false;
+}
+
 bool GetScriptPubKeyFromOutpoint(const COutPoint& outpoint, CScript& scriptPubKey)
 {
     //output record does not have the signing key, find it manually
@@ -3065,8 +3141,6 @@ bool AnonWallet::PickHidingOutputs(std::vector<std::vector<int64_t> > &vMI, size
         return error("%s: %s", __func__, sError);
     }
 
-    int nBestHeight = chainActive.Tip()->nHeight;
-    const Consensus::Params& consensusParams = Params().GetConsensus();
     size_t nInputs = vMI.size();
 
     int64_t nLastRCTOutIndex = 0;
@@ -3090,62 +3164,14 @@ bool AnonWallet::PickHidingOutputs(std::vector<std::vector<int64_t> > &vMI, size
             continue;
         }
 
-        int64_t nMinIndex = 1;
-        if (GetRandInt(100) < 50) { // 50% chance of selecting from the last 2400
-            nMinIndex = std::max((int64_t)1, nLastRCTOutIndex - nRCTOutSelectionGroup1);
-        } else if (GetRandInt(100) < 70) { // further 70% chance of selecting from the last 24000
-            nMinIndex = std::max((int64_t)1, nLastRCTOutIndex - nRCTOutSelectionGroup2);
-        }
-
-        int64_t nLastDepthCheckPassed = 0;
-        size_t j = 0;
-        const static size_t nMaxTries = 1000;
-        for (j = 0; j < nMaxTries; ++j) {
-            if (nLastRCTOutIndex <= nMinIndex) {
-                sError = strprintf("Not enough anonymous outputs exist, min: %d, last: %d, required: %d.",
-                                   nMinIndex, nLastRCTOutIndex, nInputs * nRingSize);
-                return error("%s: %s", __func__, sError);
-            }
-
-            int64_t nDecoy = nMinIndex + GetRand((nLastRCTOutIndex - nMinIndex) + 1);
-
-            if (setHave.count(nDecoy) > 0) {
-                if (nDecoy == nLastRCTOutIndex) {
-                    nLastRCTOutIndex--;
-                }
-                continue;
-            }
-
-            CAnonOutput ao;
-            if (!pblocktree->ReadRCTOutput(nDecoy, ao)) {
-                sError = strprintf("Anonymous output not found in database: %s.", nDecoy);
-                return error("%s: %s", __func__, sError);
-            }
-
-            //Don't mix in blacklisted decoys
-            if (blacklist::ContainsRingCtOutPoint(ao.outpoint))
-                continue;
-
-            if (nDecoy > nLastDepthCheckPassed) {
-                if (ao.nBlockHeight > nBestHeight - (consensusParams.nMinRCTOutputDepth + nExtraDepth)) {
-                    if (nLastRCTOutIndex > nDecoy) {
-                        nLastRCTOutIndex = nDecoy-1;
-                    }
-                    continue;
-                }
-
-                nLastDepthCheckPassed = nDecoy;
-            }
-
-            vMI[k][i] = nDecoy;
-            setHave.insert(nDecoy);
-            break;
-        }
-
-        if (j >= nMaxTries) {
-            sError = strprintf("Exceeded maximum tries for picking hiding outputs (%d, %d).", k, i);
+        int64_t nDecoy;
+        if (!decoyIndex.PickDecoy(nRCTOutSelectionGroup1, nRCTOutSelectionGroup2, nExtraDepth, setHave, nDecoy, sError)) {
+            sError = strprintf("%s (%d, %d)", sError, k, i);
             return error("%s: %s", __func__, sError);
         }
+
+        vMI[k][i] = nDecoy;
+        setHave.insert(nDecoy);
     }
 
     return true;
@@ -3159,8 +3185,6 @@ bool AnonWallet::GetRandomHidingOutputs(size_t nInputSize, size_t nRingSize, std
         return error("%s: %s", __func__, sError);
     }
 
-    int nBestHeight = chainActive.Tip()->nHeight;
-    const Consensus::Params& consensusParams = Params().GetConsensus();
     size_t nInputs = nInputSize;
 
     int64_t nLastRCTOutIndex = 0;
@@ -3179,65 +3203,23 @@ bool AnonWallet::GetRandomHidingOutputs(size_t nInputSize, size_t nRingSize, std
 
     for (size_t k = 0; k < nInputs; ++k) {
         for (size_t i = 0; i < nRingSize; ++i) {
-
-            int64_t nMinIndex = 1;
-            if (GetRandInt(100) < 50) { // 50% chance of selecting from the last 2400
-                nMinIndex = std::max((int64_t) 1, nLastRCTOutIndex - nRCTOutSelectionGroup1);
-            } else if (GetRandInt(100) < 70) { // further 70% chance of selecting from the last 24000
-                nMinIndex = std::max((int64_t) 1, nLastRCTOutIndex - nRCTOutSelectionGroup2);
-            }
-
-            int64_t nLastDepthCheckPassed = 0;
-            size_t j = 0;
-            const static size_t nMaxTries = 1000;
-            for (j = 0; j < nMaxTries; ++j) {
-                if (nLastRCTOutIndex <= nMinIndex) {
-                    sError = strprintf("Not enough anonymous outputs exist, min: last: %d, required: %d.",
-                                       nMinIndex, nLastRCTOutIndex, nInputs * nRingSize);
-                    return error("%s: %s", __func__, sError);
-                }
-
-                int64_t nDecoy = nMinIndex + GetRand((nLastRCTOutIndex - nMinIndex) + 1);
-
-                if (setHave.count(nDecoy) > 0) {
-                    if (nDecoy == nLastRCTOutIndex) {
-                        nLastRCTOutIndex--;
-                    }
-                    continue;
-                }
-
-                CAnonOutput ao;
-                if (!pblocktree->ReadRCTOutput(nDecoy, ao)) {
-                    sError = strprintf("Anonymous output not found in database: %s.", nDecoy);
-                    return error("%s: %s", __func__, sError);
-                }
-
-                //Don't mix in blacklisted decoys
-                if (blacklist::ContainsRingCtOutPoint(ao.outpoint))
-                    continue;
-
-                if (nDecoy > nLastDepthCheckPassed) {
-                    if (ao.nBlockHeight > nBestHeight - (consensusParams.nMinRCTOutputDepth + nExtraDepth)) {
-                        if (nLastRCTOutIndex > nDecoy) {
-                            nLastRCTOutIndex = nDecoy - 1;
-                        }
-                        continue;
-                    }
-
-                    nLastDepthCheckPassed = nDecoy;
-                }
-                CLightWalletAnonOutputData tempData;
-                tempData.index = nDecoy,
-                tempData.output = ao;
-                randomoutputs.emplace_back(tempData);
-                setHave.insert(nDecoy);
-                break;
+            int64_t nDecoy;
+            if (!decoyIndex.PickDecoy(nRCTOutSelectionGroup1, nRCTOutSelectionGroup2, nExtraDepth, setHave, nDecoy, sError)) {
+                sError = strprintf("%s (%d, %d)", sError, k, i);
+                return error("%s: %s", __func__, sError);
             }
 
-            if (j >= nMaxTries) {
-                sError = strprintf("Exceeded maximum tries for picking hiding outputs (%d, %d).", k, i);
+            CAnonOutput ao;
+            if (!pblocktree->ReadRCTOutput(nDecoy, ao)) {
+                sError = strprintf("Anonymous output not found in database: %s.", nDecoy);
                 return error("%s: %s", __func__, sError);
             }
+
+            CLightWalletAnonOutputData tempData;
+            tempData.index = nDecoy;
+            tempData.output = ao;
+            randomoutputs.emplace_back(tempData);
+            setHave.insert(nDecoy);
         }
     }
 
@@ -4428,7 +4410,7 @@ bool AnonWallet::NewStealthKey(CStealthAddress& stealthAddress, uint32_t nPrefix
     //Record stealth address to db
     if (!AnonWalletDB(*walletDatabase).WriteStealthAddress(stealthAddress))
         return error("%s: failed to write stealth address to db", __func__);
-    mapStealthAddresses.emplace(stealthAddress.GetID(), stealthAddress);
+    InsertStealthAddress(stealthAddress);
 
     return true;
 }
@@ -4474,7 +4456,7 @@ int AnonWallet::LoadStealthAddresses()
         CStealthAddress stealthAddress;
         ssValue >> stealthAddress;
         auto idStealth = stealthAddress.GetID();
-        mapStealthAddresses.emplace(idStealth, stealthAddress);
+        InsertStealthAddress(stealthAddress);
 
         //If the stealth address has stealth destinations load them too
         if (stealthAddress.setStealthDestinations.empty())
@@ -4728,6 +4710,7 @@ bool AnonWallet::ProcessLockedBlindedOutputs()
                 || !wdb.WriteStoredTx(op.hash, stx)) {
                 return false;
             }
+            UpdateUnspentRecord(op.hash);
 
             setChanged.insert(op.hash);
         }
@@ -4748,20 +4731,6 @@ bool AnonWallet::ProcessLockedBlindedOutputs()
     return true;
 }
 
-inline bool MatchPrefix(uint32_t nAddrBits, uint32_t addrPrefix, uint32_t outputPrefix, bool fHavePrefix)
-{
-    if (nAddrBits < 1) { // addresses without prefixes scan all incoming stealth outputs
-        return true;
-    }
-    if (!fHavePrefix) { // don't check when address has a prefix and no prefix on output
-        return false;
-    }
-
-    uint32_t mask = SetStealthMask(nAddrBits);
-
-    return (addrPrefix & mask) == (outputPrefix & mask);
-}
-
 //Veil
 bool AnonWallet::AddStealthDestination(const CKeyID& idStealthAddress, const CKeyID& idStealthDestination)
 {
@@ -4846,20 +4815,45 @@ bool AnonWallet::ProcessStealthOutput(const CTxDestination &address, std::vector
         return true;
     }
 
+    // Only the stealth addresses whose prefix can match the output's are looked at. When a rescan already matched
+    // this output only the address it was sent to, if any, is left.
+    std::vector<CKeyID> vCandidates;
+    const CStealthMatches::OutputKey key(idStealthDestination, vchEphemPK);
+    if (stealthMatches.nGeneration == nStealthAddressesGeneration && stealthMatches.setMatched.count(key)) {
+        auto it = stealthMatches.mapOwned.find(key);
+        if (it == stealthMatches.mapOwned.end())
+            return false;
+        vCandidates.emplace_back(it->second);
+    } else {
+        stealthPrefixIndex.GetCandidates(prefix, fHavePrefix, vCandidates);
+    }
+    if (vCandidates.empty())
+        return false;
+
+    // The ephemeral pubkey is the same for every candidate, decompress it once
+    secp256k1_pubkey pkEphem;
+    if (!StealthParsePubKey(vchEphemPK, pkEphem)) {
+        LogPrintf("%s: Invalid ephemeral pubkey.\n", __func__);
+        return false;
+    }
+
     // Iterate through owned stealth addresses to see if this was sent to one of them (note: the address sent to is
     // extracted from the stealth address in a deterministic way, so the owned addresses are calculate the changes to
     // see if there is a match, if so the key belongs to us
-    for (auto mi = mapStealthAddresses.begin(); mi != mapStealthAddresses.end(); ++mi) {
-        auto* addr = &mi->second;
-        if (!MatchPrefix(addr->prefix.number_bits, addr->prefix.bitfield, prefix, fHavePrefix)) {
+    for (const CKeyID& idStealth : vCandidates) {
+        auto mi = mapStealthAddresses.find(idStealth);
+        if (mi == mapStealthAddresses.end()) {
             continue;
         }
+        auto* addr = &mi->second;
 
         if (!addr->scan_secret.IsValid()) {
             continue; // stealth address is not owned
         }
 
-        if (StealthSecret(addr->scan_secret, vchEphemPK, addr->spend_pubkey, sShared, pkExtracted) != 0) {
+        secp256k1_pubkey pkSpend;
+        if (!StealthParsePubKey(addr->spend_pubkey, pkSpend)
+            || StealthSecret(addr->scan_secret, pkEphem, pkSpend, sShared, pkExtracted) != 0) {
             LogPrintf("%s: StealthSecret failed.\n", __func__);
             continue;
         }
@@ -4935,6 +4929,150 @@ bool AnonWallet::ProcessStealthOutput(const CTxDestination &address, std::vector
     return false;
 }
 
+void AnonWallet::InsertStealthAddress(const CStealthAddress& sx)
+{
+    if (mapStealthAddresses.emplace(sx.GetID(), sx).second) {
+        stealthPrefixIndex.Add(sx);
+        nStealthAddressesGeneration++;
+    }
+}
+
+void AnonWallet::RemoveStealthAddress(const CKeyID& idStealth)
+{
+    auto mi = mapStealthAddresses.find(idStealth);
+    if (mi == mapStealthAddresses.end())
+        return;
+    stealthPrefixIndex.Remove(mi->second);
+    mapStealthAddresses.erase(mi);
+    nStealthAddressesGeneration++;
+}
+
+std::vector<CStealthAddress> AnonWallet::GetStealthAddressesForMatching(uint64_t& nGeneration) const
+{
+    AssertLockHeld(pwalletParent->cs_wallet);
+
+    nGeneration = nStealthAddressesGeneration;
+    std::vector<CStealthAddress> vStealthAddresses;
+    vStealthAddresses.reserve(mapStealthAddresses.size());
+    for (const auto& mi : mapStealthAddresses) {
+        vStealthAddresses.emplace_back(mi.second);
+        vStealthAddresses.back().setStealthDestinations.clear(); // not needed for matching and can be large
+    }
+    return vStealthAddresses;
+}
+
+/**
+ * Get the stealth destination, ephemeral pubkey and prefix of an output the same way ScanForOwnedOutputs and
+ * CheckForStealthAndNarration read them. pnext is the output after txout, a standard output carries its stealth
+ * data in the data output that follows it.
+ */
+static bool GetStealthOutputData(const CTxOutBase* txout, const CTxOutBase* pnext, CKeyID& idDestination,
+                                 ec_point& vchEphemPK, uint32_t& prefix, bool& fHavePrefix)
+{
+    prefix = 0;
+    fHavePrefix = false;
+
+    const std::vector<uint8_t>* pvData;
+    CTxDestination address;
+    if (txout->IsType(OUTPUT_CT)) {
+        const CTxOutCT* ctout = (const CTxOutCT*)txout;
+        if (!ExtractDestination(ctout->scriptPubKey, address) || address.type() != typeid(CKeyID))
+            return false;
+        idDestination = boost::get<CKeyID>(address);
+        pvData = &ctout->vData;
+    } else if (txout->IsType(OUTPUT_RINGCT)) {
+        const CTxOutRingCT* rctout = (const CTxOutRingCT*)txout;
+        idDestination = rctout->pk.GetID();
+        pvData = &rctout->vData;
+    } else if (txout->IsType(OUTPUT_STANDARD) && pnext && pnext->IsType(OUTPUT_DATA)) {
+        const std::vector<uint8_t>& vData = ((const CTxOutData*)pnext)->vData;
+        if (vData.size() < 34 || vData[0] != DO_STEALTH)
+            return false;
+        if (!ExtractDestination(((const CTxOutStandard*)txout)->scriptPubKey, address) || address.type() != typeid(CKeyID))
+            return false;
+        idDestination = boost::get<CKeyID>(address);
+        vchEphemPK.assign(vData.begin() + 1, vData.begin() + 34);
+        if (vData.size() >= 34 + 5 && vData[34] == DO_STEALTH_PREFIX) {
+            fHavePrefix = true;
+            memcpy(&prefix, &vData[35], 4);
+        }
+        return true;
+    } else {
+        return false;
+    }
+
+    const std::vector<uint8_t>& vData = *pvData;
+    if (vData.size() != 33) {
+        if (vData.size() != 38 || vData[33] != DO_STEALTH_PREFIX)
+            return false;
+        fHavePrefix = true;
+        memcpy(&prefix, &vData[34], 4);
+    }
+    vchEphemPK.assign(vData.begin(), vData.begin() + 33);
+    return true;
+}
+
+CStealthOutputMatcher::CStealthOutputMatcher(const std::vector<CStealthAddress>& vStealthAddresses, uint64_t nGenerationIn)
+    : nGeneration(nGenerationIn)
+{
+    for (const CStealthAddress& sx : vStealthAddresses) {
+        Entry entry;
+        if (!sx.scan_secret.IsValid() || !StealthParsePubKey(sx.spend_pubkey, entry.pkSpend))
+            continue;
+        entry.sx = sx;
+        if (mapAddresses.emplace(sx.GetID(), std::move(entry)).second)
+            prefixIndex.Add(sx);
+    }
+}
+
+void CStealthOutputMatcher::Match(const CTransaction& tx, CStealthMatches& matches) const
+{
+    matches.nGeneration = nGeneration;
+
+    std::vector<CKeyID> vCandidates;
+    for (size_t i = 0; i < tx.vpout.size(); i++) {
+        CStealthMatches::OutputKey key;
+        uint32_t prefix;
+        bool fHavePrefix;
+        const CTxOutBase* pnext = i + 1 < tx.vpout.size() ? tx.vpout[i + 1].get() : nullptr;
+        if (!GetStealthOutputData(tx.vpout[i].get(), pnext, key.first, key.second, prefix, fHavePrefix))
+            continue;
+        if (!matches.setMatched.insert(key).second)
+            continue;
+
+        vCandidates.clear();
+        prefixIndex.GetCandidates(prefix, fHavePrefix, vCandidates);
+        secp256k1_pubkey pkEphem;
+        if (vCandidates.empty() || !StealthParsePubKey(key.second, pkEphem))
+            continue;
+
+        for (const CKeyID& idStealth : vCandidates) {
+            const Entry& entry = mapAddresses.at(idStealth);
+            CKey sShared;
+            ec_point pkExtracted;
+            if (StealthSecret(entry.sx.scan_secret, pkEphem, entry.pkSpend, sShared, pkExtracted) != 0)
+                continue;
+            CPubKey pubKeyStealthSecret(pkExtracted);
+            if (pubKeyStealthSecret.IsValid() && pubKeyStealthSecret.GetID() == key.first) {
+                matches.mapOwned.emplace(key, idStealth);
+                break;
+            }
+        }
+    }
+}
+
+void AnonWallet::SetStealthMatches(CStealthMatches&& matches)
+{
+    AssertLockHeld(pwalletParent->cs_wallet);
+    stealthMatches = std::move(matches);
+}
+
+void AnonWallet::ClearStealthMatches()
+{
+    AssertLockHeld(pwalletParent->cs_wallet);
+    stealthMatches.Clear();
+}
+
 int AnonWallet::CheckForStealthAndNarration(const CTxOutBase *pb, const CTxOutData *pdata, std::string &sNarr)
 {
     // returns: -1 error, 0 nothing found, 1 narration, 2 stealth
@@ -5218,6 +5356,7 @@ void AnonWallet::RescanWallet()
                         outrecord->MarkPendingSpend(false);
 
                         wdb.WriteTxRecord(input.hash, *txrecord_input);
+                        UpdateUnspentRecord(input.hash);
                         LogPrintf("%s: Marking %s as unspent\n", __func__, input.ToString());
                     }
                 }
@@ -5353,6 +5492,7 @@ void AnonWallet::RescanWallet()
 
             if (fUpdated) {
                 wdb.WriteTxRecord(txid, *txrecord);
+                UpdateUnspentRecord(txid);
                 transactionUpdated = true;
             }
         }
@@ -5394,6 +5534,7 @@ void AnonWallet::RescanWallet()
     for (const uint256& txid : setErase) {
         mapRecords.erase(txid);
         mapLockedRecords.erase(txid);
+        UpdateUnspentRecord(txid);
         wdb.EraseTxRecord(txid);
         pwalletParent->NotifyTransactionChanged(pwalletParent.get(), txid, CT_DELETED);
     }
@@ -6029,6 +6170,7 @@ bool AnonWallet::AddToRecord(CTransactionRecord &rtxIn, const CTransaction &tx,
             || !wdb.WriteStoredTx(txhash, stx)) {
             return false;
         }
+        UpdateUnspentRecord(txhash);
     }
 
     return true;
@@ -6112,8 +6254,10 @@ void AnonWallet::AvailableBlindedCoins(std::vector<COutputR>& vCoins, bool fOnly
 
     CAmount nTotal = 0;
 
-    for (MapRecords_t::const_iterator it = mapRecords.begin(); it != mapRecords.end(); ++it) {
-        const uint256 &txid = it->first;
+    for (const uint256 &txid : setUnspentRecords) {
+        MapRecords_t::const_iterator it = mapRecords.find(txid);
+        if (it == mapRecords.end())
+            continue;
         const CTransactionRecord &rtx = it->second;
 
         // TODO: implement when moving coinbase and coinstake txns to mapRecords
@@ -6289,8 +6433,10 @@ void AnonWallet::AvailableAnonCoins(std::vector<COutputR> &vCoins, bool fOnlySaf
     CAmount nTotal = 0;
 
     const Consensus::Params& consensusParams = Params().GetConsensus();
-    for (MapRecords_t::const_iterator it = mapRecords.begin(); it != mapRecords.end(); ++it) {
-        const uint256 &txid = it->first;
+    for (const uint256 &txid : setUnspentRecords) {
+        MapRecords_t::const_iterator it = mapRecords.find(txid);
+        if (it == mapRecords.end())
+            continue;
         const CTransactionRecord &rtx = it->second;
 
         // TODO: implement when moving coinbase and coinstake txns to mapRecords
@@ -6747,6 +6893,7 @@ void AnonWallet::MarkConflicted(const uint256 &hashBlock, const uint256 &hashTx)
     todo.insert(hashTx);
 
     size_t nChangedRecords = 0;
+    std::set<uint256> setConflicted;
     while (!todo.empty()) {
         uint256 now = *todo.begin();
         todo.erase(now);
@@ -6762,6 +6909,8 @@ void AnonWallet::MarkConflicted(const uint256 &hashBlock, const uint256 &hashTx)
                 rtx.nIndex = -1;
                 rtx.blockHash = hashBlock;
                 walletdb.WriteTxRecord(now, rtx);
+                UpdateUnspentRecord(now);
+                setConflicted.insert(now);
 
                 // Iterate over all its outputs, and mark transactions in the wallet that spend them conflicted too
                 TxSpends::const_iterator iter = mapTxSpends.lower_bound(COutPoint(now, 0));
@@ -6779,6 +6928,17 @@ void AnonWallet::MarkConflicted(const uint256 &hashBlock, const uint256 &hashTx)
         LogPrintf("%s: Warning txn %s not recorded in wallet.\n", __func__, now.ToString());
     }
 
+    // The outputs the conflicted transactions spent may count as unspent again
+    if (!setConflicted.empty()) {
+        std::set<uint256> setSpent;
+        for (const auto &spend : mapTxSpends) {
+            if (setConflicted.count(spend.second))
+                setSpent.insert(spend.first.hash);
+        }
+        for (const uint256 &txid : setSpent)
+            UpdateUnspentRecord(txid);
+    }
+
 //    if (nChangedRecords > 0) // HACK, alternative is to load CStoredTransaction to get vin
 //        MarkDirty();
 }
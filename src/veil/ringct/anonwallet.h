@@ -99,6 +99,53 @@ public:
     };
 };
 
+/**
+ * The stealth outputs of a block matched against a copy of the owned stealth addresses by CStealthOutputMatcher.
+ * Matching does not need the wallet, so a rescan does it for the next blocks on other threads while the current
+ * one is added to the wallet, and ProcessStealthOutput only looks up the result.
+ */
+struct CStealthMatches
+{
+    typedef std::pair<CKeyID, ec_point> OutputKey; // stealth destination, ephemeral pubkey
+
+    //! AnonWallet::nStealthAddressesGeneration of the stealth addresses the outputs were matched against
+    uint64_t nGeneration = 0;
+    //! Every output that was matched, owned or not
+    std::set<OutputKey> setMatched;
+    //! Owned outputs and the stealth address they were sent to
+    std::map<OutputKey, CKeyID> mapOwned;
+
+    void Clear()
+    {
+        nGeneration = 0;
+        setMatched.clear();
+        mapOwned.clear();
+    }
+};
+
+/**
+ * Matches stealth outputs against a copy of the owned stealth addresses, see AnonWallet::GetStealthAddressesForMatching.
+ * It does not use the wallet and Match may be called from several threads at once.
+ */
+class CStealthOutputMatcher
+{
+private:
+    struct Entry
+    {
+        CStealthAddress sx;
+        secp256k1_pubkey pkSpend;
+    };
+    std::map<CKeyID, Entry> mapAddresses; // addresses with a scan secret
+    CStealthPrefixIndex prefixIndex;
+    uint64_t nGeneration;
+
+public:
+    CStealthOutputMatcher(const std::vector<CStealthAddress>& vStealthAddresses, uint64_t nGenerationIn);
+
+    /** Match the stealth outputs of tx, adding them to matches */
+    void Match(const CTransaction& tx, CStealthMatches& matches) const;
+};
+
 class AnonWallet
 {
     std::shared_ptr<WalletDatabase> walletDatabase;
@@ -108,6 +155,9 @@ class AnonWallet
 
     std::map<CKeyID, CStealthAddress> mapStealthAddresses;
     std::map<CKeyID, CKeyID> mapStealthDestinations; // [stealthdest, stealth addr] Destinations created by external wallets that are derived from our wallet's stealth address
+    CStealthPrefixIndex stealthPrefixIndex; // mapStealthAddresses by prefix
+    uint64_t nStealthAddressesGeneration = 0; // Changes with mapStealthAddresses, tells whether stealthMatches are stale
+    CStealthMatches stealthMatches; // Outputs of the block being rescanned that were already matched
 
     std::unique_ptr<CExtKey> pkeyMaster;
     CKeyID idMaster;
@@ -222,6 +272,10 @@ public:
 
     /** Update wallet after successful transaction */
     bool SaveRecord(const uint256& txid, const CTransactionRecord& rtx);
+    /** Update setUnspentRecords for a record that was added, changed or erased, and drop the cached balances */
+    void UpdateUnspentRecord(const uint256& txid);
+    /** Whether a wallet transaction spends the outpoint and is neither conflicted nor abandoned, IsSpent then holds on any chain */
+    bool HasUnconflictedSpend(const COutPoint& outpoint) const;
     int AddStandardInputs(CWalletTx &wtx, CTransactionRecord &rtx, std::vector<CTempRecipient> &vecSend, bool sign,
             CAmount &nFeeRet, const CCoinControl *coinControl, std::string &sError, bool fZerocoinInputs, CAmount nInputValue);
     int AddStandardInputs_Inner(CWalletTx &wtx, CTransactionRecord &rtx, std::vector<CTempRecipient> &vecSend, bool sign,
@@ -301,6 +355,12 @@ public:
     bool ProcessStealthOutput(const CTxDestination &address,
         std::vector<uint8_t> &vchEphemPK, uint32_t prefix, bool fHavePrefix, CKey &sShared, CWatchOnlyTx& watchOnlyOutput, bool fNeedShared=false);
 
+    /** Copy the owned stealth addresses and their generation for a CStealthOutputMatcher. Requires cs_wallet. */
+    std::vector<CStealthAddress> GetStealthAddressesForMatching(uint64_t& nGeneration) const;
+    /** Have ProcessStealthOutput use matches instead of matching the outputs itself, until ClearStealthMatches. Requires cs_wallet. */
+    void SetStealthMatches(CStealthMatches&& matches);
+    void ClearStealthMatches();
+
     int CheckForStealthAndNarration(const CTxOutBase *pb, const CTxOutData *pdata, std::string &sNarr);
     bool FindStealthTransactions(const CTransaction &tx, mapValue_t &mapNarr);
 
@@ -377,6 +437,7 @@ public:
 
     MapRecords_t mapRecords;
     std::set<uint256> mapLockedRecords; // Keep track of locked transactions (hidden value) for faster unlocking
+    std::set<uint256> setUnspentRecords; // Records with owned outputs not flagged spent or whose spenders may be conflicted, walked instead of mapRecords for balances and coin selection
     RtxOrdered_t rtxOrdered;
     mutable MapRecords_t mapTempRecords; // Hack for sending unmined inputs through fundrawtransactionfrom
 
@@ -385,6 +446,19 @@ public:
 
 private:
     std::string GetDisplayName() const { return "ringctwallet"; }
+    /** Add to or remove from mapStealthAddresses, keeping stealthPrefixIndex in sync */
+    void InsertStealthAddress(const CStealthAddress& sx);
+    void RemoveStealthAddress(const CKeyID& idStealth);
+
+    /**
+     * The RingCT and CT totals of GetBalances. They depend on the records, the spends, the chain and the mempool,
+     * so they stay valid until a record is updated or the tip or mempool changes.
+     */
+    BalanceList balancesCached;
+    bool fBalancesCached = false;
+    const CBlockIndex* pindexBalancesCached = nullptr;
+    unsigned int nMempoolUpdatedBalancesCached = 0;
+
     void ParseAddressForMetaData(const CTxDestination &addr, COutputRecord &rec);
 
     bool ArrangeBlinds(
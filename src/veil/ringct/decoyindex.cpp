@@ -0,0 +1,96 @@
+// Copyright (c) 2019-2022 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <veil/ringct/decoyindex.h>
+
+#include <chainparams.h>
+#include <random.h>
+#include <tinyformat.h>
+#include <txdb.h>
+#include <util/system.h>
+#include <validation.h>
+#include <veil/invalid.h>
+#include <veil/ringct/rctindex.h>
+
+CDecoyIndex decoyIndex;
+
+bool CDecoyIndex::IsEligible(int64_t nIndex, std::string &sError)
+{
+    if (vChecked[nIndex])
+        return !vBlacklisted[nIndex];
+
+    // Without a blacklist every mature output qualifies, no need to look at it
+    if (nBlacklistSize > 0) {
+        CAnonOutput ao;
+        if (!pblocktree->ReadRCTOutput(nIndex, ao)) {
+            sError = strprintf("Anonymous output not found in database: %s.", nIndex);
+            return error("%s: %s", __func__, sError);
+        }
+        vBlacklisted[nIndex] = blacklist::ContainsRingCtOutPoint(ao.outpoint);
+    }
+    vChecked[nIndex] = true;
+
+    return !vBlacklisted[nIndex];
+}
+
+bool CDecoyIndex::PickDecoy(int64_t nSelectionGroup1, int64_t nSelectionGroup2, int nExtraDepth,
+                            const std::set<int64_t> &setHave, int64_t &nDecoy, std::string &sError)
+{
+    AssertLockHeld(cs_main);
+
+    int nMatureHeight = chainActive.Height() - (Params().GetConsensus().nMinRCTOutputDepth + nExtraDepth);
+    if (nMatureHeight < 0) {
+        sError = "No anonymous outputs are deep enough to be used.";
+        return error("%s: %s", __func__, sError);
+    }
+    const CBlockIndex *pindexMature = chainActive[nMatureHeight];
+    int64_t nLastRCTOutIndex = pindexMature->nAnonOutputs;
+
+    LOCK(cs);
+    int nBlacklistSizeNow = blacklist::GetRingCtListSize();
+    if (nCheckedHeight > chainActive.Height() || (nCheckedHeight >= 0 && chainActive[nCheckedHeight]->GetBlockHash() != hashCheckedBlock)
+            || nBlacklistSize != nBlacklistSizeNow) {
+        vChecked.clear();
+        vBlacklisted.clear();
+    }
+    nCheckedHeight = nMatureHeight;
+    hashCheckedBlock = pindexMature->GetBlockHash();
+    nBlacklistSize = nBlacklistSizeNow;
+    // Indexes past the last mature output may still be reorganized, never keep them
+    vChecked.resize(nLastRCTOutIndex + 1, false);
+    vBlacklisted.resize(nLastRCTOutIndex + 1, false);
+
+    int64_t nMinIndex = 1;
+    if (GetRandInt(100) < 50) { // 50% chance of selecting from the last 2400
+        nMinIndex = std::max((int64_t)1, nLastRCTOutIndex - nSelectionGroup1);
+    } else if (GetRandInt(100) < 70) { // further 70% chance of selecting from the last 24000
+        nMinIndex = std::max((int64_t)1, nLastRCTOutIndex - nSelectionGroup2);
+    }
+
+    if (nLastRCTOutIndex <= nMinIndex) {
+        sError = strprintf("Not enough anonymous outputs exist, min: %d, last: %d.", nMinIndex, nLastRCTOutIndex);
+        return error("%s: %s", __func__, sError);
+    }
+
+    // Only outputs that are already picked or blacklisted are rejected, so this rarely loops
+    const static size_t nMaxTries = 1000;
+    for (size_t j = 0; j < nMaxTries; ++j) {
+        int64_t nIndex = nMinIndex + GetRand((nLastRCTOutIndex - nMinIndex) + 1);
+        if (setHave.count(nIndex))
+            continue;
+
+        sError.clear();
+        if (!IsEligible(nIndex, sError)) {
+            if (!sError.empty())
+                return false;
+            continue;
+        }
+
+        nDecoy = nIndex;
+        return true;
+    }
+
+    sError = strprintf("Exceeded maximum tries for picking hiding outputs, min: %d, last: %d.", nMinIndex, nLastRCTOutIndex);
+    return error("%s: %s", __func__, sError);
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2019-2022 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef VEIL_DECOYINDEX_H
+#define VEIL_DECOYINDEX_H
+
+#include <sync.h>
+#include <uint256.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * Samples ring member decoys from the anon outputs that are eligible to be mixed in.
+ *
+ * Anon outputs are indexed in chain order, so the outputs that are deep enough to be used are always the
+ * prefix up to the nAnonOutputs of the last mature block, which is read straight off chainActive. What is
+ * left is excluding blacklisted outputs: every index is checked against the blacklist once and the answer
+ * is kept in a pair of bitmaps, so a decoy is drawn in O(1) and only outputs never looked at before are read
+ * from the block tree. The bitmaps are dropped when the block they were built against is reorganized away
+ * or the RingCT blacklist changes, and they grow as new blocks mature.
+ */
+class CDecoyIndex
+{
+private:
+    CCriticalSection cs;
+    std::vector<bool> vChecked GUARDED_BY(cs);
+    std::vector<bool> vBlacklisted GUARDED_BY(cs);
+    int nCheckedHeight GUARDED_BY(cs) = -1;
+    uint256 hashCheckedBlock GUARDED_BY(cs);
+    int nBlacklistSize GUARDED_BY(cs) = 0;
+
+    bool IsEligible(int64_t nIndex, std::string &sError) EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+public:
+    /**
+     * Pick an eligible decoy that is not in setHave. Half of the picks come from the last nSelectionGroup1
+     * mature outputs, 70% of the rest from the last nSelectionGroup2 and the remainder from all of them.
+     * nExtraDepth is added to the consensus minimum depth. Requires cs_main.
+     */
+    bool PickDecoy(int64_t nSelectionGroup1, int64_t nSelectionGroup2, int nExtraDepth,
+                   const std::set<int64_t> &setHave, int64_t &nDecoy, std::string &sError);
+};
+
+extern CDecoyIndex decoyIndex;
+
+#endif //VEIL_DECOYINDEX_H
@@ -74,11 +74,15 @@ std::string TestBuildWalletTransaction(int nRandomInt) {
     }
 
     // Check if key images are spent
+    std::vector<CCmpPubKey> vKeyImages;
+    for (const auto& pair : keyimages)
+        vKeyImages.push_back(pair.first);
+    std::map<CCmpPubKey, uint256> mapSpentInChain;
+    pblocktree->ReadRCTKeyImages(vKeyImages, mapSpentInChain);
+
     std::vector<CWatchOnlyTx> vUnspentTxes;
     for (const auto& pair : keyimages) {
-        uint256 tx_hash;
-        bool spent_in_chain = pblocktree->ReadRCTKeyImage(pair.first, tx_hash);
-        if (!spent_in_chain) {
+        if (!mapSpentInChain.count(pair.first)) {
             vUnspentTxes.push_back(pair.second);
         }
     }
@@ -263,6 +263,19 @@ int StealthSecret(const CKey &secret, const ec_point &pubkey, const ec_point &pk
     if (!secp256k1_ec_pubkey_parse(secp256k1_ctx_stealth, &R, &pkSpend[0], EC_COMPRESSED_SIZE))
         return errorN(1, "%s: secp256k1_ec_pubkey_parse R failed.", __func__);
 
+    return StealthSecret(secret, Q, R, sharedSOut, pkOut);
+};
+
+bool StealthParsePubKey(const ec_point &pk, secp256k1_pubkey &pkOut)
+{
+    return pk.size() == EC_COMPRESSED_SIZE
+        && secp256k1_ec_pubkey_parse(secp256k1_ctx_stealth, &pkOut, &pk[0], EC_COMPRESSED_SIZE);
+};
+
+int StealthSecret(const CKey &secret, const secp256k1_pubkey &pubkey, secp256k1_pubkey R, CKey &sharedSOut, ec_point &pkOut)
+{
+    secp256k1_pubkey Q = pubkey;
+
     // eQ
     if (!secp256k1_ec_pubkey_tweak_mul(secp256k1_ctx_stealth, &Q, secret.begin()))
         return errorN(1, "%s: secp256k1_ec_pubkey_tweak_mul failed.", __func__);
@@ -418,6 +431,40 @@ uint32_t FillStealthPrefix(uint8_t nBits, uint32_t nBitfield)
     return prefix;
 };
 
+void CStealthPrefixIndex::Add(const CStealthAddress &sx)
+{
+    uint8_t nBits = sx.prefix.number_bits;
+    mapBuckets[nBits][nBits > 0 ? sx.prefix.bitfield & SetStealthMask(nBits) : 0].insert(sx.GetID());
+};
+
+void CStealthPrefixIndex::Remove(const CStealthAddress &sx)
+{
+    uint8_t nBits = sx.prefix.number_bits;
+    auto mi = mapBuckets.find(nBits);
+    if (mi == mapBuckets.end())
+        return;
+    auto it = mi->second.find(nBits > 0 ? sx.prefix.bitfield & SetStealthMask(nBits) : 0);
+    if (it == mi->second.end())
+        return;
+    it->second.erase(sx.GetID());
+    if (it->second.empty())
+        mi->second.erase(it);
+    if (mi->second.empty())
+        mapBuckets.erase(mi);
+};
+
+void CStealthPrefixIndex::GetCandidates(uint32_t nPrefix, bool fHavePrefix, std::vector<CKeyID> &vCandidates) const
+{
+    for (const auto &mi : mapBuckets) {
+        if (mi.first > 0 && !fHavePrefix)
+            break; // buckets are ordered by the number of bits, only the first one has addresses without a prefix
+
+        auto it = mi.second.find(mi.first > 0 ? nPrefix & SetStealthMask(mi.first) : 0);
+        if (it != mi.second.end())
+            vCandidates.insert(vCandidates.end(), it->second.begin(), it->second.end());
+    }
+};
+
 bool ExtractStealthPrefix(const char *pPrefix, uint32_t &nPrefix)
 {
     int base = 10;
@@ -9,6 +9,8 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <map>
+#include <set>
 #include <vector>
 #include <inttypes.h>
 
@@ -18,6 +20,8 @@
 
 #include <veil/ringct/types.h>
 
+#include <secp256k1.h>
+
 class CScript;
 class CTransaction;
 
@@ -141,6 +145,10 @@ int SetPublicKey(const CPubKey &pk, ec_point &out);
 
 int StealthShared(const CKey &secret, const ec_point &pubkey, CKey &sharedSOut);
 int StealthSecret(const CKey &secret, const ec_point &pubkey, const ec_point &pkSpend, CKey &sharedSOut, ec_point &pkOut);
+/** StealthSecret with both pubkeys already parsed by StealthParsePubKey, so one ephemeral pubkey can be matched
+ *  against many stealth addresses without decompressing it every time. pkSpend is tweaked into pkOut. */
+int StealthSecret(const CKey &secret, const secp256k1_pubkey &pubkey, secp256k1_pubkey pkSpend, CKey &sharedSOut, ec_point &pkOut);
+bool StealthParsePubKey(const ec_point &pk, secp256k1_pubkey &pkOut);
 int StealthSecretSpend(const CKey &scanSecret, const ec_point &ephemPubkey, const CKey &spendSecret, CKey &secretOut);
 int StealthSharedToSecretSpend(const CKey &sharedS, const CKey &spendSecret, CKey &secretOut);
 
@@ -155,6 +163,27 @@ inline uint32_t SetStealthMask(uint8_t nBits)
 
 uint32_t FillStealthPrefix(uint8_t nBits, uint32_t nBitfield);
 
+/**
+ * Stealth addresses grouped by their prefix. An output that carries a prefix can only have been sent to an address
+ * without a prefix or to one whose prefix bits it has, and an output without one only to an address without a
+ * prefix. Looking the candidates up by the number of prefix bits and the masked bitfield keeps owned output
+ * detection from scaling with the number of addresses in wallets that generate many of them.
+ */
+class CStealthPrefixIndex
+{
+private:
+    //! number_bits -> bitfield masked to number_bits -> addresses
+    std::map<uint8_t, std::map<uint32_t, std::set<CKeyID>>> mapBuckets;
+
+public:
+    void Add(const CStealthAddress &sx);
+    void Remove(const CStealthAddress &sx);
+    void Clear() { mapBuckets.clear(); }
+
+    /** Add the addresses an output with this prefix may have been sent to to vCandidates */
+    void GetCandidates(uint32_t nPrefix, bool fHavePrefix, std::vector<CKeyID> &vCandidates) const;
+};
+
 bool ExtractStealthPrefix(const char *pPrefix, uint32_t &nPrefix);
 
 bool MakeStealthData(const std::string &sNarration, stealth_prefix prefix, const CKey &sShared, const CPubKey &pkEphem,
@@ -675,6 +675,12 @@ UniValue CWatchOnlyTx::GetUniValue(int& index, bool spent, std::string keyimage,
         out.pushKV("hex", rawtx);
     }
 
+    out.pushKV("raw", GetRaw());
+    return out;
+}
+
+std::string CWatchOnlyTx::GetRaw() const
+{
     CWatchOnlyTxWithIndex watchonlywithindex;
     watchonlywithindex.watchonlytx = *this;
     if (this->type == ANON) {
@@ -685,8 +691,7 @@ UniValue CWatchOnlyTx::GetUniValue(int& index, bool spent, std::string keyimage,
 
     CDataStream ssTx(SER_NETWORK, PROTOCOL_VERSION);
     ssTx << watchonlywithindex;
-    out.pushKV("raw", HexStr(ssTx));
-    return out;
+    return HexStr(ssTx);
 }
 
 bool AddWatchOnlyAddress(const std::string& address, const CKey& scan_secret, const CPubKey& spend_pubkey, const int64_t& nStart, const int64_t& nImported)
@@ -840,10 +845,36 @@ bool AddWatchOnlyTransaction(const CKey& key, const CWatchOnlyTx& watchonlytx)
 
 bool ReadWatchOnlyTransaction(const CKey& key, const int& count, CWatchOnlyTx& watchonlytx)
 {
-    LogPrintf("%s: reading watchonly transaction from database\n", __func__);
+    LogPrint(BCLog::WATCHONLYDB, "%s: reading watchonly transaction from database\n", __func__);
     return pwatchonlyDB->ReadWatchOnlyTx(key, count, watchonlytx);
 }
 
+bool ReadWatchOnlyTransactions(const CKey& key, int nStart, int nEnd, std::vector<std::pair<int, CWatchOnlyTx>>& vTxes)
+{
+    if (nEnd < nStart)
+        return true;
+    return pwatchonlyDB->ReadWatchOnlyTxRange(key, nStart, nEnd, vTxes);
+}
+
+void LoadWatchOnlyRingCTIndexes(std::vector<std::pair<int, CWatchOnlyTx>>& vTxes)
+{
+    std::vector<CCmpPubKey> vPubKeys;
+    for (const auto& tx : vTxes) {
+        if (tx.second.type == CWatchOnlyTx::ANON)
+            vPubKeys.emplace_back(tx.second.ringctout.pk);
+    }
+
+    std::map<CCmpPubKey, int64_t> mapIndexes;
+    pblocktree->ReadRCTOutputLinks(vPubKeys, mapIndexes);
+    for (auto& tx : vTxes) {
+        if (tx.second.type != CWatchOnlyTx::ANON)
+            continue;
+        auto it = mapIndexes.find(tx.second.ringctout.pk);
+        if (it != mapIndexes.end())
+            tx.second.ringctIndex = it->second;
+    }
+}
+
 bool WriteWatchOnlyCheckpoint(const CKey& scan_secret, const std::vector<CWatchOnlyTx>& vTxes, int64_t nHeight, const uint256& blockHash)
 {
     // Checkpoints are always enabled for data safety
@@ -914,15 +945,10 @@ void FetchWatchOnlyTransactions(const CKey& scan_secret, std::vector<std::pair<i
         nStoppingPoint = nStopIndex;
 
 
-    for (int i = nStartFromIndex; i <= nStoppingPoint; i++) {
-        CWatchOnlyTx watchonlytx;
-        if (ReadWatchOnlyTransaction(scan_secret, i, watchonlytx)) {
-            if (watchonlytx.type == CWatchOnlyTx::ANON) {
-                pblocktree->ReadRCTOutputLink(watchonlytx.ringctout.pk, watchonlytx.ringctIndex);
-            }
-            vTxes.emplace_back(std::make_pair(i, watchonlytx));
-        }
-    }
+    std::vector<std::pair<int, CWatchOnlyTx>> vRead;
+    ReadWatchOnlyTransactions(scan_secret, nStartFromIndex, nStoppingPoint, vRead);
+    LoadWatchOnlyRingCTIndexes(vRead);
+    vTxes.insert(vTxes.end(), vRead.begin(), vRead.end());
 }
 
 bool GetSecretFromString(const std::string& strSecret, CKey& secret)
@@ -180,6 +180,8 @@ public:
         }
     };
 
+    /** Hex of the transaction serialized with its RingCT index, as light wallets pass it back in */
+    std::string GetRaw() const;
     UniValue GetUniValue(int& index, bool spent = false, std::string keyimage = "", uint256 txhash = uint256(), bool fSkip = true, CAmount amount = 0, int confirmations = -1, int64_t blocktime = 0, std::string rawtx = "") const;
 };
 
@@ -212,6 +214,10 @@ bool FlushWatchOnlyAddresses();
 bool GetWatchOnlyAddressTransactions(const CBitcoinAddress& address, std::vector<uint256>& txhashses);
 bool AddWatchOnlyTransaction(const CKey& key,const CWatchOnlyTx& watchonlytx);
 bool ReadWatchOnlyTransaction(const CKey& key, const int& count, CWatchOnlyTx& watchonlytx);
+/** Read the stored transactions with index in [nStart, nEnd] in index order */
+bool ReadWatchOnlyTransactions(const CKey& key, int nStart, int nEnd, std::vector<std::pair<int, CWatchOnlyTx>>& vTxes);
+/** Fill in ringctIndex for the anon transactions with one batched index lookup */
+void LoadWatchOnlyRingCTIndexes(std::vector<std::pair<int, CWatchOnlyTx>>& vTxes);
 void FetchWatchOnlyTransactions(const CKey& scan_secret, std::vector<std::pair<int, CWatchOnlyTx>>& vTxes, int nStartFromIndex = -1, int nStopIndex = -1);
 
 /** Atomic checkpoint write for crash recovery */
@@ -25,12 +25,42 @@ std::unique_ptr<CWatchOnlyDB> pwatchonlyDB;
 
 static const char DB_WATCHONLY_KEY = 'K';        // V1: String-based address keys
 static const char DB_WATCHONLY_KEY_V2 = 'k';     // V2: CKeyID-based keys (lowercase)
-static const char DB_WATCHONLY_TXS = 'T';
+static const char DB_WATCHONLY_TXS = 'T';        // V2: Little-endian index, no longer written
+static const char DB_WATCHONLY_TXS_V3 = 't';     // V3: Big-endian index
 static const char DB_WATCHONLY_KEY_COUNT = 'C';
 static const char DB_WATCHONLY_BLOCK_TX = 'B';
 static const char DB_WATCHONLY_CHECKPOINT = 'P';
 static const char DB_WATCHONLY_VERSION = 'V';    // Database version
 
+//! Bytes of transactions to move per batch when migrating to V3
+static const size_t WATCHONLY_MIGRATE_BATCH_SIZE = 16 << 20;
+
+namespace {
+/** Transaction key with the index stored big-endian, so leveldb keeps a key's transactions in index order */
+struct WatchOnlyTxKey
+{
+    CKey key;
+    int nIndex;
+
+    WatchOnlyTxKey() : nIndex(0) {}
+    WatchOnlyTxKey(const CKey& keyIn, int nIndexIn) : key(keyIn), nIndex(nIndexIn) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << key;
+        ser_writedata32be(s, nIndex);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        s >> key;
+        nIndex = ser_readdata32be(s);
+    }
+};
+} // namespace
+
 CWatchOnlyDB::CWatchOnlyDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "watchonly", nCacheSize, fMemory, fWipe)
 {
 }
@@ -67,6 +97,14 @@ bool CWatchOnlyDB::LoadWatchOnlyAddresses()
         dbVersion = WATCHONLY_DB_VERSION_2;
     }
 
+    if (dbVersion < WATCHONLY_DB_VERSION_3) {
+        LogPrintf("Detected V2 database, running migration to V3...\n");
+        if (!MigrateToV3()) {
+            return error("Failed to migrate watchonly database to V3");
+        }
+        dbVersion = WATCHONLY_DB_VERSION_3;
+    }
+
     // Load V2 format (hash-based keys)
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
     pcursor->Seek(std::make_pair(DB_WATCHONLY_KEY_V2, CKeyID()));
@@ -142,7 +180,7 @@ bool CWatchOnlyDB::WriteWatchOnlyTx(const CKey& key, const int& current_count, c
 {
     int next_count = current_count + 1;
     CDBBatch batch(*this);
-    batch.Write(std::make_pair(DB_WATCHONLY_TXS, std::make_pair(key, next_count)), watchonlytx);
+    batch.Write(std::make_pair(DB_WATCHONLY_TXS_V3, WatchOnlyTxKey(key, next_count)), watchonlytx);
     LogPrint(BCLog::WATCHONLYDB, "Writing watchonly txhash %s to db at count %d.\n", watchonlytx.tx_hash.GetHex(), next_count);
     batch.Write(std::make_pair(DB_WATCHONLY_KEY_COUNT, key), next_count);
     LogPrint(BCLog::WATCHONLYDB, "Writing to db, increasing keycount to %d.\n", next_count);
@@ -151,11 +189,31 @@ bool CWatchOnlyDB::WriteWatchOnlyTx(const CKey& key, const int& current_count, c
 
 bool CWatchOnlyDB::ReadWatchOnlyTx(const CKey& key, const int& count, CWatchOnlyTx& watchonlytx)
 {
-    bool fSuccess = Read(std::make_pair(DB_WATCHONLY_TXS, std::make_pair(key,count)), watchonlytx);
+    bool fSuccess = Read(std::make_pair(DB_WATCHONLY_TXS_V3, WatchOnlyTxKey(key, count)), watchonlytx);
     LogPrint(BCLog::WATCHONLYDB, "Reading %d watchonly txhash %s from db.\n", count, watchonlytx.tx_hash.GetHex());
     return fSuccess;
 }
 
+bool CWatchOnlyDB::ReadWatchOnlyTxRange(const CKey& key, int nStart, int nEnd, std::vector<std::pair<int, CWatchOnlyTx>>& vTxes)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(DB_WATCHONLY_TXS_V3, WatchOnlyTxKey(key, std::max(nStart, 0))));
+
+    for (; pcursor->Valid(); pcursor->Next()) {
+        std::pair<char, WatchOnlyTxKey> dbkey;
+        if (!pcursor->GetKey(dbkey) || dbkey.first != DB_WATCHONLY_TXS_V3 || !(dbkey.second.key == key) || dbkey.second.nIndex > nEnd)
+            break;
+
+        CWatchOnlyTx watchonlytx;
+        if (!pcursor->GetValue(watchonlytx))
+            return error("%s: failed to read watchonly tx at index %d", __func__, dbkey.second.nIndex);
+        vTxes.emplace_back(dbkey.second.nIndex, std::move(watchonlytx));
+    }
+
+    LogPrint(BCLog::WATCHONLYDB, "Read %d watchonly txes in range [%d, %d] from db.\n", vTxes.size(), nStart, nEnd);
+    return true;
+}
+
 bool CWatchOnlyDB::WriteBulkWatchOnlyTx(const CKey& key, int starting_count, const std::vector<CWatchOnlyTx>& vTxes)
 {
     if (vTxes.empty())
@@ -166,7 +224,7 @@ bool CWatchOnlyDB::WriteBulkWatchOnlyTx(const CKey& key, int starting_count, con
     int count = starting_count;
     for (const auto& tx : vTxes) {
         count++;
-        batch.Write(std::make_pair(DB_WATCHONLY_TXS, std::make_pair(key, count)), tx);
+        batch.Write(std::make_pair(DB_WATCHONLY_TXS_V3, WatchOnlyTxKey(key, count)), tx);
     }
 
     // Only write counter once at the end (instead of once per transaction)
@@ -288,20 +346,17 @@ bool CWatchOnlyDB::EraseWatchOnlyAddressData(const CKeyID& keyID, const CKey& sc
 
     nTxesRemoved = 0;
 
-    // Get the transaction count for this key
-    int txCount = 0;
-    ReadKeyCount(scan_secret, txCount);
-
-    // Erase all transactions for this address. Index 0 must be included: the
-    // first transaction written through the non-cached path was historically
-    // stored at index 0 (with the count not including it), while the cached
-    // path is 1-based — probe 0..txCount and erase whatever exists.
-    for (int i = 0; i <= txCount; i++) {
-        CWatchOnlyTx probeTx;
-        if (Read(std::make_pair(DB_WATCHONLY_TXS, std::make_pair(scan_secret, i)), probeTx)) {
-            nTxesRemoved++;
-        }
-        batch.Erase(std::make_pair(DB_WATCHONLY_TXS, std::make_pair(scan_secret, i)));
+    // Erase all transactions for this address. The first transaction written through the
+    // non-cached path was historically stored at index 0 while the cached path is 1-based,
+    // so walk every index stored for the key rather than trusting the count.
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(DB_WATCHONLY_TXS_V3, WatchOnlyTxKey(scan_secret, 0)));
+    for (; pcursor->Valid(); pcursor->Next()) {
+        std::pair<char, WatchOnlyTxKey> dbkey;
+        if (!pcursor->GetKey(dbkey) || dbkey.first != DB_WATCHONLY_TXS_V3 || !(dbkey.second.key == scan_secret))
+            break;
+        batch.Erase(dbkey);
+        nTxesRemoved++;
     }
     LogPrint(BCLog::WATCHONLYDB, "Erasing %d transactions for watchonly address %s from db.\n", nTxesRemoved, keyID.ToString());
 
@@ -377,6 +432,53 @@ bool CWatchOnlyDB::MigrateToV2()
     return true;
 }
 
+bool CWatchOnlyDB::MigrateToV3()
+{
+    int currentVersion = GetDatabaseVersion();
+    if (currentVersion >= WATCHONLY_DB_VERSION_3) {
+        LogPrintf("WatchOnly DB already at version %d, no migration needed\n", currentVersion);
+        return true;
+    }
+
+    LogPrintf("Starting WatchOnly DB migration from V2 to V3...\n");
+
+    // Every transaction is moved to its big-endian key in the same batch that erases the old key,
+    // so an interrupted migration just picks up the transactions that are left on the next start
+    int nMigrated = 0;
+    CDBBatch batch(*this);
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(DB_WATCHONLY_TXS);
+
+    for (; pcursor->Valid(); pcursor->Next()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, std::pair<CKey, int>> key;
+        if (!pcursor->GetKey(key) || key.first != DB_WATCHONLY_TXS)
+            break;
+
+        CWatchOnlyTx value;
+        if (!pcursor->GetValue(value))
+            return error("%s: failed to read watchonly tx at index %d", __func__, key.second.second);
+
+        batch.Write(std::make_pair(DB_WATCHONLY_TXS_V3, WatchOnlyTxKey(key.second.first, key.second.second)), value);
+        batch.Erase(key);
+        nMigrated++;
+
+        if (batch.SizeEstimate() > WATCHONLY_MIGRATE_BATCH_SIZE) {
+            if (!WriteBatch(batch))
+                return error("Failed to write migrated data");
+            batch.Clear();
+        }
+    }
+
+    batch.Write(DB_WATCHONLY_VERSION, WATCHONLY_DB_VERSION_3);
+    if (!WriteBatch(batch)) {
+        return error("Failed to write migrated data");
+    }
+
+    LogPrintf("WatchOnly DB migration completed successfully, moved %d transactions\n", nMigrated);
+    return true;
+}
+
 // ===== Database Maintenance =====
 
 void CWatchOnlyDB::CompactDatabase()
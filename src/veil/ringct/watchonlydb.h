@@ -32,7 +32,8 @@ class CWatchOnlyAddress;
 /** Database version constants */
 static const int WATCHONLY_DB_VERSION_1 = 1;  // Original string-based keys
 static const int WATCHONLY_DB_VERSION_2 = 2;  // Hash-based keys (CKeyID)
-static const int WATCHONLY_DB_CURRENT = WATCHONLY_DB_VERSION_2;
+static const int WATCHONLY_DB_VERSION_3 = 3;  // Big-endian transaction indexes, so a key's txes are range scannable
+static const int WATCHONLY_DB_CURRENT = WATCHONLY_DB_VERSION_3;
 
 /** Checkpoint structure for crash recovery */
 struct CWatchOnlyScanCheckpoint {
@@ -85,9 +86,12 @@ public:
     int GetDatabaseVersion();
     bool SetDatabaseVersion(int version);
     bool MigrateToV2();
+    bool MigrateToV3();
 
     bool WriteWatchOnlyTx(const CKey& key, const int& current_count, const CWatchOnlyTx& watchonlytx);
     bool ReadWatchOnlyTx(const CKey& key, const int& count, CWatchOnlyTx& watchonlytx);
+    /** Read the transactions stored for a key with index in [nStart, nEnd], in index order, with one seek */
+    bool ReadWatchOnlyTxRange(const CKey& key, int nStart, int nEnd, std::vector<std::pair<int, CWatchOnlyTx>>& vTxes);
 
     /** Bulk write method - writes multiple transactions in a single batch */
     bool WriteBulkWatchOnlyTx(const CKey& key, int starting_count, const std::vector<CWatchOnlyTx>& vTxes);
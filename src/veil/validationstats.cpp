@@ -0,0 +1,101 @@
+// Copyright (c) 2019-2022 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <veil/validationstats.h>
+
+#include <util/time.h>
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+namespace {
+
+struct StageRecorder {
+    std::mutex mutex;
+    ValidationStageStats stats;
+    size_t nNext{0};
+};
+
+std::array<StageRecorder, (size_t)ValidationStage::COUNT> g_stages;
+
+//! Whether this thread is connecting a block, set by ValidationStatsScope
+thread_local bool g_fRecordTimers = false;
+
+} // namespace
+
+const char* GetValidationStageName(ValidationStage stage)
+{
+    switch (stage) {
+    case ValidationStage::CHECK_BLOCK: return "checkblock";
+    case ValidationStage::CONNECT_TRANSACTIONS: return "connecttransactions";
+    case ValidationStage::RANGEPROOF: return "rangeproof";
+    case ValidationStage::MLSAG: return "mlsag";
+    case ValidationStage::RCT_OUTPUT_READ: return "rctoutputread";
+    case ValidationStage::ZEROCOIN_SPEND: return "zerocoinspend";
+    case ValidationStage::ACCUMULATOR_CHECKPOINT: return "accumulatorcheckpoint";
+    case ValidationStage::VEIL_DATA_HASH: return "veildatahash";
+    case ValidationStage::ZEROCOIN_DATABASE: return "zerocoindatabase";
+    case ValidationStage::FLUSH_VIEW: return "flushview";
+    case ValidationStage::CONNECT_BLOCK: return "connectblock";
+    case ValidationStage::COUNT: break;
+    }
+    return "unknown";
+}
+
+void RecordValidationStage(ValidationStage stage, int64_t nMicros)
+{
+    StageRecorder& recorder = g_stages[(size_t)stage];
+    std::lock_guard<std::mutex> lock(recorder.mutex);
+    ValidationStageStats& stats = recorder.stats;
+    stats.nSamples++;
+    stats.nTotalMicros += nMicros;
+    stats.nMaxMicros = std::max(stats.nMaxMicros, nMicros);
+
+    // Ring buffer of the recent samples
+    if (stats.vRecentMicros.size() < VALIDATION_STATS_WINDOW) {
+        stats.vRecentMicros.push_back(nMicros);
+    } else {
+        stats.vRecentMicros[recorder.nNext] = nMicros;
+        recorder.nNext = (recorder.nNext + 1) % VALIDATION_STATS_WINDOW;
+    }
+}
+
+ValidationStageStats GetValidationStageStats(ValidationStage stage)
+{
+    StageRecorder& recorder = g_stages[(size_t)stage];
+    std::lock_guard<std::mutex> lock(recorder.mutex);
+    return recorder.stats;
+}
+
+void ResetValidationStats()
+{
+    for (StageRecorder& recorder : g_stages) {
+        std::lock_guard<std::mutex> lock(recorder.mutex);
+        recorder.stats = ValidationStageStats();
+        recorder.nNext = 0;
+    }
+}
+
+ValidationStatsScope::ValidationStatsScope(bool fRecord) : m_prev(g_fRecordTimers)
+{
+    g_fRecordTimers = fRecord;
+}
+
+ValidationStatsScope::~ValidationStatsScope()
+{
+    g_fRecordTimers = m_prev;
+}
+
+ValidationStageTimer::ValidationStageTimer(ValidationStage stage) : m_stage(stage), m_start(0), m_record(g_fRecordTimers)
+{
+    if (m_record)
+        m_start = GetTimeMicros();
+}
+
+ValidationStageTimer::~ValidationStageTimer()
+{
+    if (m_record)
+        RecordValidationStage(m_stage, GetTimeMicros() - m_start);
+}
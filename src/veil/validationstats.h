@@ -0,0 +1,76 @@
+// Copyright (c) 2019-2022 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef VEIL_VALIDATIONSTATS_H
+#define VEIL_VALIDATIONSTATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/** The block validation stages that are timed for getvalidationstats */
+enum class ValidationStage {
+    CHECK_BLOCK,            //!< CheckBlock of a received, loaded or connected block, once per block when it is first checked
+    CONNECT_TRANSACTIONS,   //!< Input, key image and anon output checks of all transactions, once per block
+    RANGEPROOF,             //!< One range proof verification while checking or connecting a block
+    MLSAG,                  //!< One transaction's MLSAG verification while connecting a block, including reading its ring members
+    RCT_OUTPUT_READ,        //!< One ring member read while verifying an MLSAG of a block being connected
+    ZEROCOIN_SPEND,         //!< Zerocoin spend checks and proof verification, once per block
+    ACCUMULATOR_CHECKPOINT, //!< ValidateAccumulatorCheckpoint, once per block that runs it
+    VEIL_DATA_HASH,         //!< Computing the Veil data hash, once per block
+    ZEROCOIN_DATABASE,      //!< Writing zerocoin mints and spends, once per block
+    FLUSH_VIEW,             //!< Flushing the block's coins and RingCT view, once per connected block
+    CONNECT_BLOCK,          //!< All of ConnectBlock, once per block
+    COUNT
+};
+
+const char* GetValidationStageName(ValidationStage stage);
+
+/** Samples of the recent window are kept per stage to compute latency percentiles */
+static const size_t VALIDATION_STATS_WINDOW = 1000;
+
+struct ValidationStageStats {
+    uint64_t nSamples{0};
+    int64_t nTotalMicros{0};
+    int64_t nMaxMicros{0};
+    //! The last VALIDATION_STATS_WINDOW samples, unordered
+    std::vector<int64_t> vRecentMicros;
+};
+
+void RecordValidationStage(ValidationStage stage, int64_t nMicros);
+ValidationStageStats GetValidationStageStats(ValidationStage stage);
+void ResetValidationStats();
+
+/**
+ * Range proofs and MLSAGs are also verified for mempool acceptance and block
+ * template checks. ConnectBlock holds one of these, recording only when it
+ * connects a block for real, and so does the CheckBlock of a received block,
+ * which verifies its range proofs. ValidationStageTimer only records on a
+ * thread whose innermost scope records.
+ */
+class ValidationStatsScope
+{
+private:
+    bool m_prev;
+
+public:
+    explicit ValidationStatsScope(bool fRecord);
+    ~ValidationStatsScope();
+};
+
+/** Records the time between its construction and destruction as one sample of
+ *  a stage, if this thread is in a recording ValidationStatsScope */
+class ValidationStageTimer
+{
+private:
+    ValidationStage m_stage;
+    int64_t m_start;
+    bool m_record;
+
+public:
+    explicit ValidationStageTimer(ValidationStage stage);
+    ~ValidationStageTimer();
+};
+
+#endif //VEIL_VALIDATIONSTATS_H
@@ -8,6 +8,10 @@
 #include "libzerocoin/Denominations.h"
 #include "validation.h"
 
+#include <atomic>
+#include <exception>
+#include <thread>
+
 using namespace libzerocoin;
 using namespace std;
 
@@ -50,7 +54,7 @@ bool AccumulatorMap::Load(const std::map<libzerocoin::CoinDenomination, uint256>
             continue;
 
         CBigNum bnValue;
-        if (!pzerocoinDB->ReadAccumulatorValue(mi.second, bnValue))
+        if (!GetAccumulatorValueFromChecksum(mi.second, false, bnValue))
             return error("%s : cannot find checksum %s", __func__, mi.second.GetHex());
 
         mapAccumulators.at(mi.first)->setValue(bnValue);
@@ -75,6 +79,55 @@ bool AccumulatorMap::Accumulate(const PublicCoin& pubCoin, bool fSkipValidation)
     return mapAccumulators.at(denom)->accumulate(pubCoin);
 }
 
+//Add zerocoins to the accumulators of their denominations. Each accumulator only depends on its own
+//coins, so every denomination is accumulated on its own thread.
+bool AccumulatorMap::Accumulate(const std::list<PublicCoin>& listPubCoins, bool fSkipValidation)
+{
+    std::map<CoinDenomination, std::vector<const PublicCoin*> > mapDenomCoins;
+    for (const PublicCoin& pubCoin : listPubCoins) {
+        CoinDenomination denom = pubCoin.getDenomination();
+        if (denom == CoinDenomination::ZQ_ERROR)
+            return false;
+        mapDenomCoins[denom].emplace_back(&pubCoin);
+        setUnusedDenominations.erase(denom);
+    }
+
+    std::atomic<bool> fSuccess(true);
+    std::vector<std::exception_ptr> vExceptions(mapDenomCoins.size());
+    auto AccumulateDenom = [&](Accumulator* accumulator, const std::vector<const PublicCoin*>& vCoins, std::exception_ptr& exception) {
+        try {
+            for (const PublicCoin* pubCoin : vCoins) {
+                if (fSkipValidation) {
+                    accumulator->increment(pubCoin->getValue());
+                } else if (!accumulator->accumulate(*pubCoin)) {
+                    fSuccess = false;
+                    return;
+                }
+            }
+        } catch (...) {
+            exception = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> vThreads;
+    size_t i = 0;
+    for (const auto& mi : mapDenomCoins) {
+        // The last denomination is accumulated on this thread
+        if (++i < mapDenomCoins.size())
+            vThreads.emplace_back(AccumulateDenom, mapAccumulators.at(mi.first).get(), std::cref(mi.second), std::ref(vExceptions[i - 1]));
+        else
+            AccumulateDenom(mapAccumulators.at(mi.first).get(), mi.second, vExceptions[i - 1]);
+    }
+    for (std::thread& thread : vThreads)
+        thread.join();
+
+    for (const std::exception_ptr& exception : vExceptions) {
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+    return fSuccess;
+}
+
 libzerocoin::Accumulator AccumulatorMap::GetAccumulator(libzerocoin::CoinDenomination denom)
 {
     return libzerocoin::Accumulator(params, denom, GetValue(denom));
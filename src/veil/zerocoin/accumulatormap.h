@@ -9,6 +9,8 @@
 #include "libzerocoin/Coin.h"
 #include "arith_uint256.h"
 
+#include <list>
+
 //A map with an accumulator for each denomination
 class AccumulatorMap
 {
@@ -20,6 +22,7 @@ public:
     explicit AccumulatorMap(libzerocoin::ZerocoinParams* params);
     bool Load(const std::map<libzerocoin::CoinDenomination, uint256>& mapCheckpoints);
     bool Accumulate(const libzerocoin::PublicCoin& pubCoin, bool fSkipValidation = false);
+    bool Accumulate(const std::list<libzerocoin::PublicCoin>& listPubCoins, bool fSkipValidation = false);
     libzerocoin::Accumulator GetAccumulator(libzerocoin::CoinDenomination denom);
     CBigNum GetValue(libzerocoin::CoinDenomination denom);
     std::map<libzerocoin::CoinDenomination, uint256> GetCheckpoints(bool fShowZeroIfEmpty = false);
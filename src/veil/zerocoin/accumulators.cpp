@@ -28,8 +28,18 @@ struct ChecksumHeightHash
     }
 };
 
-std::map<uint256, CBigNum> mapAccumulatorValues;
+struct ChecksumHash
+{
+    std::size_t operator()(const uint256& hashChecksum) const
+    {
+        return hashChecksum.GetCheapHash();
+    }
+};
+
 std::list<uint256> listAccCheckpointsNoDB;
+// Decoded accumulator values by checksum. Values are written here as checkpoints are connected, so the
+// next checkpoint and recent witnesses find them without reading and decoding them from the database.
+static veil::SimpleLRUCache<uint256, CBigNum, ChecksumHash> cacheAccumulatorValues(1024);
 // This needs to be able to contain a reasonable number of distinct (accumulator hash, denom) pairs
 // that could occur in a block or it may not be effective.
 static veil::SimpleLRUCache<std::pair<uint256, CoinDenomination>, int, ChecksumHeightHash> cacheChecksumHeights(1024);
@@ -83,10 +93,8 @@ int GetChecksumHeight(uint256 hashChecksum, CoinDenomination denomination)
 
 bool GetAccumulatorValueFromChecksum(const uint256& hashChecksum, bool fMemoryOnly, CBigNum& bnAccValue)
 {
-    if (mapAccumulatorValues.count(hashChecksum)) {
-        bnAccValue = mapAccumulatorValues.at(hashChecksum);
+    if (cacheAccumulatorValues.get(hashChecksum, bnAccValue))
         return true;
-    }
 
     if (fMemoryOnly)
         return false;
@@ -95,6 +103,7 @@ bool GetAccumulatorValueFromChecksum(const uint256& hashChecksum, bool fMemoryOn
         bnAccValue = 0;
         return false;
     }
+    cacheAccumulatorValues.set(hashChecksum, bnAccValue);
 
     return true;
 }
@@ -107,7 +116,7 @@ bool GetAccumulatorValueFromDB(uint256 nCheckpoint, CoinDenomination denom, CBig
 void AddAccumulatorChecksum(const uint256& hashChecksum, const CBigNum &bnValue)
 {
     pzerocoinDB->WriteAccumulatorValue(hashChecksum, bnValue);
-    mapAccumulatorValues.emplace(std::make_pair(hashChecksum, bnValue));
+    cacheAccumulatorValues.set(hashChecksum, bnValue);
 }
 
 void DatabaseChecksums(AccumulatorMap& mapAccumulators)
@@ -122,7 +131,7 @@ void DatabaseChecksums(AccumulatorMap& mapAccumulators)
 bool EraseChecksum(uint256 hashChecksum)
 {
     //erase from both memory and database
-    mapAccumulatorValues.erase(hashChecksum);
+    cacheAccumulatorValues.erase(hashChecksum);
     return pzerocoinDB->EraseAccumulatorValue(hashChecksum);
 }
 
@@ -148,7 +157,7 @@ bool LoadAccumulatorValuesFromDB(const std::map<libzerocoin::CoinDenomination, u
             LogPrintf("%s : Missing databased value for checksum %d", __func__, hash.GetHex());
             return false;
         }
-        mapAccumulatorValues.insert(std::make_pair(hash, bnValue));
+        cacheAccumulatorValues.set(hash, bnValue);
     }
     return true;
 }
@@ -233,6 +242,7 @@ bool CalculateAccumulatorCheckpoint(int nHeight, std::map<libzerocoin::CoinDenom
     if (!pindex)
         return false;
 
+    std::list<PublicCoin> listPubcoinsAll;
     while (pindex->nHeight < nHeight - 10) {
         //grab mints from this block
         CBlock block;
@@ -244,16 +254,15 @@ bool CalculateAccumulatorCheckpoint(int nHeight, std::map<libzerocoin::CoinDenom
             return error("%s: failed to get zerocoin mintlist from block %d", __func__, pindex->nHeight);
 
         nTotalMintsFound += listPubcoins.size();
-
-        //add the pubcoins to accumulator
-        for (const PublicCoin& pubcoin : listPubcoins) {
-            if(!mapAccumulators.Accumulate(pubcoin, true))
-                return error("%s: failed to add pubcoin to accumulator at height %d", __func__, pindex->nHeight);
-        }
+        listPubcoinsAll.splice(listPubcoinsAll.end(), listPubcoins);
 
         pindex = chainActive.Next(pindex);
     }
 
+    //add the pubcoins to the accumulators, the denominations are accumulated in parallel
+    if (!mapAccumulators.Accumulate(listPubcoinsAll, true))
+        return error("%s: failed to add pubcoins to accumulators for checkpoint %d", __func__, nHeight);
+
     // if there were no new mints found, the accumulator checkpoint will be the same as the last checkpoint
     if (nTotalMintsFound == 0) {
         mapCheckpoints = chainActive[nHeight - 1]->mapAccumulatorHashes;
@@ -0,0 +1,127 @@
+// Copyright (c) 2019-2022 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/rescan.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <util/system.h>
+#include <validation.h>
+
+CRescanPipeline::CRescanPipeline(CBlockIndex* pindexStart, const CBlockIndex* pindexStopIn,
+                                 const std::vector<CStealthAddress>& vStealthAddresses, uint64_t nStealthGeneration, int nThreads)
+    : pindexStop(pindexStopIn), matcher(vStealthAddresses, nStealthGeneration)
+{
+    if (pindexStart) {
+        LOCK(cs_main);
+        pindexEnd = pindexStop ? pindexStop : chainActive.Tip();
+        nHeightNext = pindexStart->nHeight;
+        // The start is always read, even if it has been reorganized away, so the rescan can return it
+        if (!pindexEnd || pindexEnd->GetAncestor(pindexStart->nHeight) != pindexStart)
+            pindexEnd = pindexStart;
+        nHeightPos = nHeightClaimed = nHeightNext - 1;
+        std::lock_guard<std::mutex> lock(cs);
+        AddBlockPositions();
+    } else {
+        pindexEnd = nullptr;
+        nHeightNext = 0;
+        nHeightPos = nHeightClaimed = nHeightNext - 1;
+    }
+
+    for (int i = 0; i < std::max(1, nThreads); i++)
+        vThreads.emplace_back(&CRescanPipeline::ThreadRescanRead, this);
+}
+
+CRescanPipeline::~CRescanPipeline()
+{
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        fStop = true;
+    }
+    cond.notify_all();
+    for (std::thread& thread : vThreads)
+        thread.join();
+}
+
+void CRescanPipeline::AddBlockPositions()
+{
+    AssertLockHeld(cs_main);
+    int nHeightLast = std::min(pindexEnd->nHeight, nHeightNext + RESCAN_LOOKAHEAD);
+    for (; nHeightPos < nHeightLast; nHeightPos++)
+        mapBlockPos.emplace(nHeightPos + 1, pindexEnd->GetAncestor(nHeightPos + 1)->GetBlockPos());
+}
+
+void CRescanPipeline::ThreadRescanRead()
+{
+    RenameThread("veil-rescan");
+
+    while (true) {
+        auto prescan = MakeUnique<CRescanBlock>();
+        CDiskBlockPos blockPos;
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            cond.wait(lock, [this] { return fStop || nHeightClaimed < nHeightPos; });
+            if (fStop)
+                return;
+            prescan->pindex = const_cast<CBlockIndex*>(pindexEnd->GetAncestor(++nHeightClaimed));
+            auto it = mapBlockPos.find(nHeightClaimed);
+            blockPos = it->second;
+            mapBlockPos.erase(it);
+        }
+
+        // Not the CBlockIndex overload, it takes cs_main for the position
+        if (ReadBlockFromDisk(prescan->block, blockPos, Params().GetConsensus())
+                && prescan->block.GetHash() == prescan->pindex->GetBlockHash()) {
+            prescan->fRead = true;
+            for (const CTransactionRef& tx : prescan->block.vtx)
+                matcher.Match(*tx, prescan->stealthMatches);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(cs);
+            mapReady.emplace(prescan->pindex->nHeight, std::move(prescan));
+        }
+        cond.notify_all();
+    }
+}
+
+std::unique_ptr<CRescanBlock> CRescanPipeline::Next()
+{
+    {
+        // The caller may already hold cs_main, so it is always taken before cs
+        LOCK(cs_main);
+        std::unique_lock<std::mutex> lock(cs);
+        if (!pindexEnd || nHeightNext > pindexEnd->nHeight) {
+            if (pindexStop || !pindexEnd)
+                return nullptr;
+            // Follow the tip, as long as it builds on what was read so far
+            const CBlockIndex* pindexTip = chainActive.Tip();
+            if (pindexTip->nHeight <= pindexEnd->nHeight || pindexTip->GetAncestor(pindexEnd->nHeight) != pindexEnd)
+                return nullptr;
+            pindexEnd = pindexTip;
+        }
+        AddBlockPositions();
+    }
+    cond.notify_all();
+
+    std::unique_ptr<CRescanBlock> prescan;
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        cond.wait(lock, [this] { return mapReady.count(nHeightNext); });
+        auto it = mapReady.find(nHeightNext);
+        prescan = std::move(it->second);
+        mapReady.erase(it);
+        nHeightNext++;
+    }
+    cond.notify_all();
+    return prescan;
+}
+
+int GetRescanThreads()
+{
+    int nThreads = gArgs.GetArg("-rescanthreads", DEFAULT_RESCAN_THREADS);
+    if (nThreads <= 0)
+        nThreads = GetNumCores();
+    return std::max(1, std::min(nThreads, MAX_RESCAN_THREADS));
+}
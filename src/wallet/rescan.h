@@ -0,0 +1,79 @@
+// Copyright (c) 2019-2022 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef VEIL_WALLET_RESCAN_H
+#define VEIL_WALLET_RESCAN_H
+
+#include <chain.h>
+#include <primitives/block.h>
+#include <veil/ringct/anonwallet.h>
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! -rescanthreads default, 0 uses one thread per core
+static const int DEFAULT_RESCAN_THREADS = 0;
+static const int MAX_RESCAN_THREADS = 16;
+//! Number of blocks that are read and matched ahead of the block being added to the wallet
+static const int RESCAN_LOOKAHEAD = 64;
+
+/** A block of a rescan, read from disk with its stealth outputs matched */
+struct CRescanBlock
+{
+    CBlockIndex* pindex = nullptr;
+    bool fRead = false;
+    CBlock block;
+    CStealthMatches stealthMatches;
+};
+
+/**
+ * Reads and matches the blocks of a wallet rescan ahead of it. Worker threads read the blocks from pindexStart on
+ * from disk and match their stealth outputs against a copy of the wallet's stealth addresses, which is the ECDH
+ * work that dominates rescans of wallets with many stealth addresses. The rescan takes the blocks back in chain
+ * order and only has to add them to the wallet under the wallet lock.
+ *
+ * Callers may hold cs_main, so the workers never take it. The disk positions of the blocks ahead are looked up
+ * under cs_main by the constructor and Next, and the workers read the blocks from those positions and check their
+ * hashes. Without pindexStop Next follows the tip as it advances. A reorganization is not detected here, the
+ * rescan checks that every block it adds is still in the active chain.
+ */
+class CRescanPipeline
+{
+private:
+    /** Mutex protects the queue and the claimed heights */
+    std::mutex cs;
+    std::condition_variable cond;
+    std::map<int, std::unique_ptr<CRescanBlock>> mapReady; // by height
+    std::map<int, CDiskBlockPos> mapBlockPos; // positions of the blocks not yet claimed, by height
+    const CBlockIndex* pindexEnd; // last block to read
+    int nHeightPos; // last height with a looked up position
+    int nHeightClaimed; // last height a worker took
+    int nHeightNext; // next height to hand out
+    bool fStop = false;
+
+    const CBlockIndex* const pindexStop;
+    const CStealthOutputMatcher matcher;
+    std::vector<std::thread> vThreads;
+
+    void ThreadRescanRead();
+    /** Look up the positions of the blocks up to RESCAN_LOOKAHEAD ahead, requires cs_main and cs */
+    void AddBlockPositions();
+
+public:
+    CRescanPipeline(CBlockIndex* pindexStart, const CBlockIndex* pindexStopIn,
+                    const std::vector<CStealthAddress>& vStealthAddresses, uint64_t nStealthGeneration, int nThreads);
+    ~CRescanPipeline();
+
+    /** Wait for the next block in chain order. Returns nullptr once there are no more. */
+    std::unique_ptr<CRescanBlock> Next();
+};
+
+/** Number of rescan worker threads from -rescanthreads */
+int GetRescanThreads();
+
+#endif // VEIL_WALLET_RESCAN_H
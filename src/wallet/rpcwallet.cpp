@@ -18,6 +18,7 @@
 #include <policy/fees.h>
 #include <policy/policy.h>
 #include <policy/rbf.h>
+#include <rpc/jsonstream.h>
 #include <rpc/mining.h>
 #include <rpc/rawtransaction.h>
 #include <rpc/server.h>
@@ -850,7 +851,6 @@ static UniValue sendtoaddress(const JSONRPCRequest& request)
     CTransactionRef tx = SendMoney(pwallet, dest, nAmount, fSubtractFeeFromAmount, coin_control, std::move(mapValue), {} /* fromAccount */);
 
     if (fDandelion){
-        LOCK(veil::dandelion.cs);
         veil::dandelion.Add(tx->GetHash(), GetAdjustedTime() + veil::dandelion.nDefaultStemTime, veil::dandelion.nDefaultNodeID);
     }
 
@@ -1170,9 +1170,9 @@ static UniValue getwatchonlytxes(const JSONRPCRequest& request)
         return NullUniValue;
     }
 
-    if (request.fHelp || request.params.size() > 3)
+    if (request.fHelp || request.params.size() > 4)
         throw std::runtime_error(
-                "getwatchonlytxes \"scan_secret\" \"starting_index\" \"batch_size\""
+                "getwatchonlytxes \"scan_secret\" \"starting_index\" \"batch_size\" \"format\""
                 "\nFetch txes belonging to watchonly address with a certain scan key"
                 "\nThis rpccall will give transactions in batches (default 1000 at a time). "
 
@@ -1181,6 +1181,9 @@ static UniValue getwatchonlytxes(const JSONRPCRequest& request)
                                                      "1. \"scan_secret\"         (string, required) The private scan key for the address\n"
                                                      "2. \"starting_index\"      (number, optional default=0) The 0-based index to start from (0 = first transaction)\n"
                                                      "3. \"batch_size\"          (number, optional default=1000, max=1000) Number of transactions to return per call\n"
+                                                     "4. \"format\"              (string, optional default=\"json\") \"json\" for objects, or \"raw\" for only the\n"
+                                                     "                             serialized hex of each transaction (as \"raw\" in json format) without\n"
+                                                     "                             confirmations or block time\n"
                                                      "\nResult:\n"
                                                      "{\n"
                                                      "  \"anon\": [         (array) Array of anonymous transactions\n"
@@ -1258,9 +1261,19 @@ static UniValue getwatchonlytxes(const JSONRPCRequest& request)
         }
     }
 
+    // Parse format (param 4 - optional, default json)
+    bool fRaw = false;
+    if (request.params.size() > 3) {
+        const std::string strFormat = request.params[3].get_str();
+        if (strFormat == "raw") {
+            fRaw = true;
+        } else if (strFormat != "json") {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "format must be \"json\" or \"raw\"");
+        }
+    }
+
     int total_count = 0;
-    UniValue anonTxes(UniValue::VARR);
-    UniValue stealthTxes(UniValue::VARR);
+    std::vector<std::pair<int, CWatchOnlyTx>> vTxes;
 
     if (GetWatchOnlyKeyCount(scan_secret, total_count)) {
         // Database uses mixed indexing: index 0 exists for first tx (bug), then 1-based after that
@@ -1271,58 +1284,16 @@ static UniValue getwatchonlytxes(const JSONRPCRequest& request)
         // The requested range [dbStartIndex, dbEndIndex] deliberately extends past
         // total_count so that unflushed cached transactions (which occupy indices
         // total_count+1 and up) can be returned in the same batch. Only the
-        // database loop below is clamped to total_count; clamping dbEndIndex
+        // database read below is clamped to total_count; clamping dbEndIndex
         // itself would make the cached-transaction range check always fail.
         int dbLoopEnd = std::min(dbEndIndex, total_count);
 
-        // Fetch transactions from database
-        // Try index 0 first (handles buggy writes), then 1-based indices
-        for (int i = dbStartIndex; i <= dbLoopEnd; i++) {
-            CWatchOnlyTx watchonlytx;
-            if (ReadWatchOnlyTransaction(scan_secret, i, watchonlytx)) {
-                // Get transaction block information for confirmations and timestamp
-                int confirmations = -1;
-                int64_t blocktime = 0;
-
-                // Use stored block info if available (V2 database)
-                if (watchonlytx.nBlockHeight > 0) {
-                    // Fast path: use stored block height and time
-                    confirmations = 1 + chainActive.Height() - watchonlytx.nBlockHeight;
-                    blocktime = watchonlytx.nBlockTime;
-                } else {
-                    // Fallback for old database (pre-V2): fetch transaction from disk
-                    CTransactionRef tx;
-                    uint256 hash_block;
-
-                    // Try cache first
-                    if (!txCache.Get(watchonlytx.tx_hash, tx, hash_block)) {
-                        // Cache miss - fetch from disk
-                        if (GetTransaction(watchonlytx.tx_hash, tx, Params().GetConsensus(), hash_block, true)) {
-                            // Add to cache for future requests
-                            txCache.Add(watchonlytx.tx_hash, tx, hash_block);
-                        }
-                    }
-
-                    if (tx && !hash_block.IsNull()) {
-                        CBlockIndex* pindex = LookupBlockIndex(hash_block);
-                        if (pindex && chainActive.Contains(pindex)) {
-                            confirmations = 1 + chainActive.Height() - pindex->nHeight;
-                            blocktime = pindex->GetBlockTime();
-                        }
-                    }
-                }
-
-                // Add transaction to appropriate array
-                pblocktree->ReadRCTOutputLink(watchonlytx.ringctout.pk, watchonlytx.ringctIndex);
-                if (watchonlytx.type == CWatchOnlyTx::ANON) {
-                    anonTxes.push_back(watchonlytx.GetUniValue(i, false, "", uint256(), true, 0, confirmations, blocktime, ""));
-                } else if (watchonlytx.type == CWatchOnlyTx::STEALTH) {
-                    stealthTxes.push_back(watchonlytx.GetUniValue(i, false, "", uint256(), true, 0, confirmations, blocktime, ""));
-                }
-            }
+        // Fetch the whole batch from the database with a single range scan
+        if (!ReadWatchOnlyTransactions(scan_secret, dbStartIndex, dbLoopEnd, vTxes)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to read watchonly transactions from database");
         }
 
-        // After processing database transactions, append any unflushed cached transactions
+        // After the database transactions, append any unflushed cached transactions
         // that fall within the requested batch range
         std::vector<CWatchOnlyTx> vCachedTxes;
         watchonlyTxCache.GetCachedTxes(scan_secret, vCachedTxes);
@@ -1335,7 +1306,6 @@ static UniValue getwatchonlytxes(const JSONRPCRequest& request)
             int cacheDbStartIndex = total_count + 1;
 
             for (size_t i = 0; i < vCachedTxes.size(); i++) {
-                const CWatchOnlyTx& watchonlytx = vCachedTxes[i];
                 int txDbIndex = cacheDbStartIndex + i;
 
                 // Only include cached transactions that fall within the requested batch range
@@ -1345,28 +1315,80 @@ static UniValue getwatchonlytxes(const JSONRPCRequest& request)
                 if (txDbIndex > dbEndIndex) {
                     break; // Beyond requested range, stop processing
                 }
+                vTxes.emplace_back(txDbIndex, vCachedTxes[i]);
+            }
+        }
 
-                // Get transaction block information for confirmations and timestamp
-                int confirmations = -1;
-                int64_t blocktime = 0;
+        LoadWatchOnlyRingCTIndexes(vTxes);
+    }
 
-                // Use stored block info if available
-                if (watchonlytx.nBlockHeight > 0) {
-                    confirmations = 1 + chainActive.Height() - watchonlytx.nBlockHeight;
-                    blocktime = watchonlytx.nBlockTime;
-                }
+    auto txToJSON = [&](const std::pair<int, CWatchOnlyTx>& entry) {
+        const CWatchOnlyTx& watchonlytx = entry.second;
+        if (fRaw)
+            return UniValue(watchonlytx.GetRaw());
+
+        // Get transaction block information for confirmations and timestamp
+        int confirmations = -1;
+        int64_t blocktime = 0;
 
-                // Add transaction to appropriate array
-                int64_t ringctIndex = 0;
-                pblocktree->ReadRCTOutputLink(watchonlytx.ringctout.pk, ringctIndex);
+        // Use stored block info if available (V2 database)
+        if (watchonlytx.nBlockHeight > 0) {
+            // Fast path: use stored block height and time
+            confirmations = 1 + chainActive.Height() - watchonlytx.nBlockHeight;
+            blocktime = watchonlytx.nBlockTime;
+        } else {
+            // Fallback for old database (pre-V2): fetch transaction from disk
+            CTransactionRef tx;
+            uint256 hash_block;
+
+            // Try cache first
+            if (!txCache.Get(watchonlytx.tx_hash, tx, hash_block)) {
+                // Cache miss - fetch from disk
+                if (GetTransaction(watchonlytx.tx_hash, tx, Params().GetConsensus(), hash_block, true)) {
+                    // Add to cache for future requests
+                    txCache.Add(watchonlytx.tx_hash, tx, hash_block);
+                }
+            }
 
-                if (watchonlytx.type == CWatchOnlyTx::ANON) {
-                    anonTxes.push_back(watchonlytx.GetUniValue(txDbIndex, false, "", uint256(), true, 0, confirmations, blocktime, ""));
-                } else if (watchonlytx.type == CWatchOnlyTx::STEALTH) {
-                    stealthTxes.push_back(watchonlytx.GetUniValue(txDbIndex, false, "", uint256(), true, 0, confirmations, blocktime, ""));
+            if (tx && !hash_block.IsNull()) {
+                CBlockIndex* pindex = LookupBlockIndex(hash_block);
+                if (pindex && chainActive.Contains(pindex)) {
+                    confirmations = 1 + chainActive.Height() - pindex->nHeight;
+                    blocktime = pindex->GetBlockTime();
                 }
             }
         }
+
+        int nIndex = entry.first;
+        return watchonlytx.GetUniValue(nIndex, false, "", uint256(), true, 0, confirmations, blocktime, "");
+    };
+
+    // Write the transactions out one at a time when the result is streamed
+    if (request.stream) {
+        JSONStreamWriter& writer = *request.stream;
+        writer.BeginObject();
+        for (int type : {CWatchOnlyTx::ANON, CWatchOnlyTx::STEALTH}) {
+            writer.Key(type == CWatchOnlyTx::ANON ? "anon" : "stealth");
+            writer.BeginArray();
+            for (const auto& entry : vTxes) {
+                if (entry.second.type == type)
+                    writer.Value(txToJSON(entry));
+            }
+            writer.EndArray();
+        }
+        writer.EndObject();
+        return NullUniValue;
+    }
+
+    UniValue anonTxes(UniValue::VARR);
+    UniValue stealthTxes(UniValue::VARR);
+    for (const auto& entry : vTxes) {
+        // Add transaction to appropriate array
+        if (entry.second.type == CWatchOnlyTx::ANON) {
+            anonTxes.push_back(txToJSON(entry));
+        } else if (entry.second.type == CWatchOnlyTx::STEALTH) {
+            stealthTxes.push_back(txToJSON(entry));
+        }
     }
 
     UniValue ret(UniValue::VOBJ);
@@ -1473,7 +1495,6 @@ static UniValue checkkeyimages(const JSONRPCRequest& request)
         );
 
     LOCK(cs_main);
-    LOCK(mempool.cs);
 
     RPCTypeCheck(request.params, {
         UniValue::VARR }, false
@@ -1481,8 +1502,29 @@ static UniValue checkkeyimages(const JSONRPCRequest& request)
 
     UniValue keyimageinfo = request.params[0].get_array();
 
-    UniValue result(UniValue::VARR);
+    // Look everything up in two batches, the chain first and then the mempool for what isn't spent in the chain
+    std::vector<CCmpPubKey> vKeyImages;
+    for (unsigned int idx = 0; idx < keyimageinfo.size(); idx++) {
+        const std::string hex_str = keyimageinfo[idx].get_str();
+        if (!IsHex(hex_str) || hex_str.size() != 66)
+            continue;
+        std::vector<uint8_t> v = ParseHex(hex_str);
+        vKeyImages.emplace_back(v.begin(), v.end());
+    }
+
+    std::map<CCmpPubKey, uint256> mapSpentInChain;
+    pblocktree->ReadRCTKeyImages(vKeyImages, mapSpentInChain);
 
+    std::vector<CCmpPubKey> vUnspentInChain;
+    for (const CCmpPubKey& ki : vKeyImages) {
+        if (!mapSpentInChain.count(ki))
+            vUnspentInChain.emplace_back(ki);
+    }
+    std::map<CCmpPubKey, uint256> mapSpentInMempool;
+    mempool.HaveKeyImages(vUnspentInChain, mapSpentInMempool);
+
+    UniValue result(UniValue::VARR);
+    size_t nKeyImage = 0;
     for (unsigned int idx = 0; idx < keyimageinfo.size(); idx++) {
         UniValue keyimage(UniValue::VOBJ);
         const std::string hex_str = keyimageinfo[idx].get_str();
@@ -1494,15 +1536,19 @@ static UniValue checkkeyimages(const JSONRPCRequest& request)
             continue;
         }
 
-        std::vector<uint8_t> v = ParseHex(hex_str);
-        CCmpPubKey ki(v.begin(), v.end());
+        const CCmpPubKey& ki = vKeyImages[nKeyImage++];
 
         uint256 tx_hash;
         bool spent_in_mempool = false;
-        bool spent_in_chain = pblocktree->ReadRCTKeyImage(ki, tx_hash);
+        bool spent_in_chain = false;
 
-        if (!spent_in_chain && mempool.HaveKeyImage(ki, tx_hash)) {
+        auto mi = mapSpentInChain.find(ki);
+        if (mi != mapSpentInChain.end()) {
+            spent_in_chain = true;
+            tx_hash = mi->second;
+        } else if ((mi = mapSpentInMempool.find(ki)) != mapSpentInMempool.end()) {
             spent_in_mempool = true;
+            tx_hash = mi->second;
         }
         keyimage.pushKV("status", "valid");
         keyimage.pushKV("spent", spent_in_chain);
@@ -6610,7 +6656,7 @@ static const CRPCCommand commands[] =
     { "wallet",             "setlabel",                         &setlabel,                      {"address","label"} },
     { "wallet",             "viewscankeys",                   &viewscankeys,                    {"address"} },
     { "wallet",             "getwatchonlyaddresses",            &getwatchonlyaddresses,         {} },
-    { "wallet",             "getwatchonlytxes",                 &getwatchonlytxes,              {"scan_secret", "starting_index", "batch_size"}},
+    { "wallet",             "getwatchonlytxes",                 &getwatchonlytxes,              {"scan_secret", "starting_index", "batch_size", "format"}},
     { "wallet",             "compactwatchonlydb",               &compactwatchonlydb,            {} },
 
     { "info",             "checkkeyimage",                      &checkkeyimage,                 {"key_image"} },
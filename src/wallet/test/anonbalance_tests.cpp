@@ -0,0 +1,128 @@
+// Copyright (c) 2026 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Tests for the unspent record index the AnonWallet balances and coin
+// selection walk, and the cached GetBalances totals built on it.
+
+#include <test/test_veil.h>
+
+#include <validation.h>
+#include <veil/ringct/anonwallet.h>
+#include <wallet/wallet.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+CTransactionRecord MakeRecord(const uint256& hashBlock, CAmount nValue, uint8_t nFlags)
+{
+    CTransactionRecord rtx;
+    rtx.blockHash = hashBlock;
+    rtx.nIndex = 0;
+
+    COutputRecord rout;
+    rout.n = 0;
+    rout.nType = OUTPUT_CT;
+    rout.nFlags = nFlags;
+    rout.SetValue(nValue);
+    rtx.InsertOutput(rout);
+    return rtx;
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(anonbalance_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(unspent_record_index)
+{
+    std::shared_ptr<CWallet> wallet = std::make_shared<CWallet>("mock", WalletDatabase::CreateMock());
+    std::shared_ptr<WalletDatabase> database = WalletDatabase::CreateMock();
+    AnonWallet anon(wallet, "anonwallet", database);
+
+    uint256 hashTip;
+    {
+        LOCK(cs_main);
+        hashTip = chainActive.Tip()->GetBlockHash();
+    }
+
+    const uint256 txOwned = InsecureRand256();
+    const uint256 txSent = InsecureRand256();
+    const uint256 txSpent = InsecureRand256();
+    {
+        LOCK(wallet->cs_wallet);
+        anon.LoadToWallet(txOwned, MakeRecord(hashTip, 5 * COIN, ORF_OWNED));
+        anon.LoadToWallet(txSent, MakeRecord(hashTip, 7 * COIN, ORF_FROM));
+        anon.LoadToWallet(txSpent, MakeRecord(hashTip, 9 * COIN, ORF_OWNED | ORF_SPENT));
+    }
+
+    // Only records holding an owned output not flagged spent are walked
+    BOOST_CHECK_EQUAL(anon.setUnspentRecords.size(), 1U);
+    BOOST_CHECK(anon.setUnspentRecords.count(txOwned));
+
+    // One confirmation, so immature; a second call is served from the cache
+    for (int i = 0; i < 2; i++) {
+        BalanceList bal;
+        BOOST_CHECK(anon.GetBalances(bal));
+        BOOST_CHECK_EQUAL(bal.nCTImmature, 5 * COIN);
+        BOOST_CHECK_EQUAL(bal.nCT, 0);
+    }
+    BOOST_CHECK_EQUAL(anon.GetBlindBalance(), 5 * COIN);
+
+    // Spending the output drops the record and the cached totals
+    {
+        LOCK(wallet->cs_wallet);
+        anon.MarkOutputSpent(COutPoint(txOwned, 0), true);
+    }
+    BOOST_CHECK(anon.setUnspentRecords.empty());
+    BalanceList bal;
+    BOOST_CHECK(anon.GetBalances(bal));
+    BOOST_CHECK_EQUAL(bal.nCTImmature, 0);
+    BOOST_CHECK_EQUAL(anon.GetBlindBalance(), 0);
+
+    // And unspending it brings both back
+    {
+        LOCK(wallet->cs_wallet);
+        anon.MarkOutputSpent(COutPoint(txOwned, 0), false);
+    }
+    BOOST_CHECK(anon.setUnspentRecords.count(txOwned));
+    bal.Clear();
+    BOOST_CHECK(anon.GetBalances(bal));
+    BOOST_CHECK_EQUAL(bal.nCTImmature, 5 * COIN);
+}
+
+// An output flagged spent still counts while its spender is conflicted, as
+// IsSpent goes by the spender's depth, and stops counting once the spender
+// is in a block.
+BOOST_AUTO_TEST_CASE(conflicted_spend)
+{
+    std::shared_ptr<CWallet> wallet = std::make_shared<CWallet>("mock", WalletDatabase::CreateMock());
+    std::shared_ptr<WalletDatabase> database = WalletDatabase::CreateMock();
+    AnonWallet anon(wallet, "anonwallet", database);
+
+    LOCK2(cs_main, wallet->cs_wallet);
+    const uint256 hashTip = chainActive.Tip()->GetBlockHash();
+
+    const uint256 txOwned = InsecureRand256();
+    const uint256 txSpend = InsecureRand256();
+    CTransactionRecord rtxSpend = MakeRecord(hashTip, 1 * COIN, ORF_FROM);
+    rtxSpend.nIndex = -1; // conflicted by the tip
+    anon.LoadToWallet(txOwned, MakeRecord(hashTip, 5 * COIN, ORF_OWNED | ORF_SPENT));
+    anon.LoadToWallet(txSpend, rtxSpend);
+
+    // Without a known spender the flag decides
+    BOOST_CHECK(anon.setUnspentRecords.empty());
+    BOOST_CHECK_EQUAL(anon.GetBlindBalance(), 0);
+
+    anon.AddToSpends(COutPoint(txOwned, 0), txSpend);
+    BOOST_CHECK(anon.setUnspentRecords.count(txOwned));
+    BOOST_CHECK(!anon.IsSpent(txOwned, 0));
+    BOOST_CHECK_EQUAL(anon.GetBlindBalance(), 5 * COIN);
+
+    rtxSpend.nIndex = 0;
+    BOOST_REQUIRE(anon.SaveRecord(txSpend, rtxSpend));
+    BOOST_CHECK(anon.IsSpent(txOwned, 0));
+    BOOST_CHECK_EQUAL(anon.GetBlindBalance(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
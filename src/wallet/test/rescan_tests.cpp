@@ -0,0 +1,151 @@
+// Copyright (c) 2026 The Veil developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Tests for the stealth output matching a rescan runs off the wallet lock and
+// the prefix index it shares with the wallet.
+
+#include <test/test_veil.h>
+
+#include <key.h>
+#include <validation.h>
+#include <primitives/transaction.h>
+#include <veil/ringct/anonwallet.h>
+#include <veil/ringct/stealth.h>
+#include <wallet/rescan.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+struct StealthTestingSetup : public BasicTestingSetup {
+    StealthTestingSetup()
+    {
+        ECC_Stop_Stealth();
+        ECC_Start_Stealth();
+    }
+    ~StealthTestingSetup()
+    {
+        ECC_Stop_Stealth();
+    }
+
+    static CStealthAddress NewStealthAddress()
+    {
+        CStealthAddress sx;
+        CKey spend_secret;
+        sx.scan_secret.MakeNewKey(true);
+        spend_secret.MakeNewKey(true);
+        SecretToPublicKey(sx.scan_secret, sx.scan_pubkey);
+        SecretToPublicKey(spend_secret, sx.spend_pubkey);
+        return sx;
+    }
+
+    // A RingCT output sent to sx, as a sender derives it
+    static CTxOutBaseRef SendTo(const CStealthAddress& sx, CStealthMatches::OutputKey& key)
+    {
+        CKey sEphem, sShared;
+        ec_point pkSendTo;
+        do {
+            sEphem.MakeNewKey(true);
+        } while (StealthSecret(sEphem, sx.scan_pubkey, sx.spend_pubkey, sShared, pkSendTo) != 0);
+
+        auto txout = MAKE_OUTPUT<CTxOutRingCT>();
+        CTxOutRingCT* rctout = (CTxOutRingCT*)txout.get();
+        rctout->pk = CCmpPubKey(pkSendTo);
+        CPubKey pkEphem = sEphem.GetPubKey();
+        rctout->vData.assign(pkEphem.begin(), pkEphem.end());
+
+        key = CStealthMatches::OutputKey(rctout->pk.GetID(), rctout->vData);
+        return txout;
+    }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(rescan_tests, StealthTestingSetup)
+
+// Outputs sent to an owned stealth address are found with the address they
+// were sent to, all other outputs are only recorded as matched.
+BOOST_AUTO_TEST_CASE(match_stealth_outputs)
+{
+    const CStealthAddress sxOwned = NewStealthAddress();
+    const CStealthAddress sxOther = NewStealthAddress();
+    std::vector<CStealthAddress> vStealthAddresses{NewStealthAddress(), sxOwned};
+
+    CStealthMatches::OutputKey keyOwned, keyOther;
+    CMutableTransaction mtx;
+    mtx.vpout.push_back(SendTo(sxOther, keyOther));
+    mtx.vpout.push_back(SendTo(sxOwned, keyOwned));
+    mtx.vpout.push_back(MAKE_OUTPUT<CTxOutData>()); // not a stealth output
+
+    CStealthMatches matches;
+    CStealthOutputMatcher(vStealthAddresses, 7).Match(CTransaction(mtx), matches);
+
+    BOOST_CHECK_EQUAL(matches.nGeneration, 7U);
+    BOOST_CHECK_EQUAL(matches.setMatched.size(), 2U);
+    BOOST_CHECK(matches.setMatched.count(keyOther));
+    BOOST_REQUIRE_EQUAL(matches.mapOwned.size(), 1U);
+    BOOST_CHECK(matches.mapOwned.at(keyOwned) == sxOwned.GetID());
+
+    // Without the scan secret the address can't be matched
+    vStealthAddresses[1].scan_secret = CKey();
+    matches.Clear();
+    CStealthOutputMatcher(vStealthAddresses, 8).Match(CTransaction(mtx), matches);
+    BOOST_CHECK_EQUAL(matches.setMatched.size(), 2U);
+    BOOST_CHECK(matches.mapOwned.empty());
+}
+
+// Outputs with a prefix only reach addresses without one or with a prefix
+// they carry, outputs without a prefix only addresses without one.
+BOOST_AUTO_TEST_CASE(prefix_index_candidates)
+{
+    CStealthAddress sxNone = NewStealthAddress();
+    CStealthAddress sx4 = NewStealthAddress();
+    sx4.prefix.number_bits = 4;
+    sx4.prefix.bitfield = 0xA5;
+    CStealthAddress sx8 = NewStealthAddress();
+    sx8.prefix.number_bits = 8;
+    sx8.prefix.bitfield = 0x1234;
+
+    CStealthPrefixIndex index;
+    index.Add(sxNone);
+    index.Add(sx4);
+    index.Add(sx8);
+
+    auto Candidates = [&](uint32_t nPrefix, bool fHavePrefix) {
+        std::vector<CKeyID> v;
+        index.GetCandidates(nPrefix, fHavePrefix, v);
+        return std::set<CKeyID>(v.begin(), v.end());
+    };
+    BOOST_CHECK(Candidates(0, false) == std::set<CKeyID>({sxNone.GetID()}));
+    BOOST_CHECK(Candidates(0xFFFFFF35, true) == std::set<CKeyID>({sxNone.GetID(), sx4.GetID()}));
+    BOOST_CHECK(Candidates(0x00000034, true) == std::set<CKeyID>({sxNone.GetID(), sx8.GetID()}));
+    BOOST_CHECK(Candidates(0x00000035, true) == std::set<CKeyID>({sxNone.GetID(), sx4.GetID()}));
+    BOOST_CHECK(Candidates(0x000000F5, true) == std::set<CKeyID>({sxNone.GetID(), sx4.GetID()}));
+
+    index.Remove(sx4);
+    index.Remove(sxNone);
+    BOOST_CHECK(Candidates(0, false).empty());
+    BOOST_CHECK(Candidates(0xFFFFFF35, true).empty());
+    BOOST_CHECK(Candidates(0x00000034, true) == std::set<CKeyID>({sx8.GetID()}));
+}
+
+// Callers rescan while holding cs_main, the workers must read the blocks
+// without it.
+BOOST_FIXTURE_TEST_CASE(pipeline_reads_under_cs_main, TestChain100Setup)
+{
+    LOCK(cs_main);
+    CBlockIndex* pindexStart = chainActive[1];
+    CRescanPipeline pipeline(pindexStart, chainActive.Tip(), {}, 0, 4);
+
+    int nHeight = pindexStart->nHeight;
+    while (std::unique_ptr<CRescanBlock> prescan = pipeline.Next()) {
+        BOOST_CHECK_EQUAL(prescan->pindex->nHeight, nHeight);
+        BOOST_CHECK(prescan->fRead);
+        BOOST_CHECK(prescan->block.GetHash() == prescan->pindex->GetBlockHash());
+        nHeight++;
+    }
+    BOOST_CHECK_EQUAL(nHeight, chainActive.Height() + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -30,6 +30,7 @@
 #include <txmempool.h>
 #include <util/moneystr.h>
 #include <wallet/fees.h>
+#include <wallet/rescan.h>
 #include <wallet/walletutil.h>
 #include <veil/zerocoin/accumulators.h>
 #include <wallet/deterministicmint.h>
@@ -2145,8 +2146,21 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlock
             }
         }
         double progress_current = progress_begin;
-        while (pindex && !fAbortRescan && !ShutdownRequested())
+
+        // Blocks are read and their stealth outputs matched by the pipeline threads, ahead of being added here
+        AnonWallet* pAnonWallet = GetAnonWallet();
+        std::vector<CStealthAddress> vStealthAddresses;
+        uint64_t nStealthGeneration = 0;
+        if (pAnonWallet) {
+            LOCK(cs_wallet);
+            vStealthAddresses = pAnonWallet->GetStealthAddressesForMatching(nStealthGeneration);
+        }
+        CRescanPipeline pipeline(pindex, pindexStop, vStealthAddresses, nStealthGeneration, GetRescanThreads());
+
+        std::unique_ptr<CRescanBlock> prescan;
+        while (!fAbortRescan && !ShutdownRequested() && (prescan = pipeline.Next()))
         {
+            pindex = prescan->pindex;
             int percentageDone = std::max(1, std::min(99, (int)((progress_current - progress_begin) / (progress_end - progress_begin) * 100)));
             if (pindex->nHeight % 100 == 0 && progress_end - progress_begin > 0.0) {
                 uiInterface.ShowProgress(strprintf("%s " + _("Rescanning..."), GetDisplayName()), percentageDone, 0);
@@ -2156,15 +2170,17 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlock
                 WalletLogPrintf("Still rescanning. At block %d. Progress=%f\n", pindex->nHeight, progress_current);
             }
 
-            CBlock block;
-            if (ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            if (prescan->fRead) {
+                const CBlock& block = prescan->block;
                 LOCK2(cs_main, cs_wallet);
-                if (pindex && !chainActive.Contains(pindex)) {
+                if (!chainActive.Contains(pindex)) {
                     // Abort scan if current block is no longer active, to prevent
                     // marking transactions as coming from the wrong block.
                     ret = pindex;
                     break;
                 }
+                if (pAnonWallet)
+                    pAnonWallet->SetStealthMatches(std::move(prescan->stealthMatches));
                 for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
                     if (block.vtx[posInBlock]->IsZerocoinSpend()) {
                         uint256 txid = block.vtx[posInBlock]->GetHash();
@@ -2183,15 +2199,13 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlock
                     }
                     SyncTransaction(block.vtx[posInBlock], pindex, posInBlock, fUpdate);
                 }
+                if (pAnonWallet)
+                    pAnonWallet->ClearStealthMatches();
             } else {
                 ret = pindex;
             }
-            if (pindex == pindexStop) {
-                break;
-            }
             {
                 LOCK(cs_main);
-                pindex = chainActive.Next(pindex);
                 progress_current = GuessVerificationProgress(chainParams.TxData(), pindex);
                 if (pindexStop == nullptr && tip != chainActive.Tip()) {
                     tip = chainActive.Tip();
@@ -6698,6 +6712,7 @@ bool CWallet::CreateZerocoinSpendTransaction(CAmount nValue, int nSecurityLevel,
             uint256 txidOld = rtx.GetPartialTxid();
             if (!txidOld.IsNull() && pAnonWalletMain->mapRecords.count(txidOld)) {
                 pAnonWalletMain->mapRecords.erase(txidOld);
+                pAnonWalletMain->UpdateUnspentRecord(txidOld);
                 rtx.RemovePartialTxid();
             }
             pAnonWalletMain->SaveRecord(txHash, rtx);
@@ -690,7 +690,7 @@ protected:
 
     //sub wallets
     CzWallet* zwalletMain;
-    AnonWallet* pAnonWalletMain;
+    AnonWallet* pAnonWalletMain = nullptr;
 
     bool fBackupMints;
     std::unique_ptr<CzTracker> zTracker;
@@ -7,6 +7,7 @@
 
 #include <zmq/zmqconfig.h>
 
+class CBlock;
 class CBlockIndex;
 class CZMQAbstractNotifier;
 
@@ -34,6 +35,8 @@ public:
 
     virtual bool NotifyBlock(const CBlockIndex *pindex);
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    virtual bool NotifyBlockConnected(const CBlock &block, const CBlockIndex *pindex);
+    virtual bool NotifyBlockDisconnected(const CBlock &block, const CBlockIndex *pindex);
 
 protected:
     void *psocket;
@@ -48,6 +48,10 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
+    factories["pubanonoutput"] = CZMQAbstractNotifier::Create<CZMQPublishAnonOutputNotifier>;
+    factories["pubkeyimage"] = CZMQAbstractNotifier::Create<CZMQPublishKeyImageNotifier>;
+    factories["pubzerocoinmint"] = CZMQAbstractNotifier::Create<CZMQPublishZerocoinMintNotifier>;
+    factories["pubzerocoinspend"] = CZMQAbstractNotifier::Create<CZMQPublishZerocoinSpendNotifier>;
 
     for (const auto& entry : factories)
     {
@@ -174,12 +178,34 @@ void CZMQNotificationInterface::TransactionAddedToMempool(const CTransactionRef&
     }
 }
 
+template <typename Function>
+static void TryForEachAndRemoveFailed(std::list<CZMQAbstractNotifier*>& notifiers, const Function& func)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        if (func(notifier))
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
+
 void CZMQNotificationInterface::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexConnected, const std::vector<CTransactionRef>& vtxConflicted)
 {
     for (const CTransactionRef& ptx : pblock->vtx) {
         // Do a normal notify for each transaction added in the block
         TransactionAddedToMempool(ptx);
     }
+
+    TryForEachAndRemoveFailed(notifiers, [&pblock, pindexConnected](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyBlockConnected(*pblock, pindexConnected);
+    });
 }
 
 void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock)
@@ -188,6 +214,15 @@ void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CB
         // Do a normal notify for each transaction removed in block disconnection
         TransactionAddedToMempool(ptx);
     }
+
+    // The index entry outlives the disconnection, the records need its height and anon output count
+    const CBlockIndex* pindex = LookupBlockIndex(pblock->GetHash());
+    if (!pindex)
+        return;
+
+    TryForEachAndRemoveFailed(notifiers, [&pblock, pindex](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyBlockDisconnected(*pblock, pindex);
+    });
 }
 
 CZMQNotificationInterface* g_zmq_notification_interface = nullptr;
@@ -9,6 +9,8 @@
 #include <validation.h>
 #include <util/system.h>
 #include <rpc/server.h>
+#include <primitives/zerocoin.h>
+#include <veil/zerocoin/zchain.h>
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
@@ -16,6 +18,10 @@ static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_ANONOUTPUT     = "anonoutput";
+static const char *MSG_KEYIMAGE       = "keyimage";
+static const char *MSG_ZEROCOINMINT   = "zerocoinmint";
+static const char *MSG_ZEROCOINSPEND  = "zerocoinspend";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -195,3 +201,141 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     ss << transaction;
     return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
+
+bool CZMQAbstractBlockRecordNotifier::SendBlockRecords(const CBlock &block, const CBlockIndex *pindex, bool fConnected)
+{
+    CDataStream ssRecords(SER_NETWORK, PROTOCOL_VERSION);
+    uint32_t nRecords = 0;
+    if (!WriteRecords(block, pindex, ssRecords, nRecords)) {
+        zmqError("Can't read block records");
+        return false;
+    }
+    if (nRecords == 0)
+        return true;
+
+    LogPrint(BCLog::ZMQ, "zmq: Publish %s %s, %u records\n", GetCommand(), pindex->GetBlockHash().GetHex(), nRecords);
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << pindex->GetBlockHash() << (int32_t)pindex->nHeight << (uint8_t)fConnected;
+    WriteCompactSize(ss, nRecords);
+    ss.write(ssRecords.data(), ssRecords.size());
+
+    return SendMessage(GetCommand(), &(*ss.begin()), ss.size());
+}
+
+bool CZMQAbstractBlockRecordNotifier::NotifyBlockConnected(const CBlock &block, const CBlockIndex *pindex)
+{
+    return SendBlockRecords(block, pindex, true);
+}
+
+bool CZMQAbstractBlockRecordNotifier::NotifyBlockDisconnected(const CBlock &block, const CBlockIndex *pindex)
+{
+    return SendBlockRecords(block, pindex, false);
+}
+
+const char *CZMQPublishAnonOutputNotifier::GetCommand() const
+{
+    return MSG_ANONOUTPUT;
+}
+
+bool CZMQPublishAnonOutputNotifier::WriteRecords(const CBlock &block, const CBlockIndex *pindex, CDataStream &ss, uint32_t &nRecords)
+{
+    // Anon outputs are indexed in block order, continuing from the last index of the previous block
+    int64_t nIndex = pindex->pprev ? pindex->pprev->nAnonOutputs : 0;
+    for (const CTransactionRef &ptx : block.vtx) {
+        for (uint32_t k = 0; k < ptx->vpout.size(); k++) {
+            if (!ptx->vpout[k]->IsType(OUTPUT_RINGCT))
+                continue;
+
+            const CTxOutRingCT *txout = (const CTxOutRingCT*)ptx->vpout[k].get();
+            ss << ++nIndex;
+            ss.write((const char*)txout->pk.begin(), 33);
+            ss.write((const char*)&txout->commitment.data[0], 33);
+            ss << COutPoint(ptx->GetHash(), k);
+            nRecords++;
+        }
+    }
+    return true;
+}
+
+const char *CZMQPublishKeyImageNotifier::GetCommand() const
+{
+    return MSG_KEYIMAGE;
+}
+
+bool CZMQPublishKeyImageNotifier::WriteRecords(const CBlock &block, const CBlockIndex *pindex, CDataStream &ss, uint32_t &nRecords)
+{
+    for (const CTransactionRef &ptx : block.vtx) {
+        for (const CTxIn &txin : ptx->vin) {
+            if (!txin.IsAnonInput())
+                continue;
+
+            uint32_t nAnonInputs, nRingSize;
+            txin.GetAnonInfo(nAnonInputs, nRingSize);
+            if (txin.scriptData.stack.size() != 1 || txin.scriptData.stack[0].size() != 33 * nAnonInputs)
+                return false;
+
+            const std::vector<uint8_t> &vKeyImages = txin.scriptData.stack[0];
+            for (size_t k = 0; k < nAnonInputs; ++k) {
+                ss.write((const char*)&vKeyImages[k * 33], 33);
+                ss << ptx->GetHash();
+                nRecords++;
+            }
+        }
+    }
+    return true;
+}
+
+const char *CZMQPublishZerocoinMintNotifier::GetCommand() const
+{
+    return MSG_ZEROCOINMINT;
+}
+
+bool CZMQPublishZerocoinMintNotifier::WriteRecords(const CBlock &block, const CBlockIndex *pindex, CDataStream &ss, uint32_t &nRecords)
+{
+    for (const CTransactionRef &ptx : block.vtx) {
+        if (!ptx->IsZerocoinMint())
+            continue;
+
+        for (uint32_t k = 0; k < ptx->vpout.size(); k++) {
+            if (!ptx->vpout[k]->IsZerocoinMint())
+                continue;
+
+            libzerocoin::PublicCoin pubCoin(Params().Zerocoin_Params());
+            if (!OutputToPublicCoin(ptx->vpout[k].get(), pubCoin))
+                return false;
+
+            ss << GetPubCoinHash(pubCoin.getValue()) << libzerocoin::ZerocoinDenominationToAmount(pubCoin.getDenomination());
+            ss << COutPoint(ptx->GetHash(), k);
+            nRecords++;
+        }
+    }
+    return true;
+}
+
+const char *CZMQPublishZerocoinSpendNotifier::GetCommand() const
+{
+    return MSG_ZEROCOINSPEND;
+}
+
+bool CZMQPublishZerocoinSpendNotifier::WriteRecords(const CBlock &block, const CBlockIndex *pindex, CDataStream &ss, uint32_t &nRecords)
+{
+    for (const CTransactionRef &ptx : block.vtx) {
+        if (!ptx->IsZerocoinSpend())
+            continue;
+
+        for (const CTxIn &txin : ptx->vin) {
+            if (!txin.IsZerocoinSpend())
+                continue;
+
+            auto spend = TxInToZerocoinSpend(txin);
+            if (!spend)
+                return false;
+
+            ss << GetSerialHash(spend->getCoinSerialNumber()) << libzerocoin::ZerocoinDenominationToAmount(spend->getDenomination());
+            ss << ptx->GetHash();
+            nRecords++;
+        }
+    }
+    return true;
+}
@@ -8,6 +8,7 @@
 #include <zmq/zmqabstractnotifier.h>
 
 class CBlockIndex;
+class CDataStream;
 
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
 {
@@ -52,4 +53,57 @@ public:
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
+/**
+ * Publishes one message per connected or disconnected block holding the block's records of one kind, so
+ * indexers don't have to fetch and parse the raw block. Blocks without any records are not published.
+ * The message data is the block hash, the block height (int32), 1 if the block was connected or 0 if it
+ * was disconnected, and a compact size prefixed vector of records.
+ */
+class CZMQAbstractBlockRecordNotifier : public CZMQAbstractPublishNotifier
+{
+private:
+    bool SendBlockRecords(const CBlock &block, const CBlockIndex *pindex, bool fConnected);
+
+protected:
+    virtual const char *GetCommand() const = 0;
+    /** Serialize the block's records into ss, returns false if the block could not be parsed */
+    virtual bool WriteRecords(const CBlock &block, const CBlockIndex *pindex, CDataStream &ss, uint32_t &nRecords) = 0;
+
+public:
+    bool NotifyBlockConnected(const CBlock &block, const CBlockIndex *pindex) override;
+    bool NotifyBlockDisconnected(const CBlock &block, const CBlockIndex *pindex) override;
+};
+
+/** Record: anon output index (int64), pubkey (33 bytes), commitment (33 bytes), txid, output n (uint32) */
+class CZMQPublishAnonOutputNotifier : public CZMQAbstractBlockRecordNotifier
+{
+protected:
+    const char *GetCommand() const override;
+    bool WriteRecords(const CBlock &block, const CBlockIndex *pindex, CDataStream &ss, uint32_t &nRecords) override;
+};
+
+/** Record: key image (33 bytes), txid */
+class CZMQPublishKeyImageNotifier : public CZMQAbstractBlockRecordNotifier
+{
+protected:
+    const char *GetCommand() const override;
+    bool WriteRecords(const CBlock &block, const CBlockIndex *pindex, CDataStream &ss, uint32_t &nRecords) override;
+};
+
+/** Record: pubcoin hash, denomination (int64), txid, output n (uint32) */
+class CZMQPublishZerocoinMintNotifier : public CZMQAbstractBlockRecordNotifier
+{
+protected:
+    const char *GetCommand() const override;
+    bool WriteRecords(const CBlock &block, const CBlockIndex *pindex, CDataStream &ss, uint32_t &nRecords) override;
+};
+
+/** Record: serial hash, denomination (int64), txid */
+class CZMQPublishZerocoinSpendNotifier : public CZMQAbstractBlockRecordNotifier
+{
+protected:
+    const char *GetCommand() const override;
+    bool WriteRecords(const CBlock &block, const CBlockIndex *pindex, CDataStream &ss, uint32_t &nRecords) override;
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H
@@ -296,5 +296,31 @@ class RESTTest (BitcoinTestFramework):
         json_obj = self.test_rest_request("/chaininfo")
         assert_equal(json_obj['bestblockhash'], bb_hash)
 
+        self.log.info("Test the /keyimages URI")
+
+        # A key image that was never spent, with and without the mempool
+        key_image = "02" + "11" * 32
+        json_obj = self.test_rest_request("/keyimages/{}".format(key_image))
+        assert_equal(json_obj['chaintipHash'], bb_hash)
+        assert_equal(json_obj['bitmap'], "0")
+        assert_equal(json_obj['spends'], [])
+        json_obj = self.test_rest_request("/keyimages/checkmempool/{}/{}".format(key_image, key_image))
+        assert_equal(json_obj['bitmap'], "00")
+
+        self.test_rest_request("/keyimages/{}".format(key_image[:-2]), status=400, ret_type=RetType.OBJ)
+
+        self.log.info("Test the /accumulatorcheckpoint URI")
+
+        json_obj = self.test_rest_request("/accumulatorcheckpoint/0")
+        assert_equal(json_obj['blockhash'], self.nodes[0].getblockhash(0))
+        assert_equal(len(json_obj['accumulators']), 4)
+
+        self.test_rest_request("/accumulatorcheckpoint/100000", status=404, ret_type=RetType.OBJ)
+
+        self.log.info("Test the /anonoutputs URI")
+
+        self.test_rest_request("/anonoutputs/0/10", status=400, ret_type=RetType.OBJ)
+        self.test_rest_request("/anonoutputs/1/1001", status=400, ret_type=RetType.OBJ)
+
 if __name__ == '__main__':
     RESTTest().main()